@@ -18,13 +18,15 @@ enum class ActivationType {
 /**
  * Activation function layer
  *
+ * T: Element type of activations
  * type: Type of activation function to apply
  * inputCache: Cached input/output from forward pass for backward computation
  */
-class Activation : public Layer {
+template <typename T>
+class BasicActivation : public BasicLayer<T> {
 private:
 	ActivationType type;
-	Tensor inputCache;
+	BasicTensor<T> inputCache;
 
 public:
 	/**
@@ -32,7 +34,14 @@ public:
 	 *
 	 * activationType: Type of activation function
 	 */
-	Activation(ActivationType activationType);
+	BasicActivation(ActivationType activationType);
+
+	/**
+	 * Get the activation function applied by this layer
+	 *
+	 * Output: Activation type
+	 */
+	ActivationType getType() const { return type; }
 
 	/**
 	 * Apply activation function element-wise
@@ -40,7 +49,7 @@ public:
 	 * input: Input tensor
 	 * Output: Activated tensor
 	 */
-	Tensor forward(const Tensor& input) override;
+	BasicTensor<T> forward(const BasicTensor<T>& input) override;
 
 	/**
 	 * Compute gradient through activation function
@@ -48,7 +57,7 @@ public:
 	 * gradOutput: Gradient of loss with respect to output
 	 * Output: Gradient of loss with respect to input
 	 */
-	Tensor backward(const Tensor& gradOutput) override;
+	BasicTensor<T> backward(const BasicTensor<T>& gradOutput) override;
 
 	/**
 	 * Check if layer has trainable parameters (always false for Activation)
@@ -58,4 +67,12 @@ public:
 	bool hasWeights() const override { return false; }
 };
 
+extern template class BasicActivation<double>;
+extern template class BasicActivation<float>;
+extern template class BasicActivation<bfloat16>;
+
+using Activation = BasicActivation<double>;
+using ActivationF = BasicActivation<float>;
+using ActivationBF16 = BasicActivation<bfloat16>;
+
 #endif
\ No newline at end of file
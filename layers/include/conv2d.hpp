@@ -0,0 +1,187 @@
+/* conv2d.hpp */
+
+#ifndef CONV2D_HPP
+#define CONV2D_HPP
+
+#include "layer.hpp"
+#include <vector>
+
+/**
+ * Ways a convolution can be evaluated
+ *
+ * Auto: Direct for stride-1 3x3 and 5x5 kernels over at most 8 input channels,
+ *       Winograd4x4 for other stride-1 3x3 kernels, Im2col otherwise
+ * Im2col: Unfold input patches into columns and multiply with one GEMM per sample
+ * Direct: Slide the kernel over the input without any unfolded copy (stride 1 only;
+ *         other strides run Im2col)
+ * Winograd2x2: Winograd F(2x2, 3x3), 2.25x fewer multiplications than Im2col
+ * Winograd4x4: Winograd F(4x4, 3x3), 4x fewer multiplications, slightly less accurate
+ *              (both Winograd variants need 3x3 kernels, stride 1 and dilation 1;
+ *              other shapes run Im2col)
+ */
+enum class ConvAlgorithm {
+	Auto,
+	Im2col,
+	Direct,
+	Winograd2x2,
+	Winograd4x4
+};
+
+/**
+ * Two-dimensional convolution layer over NCHW batches
+ *
+ * out[n][o][y][x] = b[o] + sum_{c,i,j} W[o][c][i][j] *
+ *                   in[n][c][y * stride + i * dilation - padding][x * stride + j * dilation - padding]
+ *
+ * with zeros outside the input. The im2col path lowers each sample to a
+ * {C * K * K, OH * OW} column matrix and runs forward and backward as
+ * batched GEMMs, scattering the input gradient back with col2im. Its
+ * columns are kept from forward for the following backward. The direct
+ * path only keeps a zero-padded copy of the input, a K * K smaller buffer,
+ * which wins when C * K * K is too small to keep a GEMM busy and the
+ * column matrix would be mostly copies of the input. The Winograd paths
+ * cut the input into overlapping tiles, transform tiles and kernels so the
+ * convolution becomes an elementwise product, and run that product as one
+ * {outChannels, inChannels} x {inChannels, tiles} GEMM per transformed
+ * element. The kernel transforms are computed once and reused until the
+ * weights change.
+ *
+ * T: Element type of activations and parameters
+ * weights: Kernels of shape {outChannels, inChannels, kernelSize, kernelSize}
+ * biases: Bias vector of shape {outChannels}
+ * weightGrad: Gradient of weights
+ * biasGrad: Gradient of biases
+ * inputCache: Cached input from forward pass for backward computation
+ * columns: im2col buffer {N, C * K * K, OH * OW} of the last im2col forward
+ * padded: Zero-padded input planes of the last direct forward
+ * transformSource: Weights the cached kernel transforms were computed from
+ * transformedWeights: Kernel transforms {alpha * alpha, outChannels, inChannels}
+ * transformedTiles: Input tile transforms {alpha * alpha, inChannels, tiles} of the last Winograd forward
+ * products: Per-element products {alpha * alpha, outChannels, tiles}
+ */
+template <typename T>
+class BasicConv2D : public BasicLayer<T> {
+private:
+	size_t inChannels;
+	size_t outChannels;
+	size_t kernelSize;
+	size_t stride;
+	size_t padding;
+	size_t dilation;
+	ConvAlgorithm algorithm;
+	BasicTensor<T> weights;
+	BasicTensor<T> biases;
+	BasicTensor<T> weightGrad;
+	BasicTensor<T> biasGrad;
+	BasicTensor<T> inputCache;
+	std::vector<T> columns;
+	std::vector<typename ComputeType<T>::type> padded;
+	std::vector<T> transformSource;
+	std::vector<typename ComputeType<T>::type> transformedWeights;
+	std::vector<typename ComputeType<T>::type> transformedTiles;
+	std::vector<typename ComputeType<T>::type> products;
+	size_t transformTile;
+	bool columnsValid;
+	ConvAlgorithm usedAlgorithm;
+
+	/**
+	 * Unfold every sample of input into columns
+	 */
+	void lower(const BasicTensor<T>& input);
+
+	void forwardIm2col(const BasicTensor<T>& input, BasicTensor<T>& output);
+	void forwardDirect(const BasicTensor<T>& input, BasicTensor<T>& output);
+	void backwardIm2col(const BasicTensor<T>& gradOutput, BasicTensor<T>& gradInput);
+	void backwardDirect(const BasicTensor<T>& gradOutput, BasicTensor<T>& gradInput);
+
+	/**
+	 * Recompute the kernel transforms for a tile size unless they are still current
+	 */
+	void transformWeights(size_t tile);
+
+	void forwardWinograd(const BasicTensor<T>& input, BasicTensor<T>& output, size_t tile);
+	void backwardWinograd(const BasicTensor<T>& gradOutput, BasicTensor<T>& gradInput, size_t tile);
+
+public:
+	/**
+	 * Create a convolution layer with random initialization
+	 *
+	 * inChannels: Channels of the input
+	 * outChannels: Channels of the output (number of kernels)
+	 * kernelSize: Height and width of each kernel
+	 * stride: Step between neighbouring output positions
+	 * padding: Zeros added on every side of the input
+	 * dilation: Spacing between kernel taps
+	 */
+	BasicConv2D(size_t inChannels, size_t outChannels, size_t kernelSize,
+	            size_t stride = 1, size_t padding = 0, size_t dilation = 1);
+
+	/**
+	 * Get the output height (or width) for an input height (or width)
+	 *
+	 * size: Input height or width
+	 * Output: (size + 2 * padding - dilation * (kernelSize - 1) - 1) / stride + 1
+	 */
+	size_t outputSize(size_t size) const;
+
+	/**
+	 * Choose how forward and backward are evaluated
+	 *
+	 * algorithm: Evaluation strategy (Auto by default)
+	 */
+	void setAlgorithm(ConvAlgorithm algorithm);
+
+	/**
+	 * Get the strategy Auto resolves to for this layer
+	 *
+	 * Output: Im2col, Direct or a Winograd variant
+	 */
+	ConvAlgorithm selectedAlgorithm() const;
+
+	/**
+	 * Forward pass
+	 *
+	 * input: Tensor of shape {N, inChannels, H, W}
+	 * Output: Tensor of shape {N, outChannels, outputSize(H), outputSize(W)}
+	 */
+	BasicTensor<T> forward(const BasicTensor<T>& input) override;
+
+	/**
+	 * Backward pass: fills the weight and bias gradients
+	 *
+	 * gradOutput: Gradient of loss with respect to output
+	 * Output: Gradient of loss with respect to input
+	 */
+	BasicTensor<T> backward(const BasicTensor<T>& gradOutput) override;
+
+	/**
+	 * Check if layer has trainable parameters (always true for Conv2D)
+	 *
+	 * Output: True
+	 */
+	bool hasWeights() const override { return true; }
+
+	/**
+	 * Get pointers to trainable parameters
+	 *
+	 * Output: Vector containing pointers to weights and biases
+	 */
+	std::vector<BasicTensor<T>*> getWeights() override;
+
+	/**
+	 * Get pointers to parameter gradients
+	 *
+	 * Output: Vector containing pointers to weight and bias gradients
+	 */
+	std::vector<BasicTensor<T>*> getGradients() override;
+};
+
+extern template class BasicConv2D<double>;
+extern template class BasicConv2D<float>;
+extern template class BasicConv2D<bfloat16>;
+
+using Conv2D = BasicConv2D<double>;
+using Conv2DF = BasicConv2D<float>;
+using Conv2DBF16 = BasicConv2D<bfloat16>;
+
+#endif
\ No newline at end of file
@@ -4,6 +4,7 @@
 #define DENSE_HPP
 
 #include "layer.hpp"
+#include "../../tensor/include/sparse.hpp"
 
 /**
  * Fully connected (dense) layer: y = Wx + b
@@ -11,19 +12,31 @@
  * Implements pure mathematical convention where W in R^(m x n)
  * transforms input x in R^n to output y in R^m
  *
+ * T: Element type of activations and parameters
  * weights: Weight matrix of shape {outputSize, inputSize}
  * biases: Bias vector of shape {outputSize}
- * weightGrad: Gradient of weights
+ * weightGrad: Gradient of weights (allocated on first use for loaded layers)
  * biasGrad: Gradient of biases
  * inputCache: Cached input from forward pass for backward computation
+ * sparseCache: Cached input of the last sparse forward pass
+ * sparseInput: Whether the last forward pass took a sparse input
  */
-class Dense : public Layer {
+template <typename T>
+class BasicDense : public BasicLayer<T> {
+protected:
+	BasicTensor<T> weights;
+	BasicTensor<T> biases;
+	BasicTensor<T> weightGrad;
+	BasicTensor<T> biasGrad;
+	BasicTensor<T> inputCache;
+	BasicSparseTensor<T> sparseCache;
+	bool sparseInput;
+
 private:
-	Tensor weights;
-	Tensor biases;
-	Tensor weightGrad;
-	Tensor biasGrad;
-	Tensor inputCache;
+	/**
+	 * Size the gradients to match the parameters if they are not yet
+	 */
+	void ensureGradients();
 
 public:
 	/**
@@ -32,7 +45,32 @@ public:
 	 * inputSize: Number of input features
 	 * outputSize: Number of output features
 	 */
-	Dense(size_t inputSize, size_t outputSize);
+	BasicDense(size_t inputSize, size_t outputSize);
+
+	/**
+	 * Create a dense layer around existing parameters
+	 *
+	 * The tensors are adopted without copying, so a layer can run directly
+	 * on memory-mapped weights. Gradients are allocated on first use.
+	 *
+	 * weights: Weight matrix of shape {outputSize, inputSize}
+	 * biases: Bias vector of shape {outputSize}
+	 */
+	BasicDense(BasicTensor<T> weights, BasicTensor<T> biases);
+
+	/**
+	 * Get the number of input features
+	 *
+	 * Output: Columns of the weight matrix
+	 */
+	size_t inputSize() const { return weights.getShape()[1]; }
+
+	/**
+	 * Get the number of output features
+	 *
+	 * Output: Rows of the weight matrix
+	 */
+	size_t outputSize() const { return weights.getShape()[0]; }
 
 	/**
 	 * Forward pass: y = Wx + b
@@ -41,7 +79,20 @@ public:
 	 *
 	 * Output: Output tensor
 	 */
-	Tensor forward(const Tensor& input) override;
+	BasicTensor<T> forward(const BasicTensor<T>& input) override;
+
+	/**
+	 * Forward pass on a sparse batch: y = xW^T + b
+	 *
+	 * Costs O(nnz * outputSize) instead of O(batch * inputSize * outputSize).
+	 * The following backward pass computes weight gradients only for the
+	 * input columns that occur in the batch, and returns the input gradient
+	 * at the stored entries of x only (zero elsewhere).
+	 *
+	 * input: Sparse tensor of shape {batch, inputSize}
+	 * Output: Dense output tensor of shape {batch, outputSize}
+	 */
+	BasicTensor<T> forward(const BasicSparseTensor<T>& input);
 
 	/**
 	 * Backward pass: dL/dx = W^T (dL/dy)
@@ -50,7 +101,7 @@ public:
 	 *
 	 * Output: Gradient of loss with respect to input
 	 */
-	Tensor backward(const Tensor& gradOutput) override;
+	BasicTensor<T> backward(const BasicTensor<T>& gradOutput) override;
 
 	/**
 	 * Check if layer has trainable parameters (always true for Dense)
@@ -64,14 +115,22 @@ public:
 	 *
 	 * Output: Vector containing pointers to weights and biases
 	 */
-	std::vector<Tensor*> getWeights() override;
+	std::vector<BasicTensor<T>*> getWeights() override;
 
 	/**
 	 * Get pointers to parameter gradients
 	 *
 	 * Output: Vector containing pointers to weight and bias gradients
 	 */
-	std::vector<Tensor*> getGradients() override;
+	std::vector<BasicTensor<T>*> getGradients() override;
 };
 
+extern template class BasicDense<double>;
+extern template class BasicDense<float>;
+extern template class BasicDense<bfloat16>;
+
+using Dense = BasicDense<double>;
+using DenseF = BasicDense<float>;
+using DenseBF16 = BasicDense<bfloat16>;
+
 #endif
\ No newline at end of file
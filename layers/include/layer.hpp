@@ -31,10 +31,13 @@ public:
  * Abstract base class for neural network layers
  *
  * Defines the interface for forward and backward propagation
+ *
+ * T: Element type of activations and parameters
  */
-class Layer {
+template <typename T>
+class BasicLayer {
 public:
-	virtual ~Layer() = default;
+	virtual ~BasicLayer() = default;
 
 	/**
 	 * Forward pass through the layer
@@ -42,7 +45,7 @@ public:
 	 * input: Input tensor
 	 * Output: Output tensor after applying layer transformation
 	 */
-	virtual Tensor forward(const Tensor& input) = 0;
+	virtual BasicTensor<T> forward(const BasicTensor<T>& input) = 0;
 
 	/**
 	 * Backward pass through the layer
@@ -50,7 +53,7 @@ public:
 	 * gradOutput: Gradient of loss with respect to output
 	 * Output: Gradient of loss with respect to input
 	 */
-	virtual Tensor backward(const Tensor& gradOutput) = 0;
+	virtual BasicTensor<T> backward(const BasicTensor<T>& gradOutput) = 0;
 
 	/**
 	 * Check if layer has trainable parameters
@@ -64,14 +67,18 @@ public:
 	 *
 	 * Output: Vector of pointers to weight tensors
 	 */
-	virtual std::vector<Tensor*> getWeights() { return {}; }
+	virtual std::vector<BasicTensor<T>*> getWeights() { return {}; }
 
 	/**
 	 * Get pointers to all parameter gradients
 	 *
 	 * Output: Vector of pointers to gradient tensors
 	 */
-	virtual std::vector<Tensor*> getGradients() { return {}; }
+	virtual std::vector<BasicTensor<T>*> getGradients() { return {}; }
 };
 
+using Layer = BasicLayer<double>;
+using LayerF = BasicLayer<float>;
+using LayerBF16 = BasicLayer<bfloat16>;
+
 #endif
\ No newline at end of file
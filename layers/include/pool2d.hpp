@@ -0,0 +1,155 @@
+/* pool2d.hpp */
+
+#ifndef POOL2D_HPP
+#define POOL2D_HPP
+
+#include "layer.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * Common geometry of two-dimensional pooling layers over NCHW batches
+ *
+ * Each output takes a kernelSize x kernelSize window of one channel, placed
+ * every stride positions over the input padded by padding on every side.
+ * Padding must be smaller than the kernel so every window touches the input.
+ *
+ * T: Element type of activations
+ * kernelSize: Height and width of each window
+ * stride: Step between neighbouring windows
+ * padding: Positions added on every side of the input
+ * inputShape: Shape of the last forward input
+ */
+template <typename T>
+class BasicPool2D : public BasicLayer<T> {
+protected:
+	size_t kernelSize;
+	size_t stride;
+	size_t padding;
+	Shape inputShape;
+
+	/**
+	 * Check a forward input and remember its shape
+	 *
+	 * input: Tensor of shape {N, C, H, W}
+	 * Output: Output shape {N, C, outputSize(H), outputSize(W)}
+	 */
+	Shape prepare(const BasicTensor<T>& input);
+
+	/**
+	 * Check an output gradient against the last forward input
+	 *
+	 * gradOutput: Gradient of loss with respect to output
+	 */
+	void checkGradient(const BasicTensor<T>& gradOutput) const;
+
+public:
+	/**
+	 * Create a pooling layer
+	 *
+	 * kernelSize: Height and width of each window
+	 * stride: Step between windows (0 means kernelSize, non-overlapping windows)
+	 * padding: Positions added on every side of the input
+	 */
+	BasicPool2D(size_t kernelSize, size_t stride = 0, size_t padding = 0);
+
+	/**
+	 * Get the output height (or width) for an input height (or width)
+	 *
+	 * size: Input height or width
+	 * Output: (size + 2 * padding - kernelSize) / stride + 1
+	 */
+	size_t outputSize(size_t size) const;
+};
+
+/**
+ * Max pooling layer
+ *
+ * Forward keeps only the position of each maximum inside its window, as
+ * one byte per output (four for windows larger than 16 x 16), instead of
+ * a copy of the input. Backward is then a single scatter of the output
+ * gradient onto those positions. Padded positions never win a window, and
+ * ties go to the first maximum in row-major window order.
+ *
+ * argmax: Window offset kh * kernelSize + kw of every output maximum
+ * wideArgmax: Same as argmax for windows with more than 256 positions
+ */
+template <typename T>
+class BasicMaxPool2D : public BasicPool2D<T> {
+private:
+	std::vector<uint8_t> argmax;
+	std::vector<uint32_t> wideArgmax;
+
+public:
+	using BasicPool2D<T>::BasicPool2D;
+
+	/**
+	 * Forward pass
+	 *
+	 * input: Tensor of shape {N, C, H, W}
+	 * Output: Window maxima of shape {N, C, outputSize(H), outputSize(W)}
+	 */
+	BasicTensor<T> forward(const BasicTensor<T>& input) override;
+
+	/**
+	 * Backward pass: routes each output gradient to its window maximum
+	 *
+	 * gradOutput: Gradient of loss with respect to output
+	 * Output: Gradient of loss with respect to input
+	 */
+	BasicTensor<T> backward(const BasicTensor<T>& gradOutput) override;
+
+	/**
+	 * Get the memory kept from forward for backward
+	 *
+	 * Output: Bytes of cached argmax indices
+	 */
+	size_t cacheBytes() const { return argmax.size() * sizeof(uint8_t) + wideArgmax.size() * sizeof(uint32_t); }
+};
+
+/**
+ * Average pooling layer
+ *
+ * Every output is the window sum divided by kernelSize * kernelSize, so
+ * padded positions count as zeros. Backward only needs the input shape.
+ */
+template <typename T>
+class BasicAvgPool2D : public BasicPool2D<T> {
+public:
+	using BasicPool2D<T>::BasicPool2D;
+
+	/**
+	 * Forward pass
+	 *
+	 * input: Tensor of shape {N, C, H, W}
+	 * Output: Window averages of shape {N, C, outputSize(H), outputSize(W)}
+	 */
+	BasicTensor<T> forward(const BasicTensor<T>& input) override;
+
+	/**
+	 * Backward pass: spreads each output gradient evenly over its window
+	 *
+	 * gradOutput: Gradient of loss with respect to output
+	 * Output: Gradient of loss with respect to input
+	 */
+	BasicTensor<T> backward(const BasicTensor<T>& gradOutput) override;
+};
+
+extern template class BasicPool2D<double>;
+extern template class BasicPool2D<float>;
+extern template class BasicPool2D<bfloat16>;
+extern template class BasicMaxPool2D<double>;
+extern template class BasicMaxPool2D<float>;
+extern template class BasicMaxPool2D<bfloat16>;
+extern template class BasicAvgPool2D<double>;
+extern template class BasicAvgPool2D<float>;
+extern template class BasicAvgPool2D<bfloat16>;
+
+using MaxPool2D = BasicMaxPool2D<double>;
+using MaxPool2DF = BasicMaxPool2D<float>;
+using MaxPool2DBF16 = BasicMaxPool2D<bfloat16>;
+using AvgPool2D = BasicAvgPool2D<double>;
+using AvgPool2DF = BasicAvgPool2D<float>;
+using AvgPool2DBF16 = BasicAvgPool2D<bfloat16>;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+/* quantized.hpp */
+
+#ifndef QUANTIZED_HPP
+#define QUANTIZED_HPP
+
+#include "layer.hpp"
+#include "dense.hpp"
+#include "../../tensor/include/quant.hpp"
+
+/**
+ * Exception thrown when backpropagating through an inference-only layer
+ */
+class InferenceOnlyError : public std::exception {
+public:
+	const char* what() const noexcept override {
+		return "Layer supports inference only.";
+	}
+};
+
+/**
+ * Int8 fully connected layer for inference: y = act(Wx + b)
+ *
+ * Post-training quantization of a Dense layer: weights become int8 codes
+ * with one scale per output channel (4x smaller than float, 8x smaller
+ * than double), and each forward pass quantizes its input to uint8 with
+ * one scale for the whole batch. The product runs on the integer GEMM in
+ * quant.hpp with dequantization, bias and an optional ReLU fused into it.
+ *
+ * T: Element type of the input and output activations
+ * weights: Packed int8 weight codes, scales and channel sums
+ * biases: Bias vector of shape {outputSize}, kept in T
+ * relu: Whether a following ReLU is applied in the GEMM epilogue
+ */
+template <typename T>
+class BasicQuantizedDense : public BasicLayer<T> {
+private:
+	quant::PackedWeights weights;
+	BasicTensor<T> biases;
+	bool relu;
+
+public:
+	/**
+	 * Quantize the parameters of a trained dense layer
+	 *
+	 * dense: Layer to quantize (left unchanged)
+	 * fuseRelu: Apply ReLU to the outputs, replacing a following Activation
+	 */
+	BasicQuantizedDense(BasicDense<T>& dense, bool fuseRelu = false);
+
+	/**
+	 * Forward pass: y = act(Wx + b) in 8-bit arithmetic
+	 *
+	 * input: Tensor of shape {inputSize} or {batch, inputSize}
+	 * Output: Tensor of shape {outputSize} or {batch, outputSize}
+	 */
+	BasicTensor<T> forward(const BasicTensor<T>& input) override;
+
+	/**
+	 * Not supported: quantized layers are for inference only
+	 *
+	 * gradOutput: Ignored
+	 * Output: Never returns (throws InferenceOnlyError)
+	 */
+	BasicTensor<T> backward(const BasicTensor<T>& gradOutput) override;
+
+	/**
+	 * Check whether ReLU is fused into the layer
+	 *
+	 * Output: True if outputs are clamped at zero
+	 */
+	bool fusesRelu() const { return relu; }
+
+	/**
+	 * Get the memory held by the layer parameters
+	 *
+	 * Output: Bytes of weight codes, scales, channel sums and biases
+	 */
+	size_t memoryBytes() const { return weights.memoryBytes() + biases.size() * sizeof(T); }
+};
+
+extern template class BasicQuantizedDense<double>;
+extern template class BasicQuantizedDense<float>;
+extern template class BasicQuantizedDense<bfloat16>;
+
+using QuantizedDense = BasicQuantizedDense<double>;
+using QuantizedDenseF = BasicQuantizedDense<float>;
+using QuantizedDenseBF16 = BasicQuantizedDense<bfloat16>;
+
+#endif
\ No newline at end of file
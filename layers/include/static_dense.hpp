@@ -0,0 +1,135 @@
+/* static_dense.hpp */
+
+#ifndef STATIC_DENSE_HPP
+#define STATIC_DENSE_HPP
+
+#include "dense.hpp"
+#include "../../tensor/include/static_tensor.hpp"
+
+/**
+ * Dense layer with sizes fixed at compile time: y = Wx + b
+ *
+ * A drop-in BasicDense, so it trains with any optimizer, saves to and
+ * loads from checkpoints and quantizes like one. Single samples go
+ * through a kernel whose loop bounds are the template arguments: every
+ * output row is a dot product with a fixed number of vector-wide partial
+ * sums, which the compiler unrolls and vectorizes without runtime shape
+ * logic. Batches still use the GEMM path of BasicDense.
+ *
+ * infer() runs that kernel on StaticTensors directly - no allocation, no
+ * shape checks and no cached input - for latency-critical inference.
+ *
+ * T: Element type of activations and parameters
+ * In: Number of input features
+ * Out: Number of output features
+ */
+template <typename T, size_t In, size_t Out>
+class BasicStaticDense : public BasicDense<T> {
+	static_assert(In > 0 && Out > 0, "StaticDense sizes must be non-zero");
+
+private:
+	/**
+	 * y = Wx + b on raw buffers with compile-time sizes
+	 */
+	static void kernel(const T* weights, const T* biases, const T* x, T* y) {
+		using Acc = typename ComputeType<T>::type;
+		constexpr size_t LANES = 64 / sizeof(Acc);
+		constexpr size_t BODY = In / LANES * LANES;
+
+		for (size_t o = 0; o < Out; o++) {
+			const T* row = weights + o * In;
+			Acc partial[LANES] = {};
+			for (size_t i = 0; i < BODY; i += LANES) {
+				for (size_t l = 0; l < LANES; l++) {
+					partial[l] += static_cast<Acc>(row[i + l]) * static_cast<Acc>(x[i + l]);
+				}
+			}
+			Acc sum = static_cast<Acc>(biases[o]);
+			for (size_t i = BODY; i < In; i++) {
+				sum += static_cast<Acc>(row[i]) * static_cast<Acc>(x[i]);
+			}
+			for (size_t l = 0; l < LANES; l++) {
+				sum += partial[l];
+			}
+			y[o] = static_cast<T>(sum);
+		}
+	}
+
+public:
+	/**
+	 * Create the layer with random initialization
+	 */
+	BasicStaticDense() : BasicDense<T>(In, Out) {}
+
+	/**
+	 * Create the layer around existing parameters
+	 *
+	 * weights: Weight matrix of shape {Out, In}
+	 * biases: Bias vector of shape {Out}
+	 */
+	BasicStaticDense(BasicTensor<T> weights, BasicTensor<T> biases)
+		: BasicDense<T>(std::move(weights), std::move(biases)) {
+		if (this->inputSize() != In || this->outputSize() != Out) {
+			throw LayerDimensionError();
+		}
+	}
+
+	using BasicDense<T>::forward;
+
+	/**
+	 * Forward pass: single samples use the fixed-size kernel
+	 *
+	 * input: Tensor of shape {In} or {batch, In}
+	 * Output: Tensor of shape {Out} or {batch, Out}
+	 */
+	BasicTensor<T> forward(const BasicTensor<T>& input) override {
+		if (input.ndim() != 1) {
+			return BasicDense<T>::forward(input);
+		}
+		if (input.getShape()[0] != In) {
+			throw LayerDimensionError();
+		}
+
+		this->inputCache = input;
+		this->sparseInput = false;
+		BasicTensor<T> output({Out});
+		kernel(this->weights.getData().data(), this->biases.getData().data(),
+		       input.getData().data(), output.getData().data());
+		return output;
+	}
+
+	/**
+	 * Inference on a fixed-size sample into a caller-provided output
+	 *
+	 * Nothing is cached, so a following backward() sees the last forward().
+	 *
+	 * input: Sample of In features
+	 * output: Receives the Out outputs
+	 */
+	void infer(const StaticTensor<T, In>& input, StaticTensor<T, Out>& output) const {
+		kernel(this->weights.getData().data(), this->biases.getData().data(), input.data(), output.data());
+	}
+
+	/**
+	 * Inference on a fixed-size sample
+	 *
+	 * input: Sample of In features
+	 * Output: The Out outputs
+	 */
+	StaticTensor<T, Out> infer(const StaticTensor<T, In>& input) const {
+		StaticTensor<T, Out> output;
+		infer(input, output);
+		return output;
+	}
+};
+
+template <size_t In, size_t Out>
+using StaticDense = BasicStaticDense<double, In, Out>;
+
+template <size_t In, size_t Out>
+using StaticDenseF = BasicStaticDense<float, In, Out>;
+
+template <size_t In, size_t Out>
+using StaticDenseBF16 = BasicStaticDense<bfloat16, In, Out>;
+
+#endif
\ No newline at end of file
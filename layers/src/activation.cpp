@@ -1,68 +1,60 @@
 /* activation.cpp */
 
 #include "../include/activation.hpp"
+#include "../../tensor/include/simd.hpp"
 #include <cmath>
 #include <algorithm>
 
-Activation::Activation(ActivationType activationType)
+template <typename T>
+BasicActivation<T>::BasicActivation(ActivationType activationType)
 	: type(activationType), inputCache({1}) {}
 
-Tensor Activation::forward(const Tensor& input) {
+template <typename T>
+BasicTensor<T> BasicActivation<T>::forward(const BasicTensor<T>& input) {
+	using Acc = typename ComputeType<T>::type;
 	inputCache = input;
-	Tensor output(input.getShape());
+	BasicTensor<T> output(input.getShape());
+	Span<const T> inputValues = input.getData();
+	const T* inputData = inputValues.data();
+	T* outputData = output.getData().data();
+	size_t n = input.size();
 
 	switch (type) {
 		case ActivationType::ReLU:
-			for (size_t i = 0; i < input.size(); i++) {
-				output.getData()[i] = std::max(0.0, input.getData()[i]);
-			}
+			simd::relu(inputData, outputData, n);
 			break;
 
 		case ActivationType::Sigmoid:
-			for (size_t i = 0; i < input.size(); i++) {
-				output.getData()[i] = 1.0 / (1.0 + std::exp(-input.getData()[i]));
+			for (size_t i = 0; i < n; i++) {
+				outputData[i] = T(1) / (T(1) + std::exp(-inputData[i]));
 			}
 			break;
 
 		case ActivationType::Tanh:
-			for (size_t i = 0; i < input.size(); i++) {
-				output.getData()[i] = std::tanh(input.getData()[i]);
+			for (size_t i = 0; i < n; i++) {
+				outputData[i] = std::tanh(inputData[i]);
 			}
 			break;
 
 		case ActivationType::Softmax: {
 			if (input.ndim() == 1) {
-				double maxVal = *std::max_element(input.getData().begin(), input.getData().end());
-				double sumExp = 0.0;
+				Acc maxVal = *std::max_element(inputData, inputData + n);
+				Acc sumExp = Acc(0);
 
-				for (size_t i = 0; i < input.size(); i++) {
-					output.getData()[i] = std::exp(input.getData()[i] - maxVal);
-					sumExp += output.getData()[i];
+				for (size_t i = 0; i < n; i++) {
+					outputData[i] = static_cast<T>(std::exp(static_cast<Acc>(inputData[i]) - maxVal));
+					sumExp += static_cast<Acc>(outputData[i]);
 				}
 
-				for (size_t i = 0; i < input.size(); i++) {
-					output.getData()[i] /= sumExp;
+				for (size_t i = 0; i < n; i++) {
+					outputData[i] = static_cast<T>(static_cast<Acc>(outputData[i]) / sumExp);
 				}
 			} else if (input.ndim() == 2) {
-				size_t batchSize = input.getShape()[0];
-				size_t numClasses = input.getShape()[1];
-
-				for (size_t b = 0; b < batchSize; b++) {
-					double maxVal = input.get({b, 0});
-					for (size_t i = 1; i < numClasses; i++) {
-						maxVal = std::max(maxVal, input.get({b, i}));
-					}
-
-					double sumExp = 0.0;
-					for (size_t i = 0; i < numClasses; i++) {
-						output.at({b, i}) = std::exp(input.get({b, i}) - maxVal);
-						sumExp += output.get({b, i});
-					}
-
-					for (size_t i = 0; i < numClasses; i++) {
-						output.at({b, i}) /= sumExp;
-					}
+				BasicTensor<T>::sub(output, input, input.max(1, true));
+				for (size_t i = 0; i < n; i++) {
+					outputData[i] = std::exp(outputData[i]);
 				}
+				output.div_(output.sum(1, true));
 			} else {
 				throw TensorDismatchError();
 			}
@@ -73,45 +65,52 @@ Tensor Activation::forward(const Tensor& input) {
 	return output;
 }
 
-Tensor Activation::backward(const Tensor& gradOutput) {
-	Tensor gradInput(inputCache.getShape());
+template <typename T>
+BasicTensor<T> BasicActivation<T>::backward(const BasicTensor<T>& gradOutput) {
+	using Acc = typename ComputeType<T>::type;
+	BasicTensor<T> gradInput(inputCache.getShape());
 
 	switch (type) {
 		case ActivationType::ReLU:
-			for (size_t i = 0; i < inputCache.size(); i++) {
-				gradInput.getData()[i] = inputCache.getData()[i] > 0.0 ? gradOutput.getData()[i] : 0.0;
-			}
+			simd::reluBackward(inputCache.getData().data(), gradOutput.getData().data(),
+			                   gradInput.getData().data(), inputCache.size());
 			break;
 
 		case ActivationType::Sigmoid: {
-			Tensor sigmoidOutput = forward(inputCache);
-			for (size_t i = 0; i < inputCache.size(); i++) {
-				double s = sigmoidOutput.getData()[i];
-				gradInput.getData()[i] = gradOutput.getData()[i] * s * (1.0 - s);
-			}
+			BasicTensor<T> sigmoidOutput = forward(inputCache);
+			simd::sigmoidBackward(sigmoidOutput.getData().data(), gradOutput.getData().data(),
+			                      gradInput.getData().data(), inputCache.size());
 			break;
 		}
 
 		case ActivationType::Tanh: {
+			T* gradInputData = gradInput.getData().data();
+			const T* inputData = inputCache.getData().data();
 			for (size_t i = 0; i < inputCache.size(); i++) {
-				double t = std::tanh(inputCache.getData()[i]);
-				gradInput.getData()[i] = gradOutput.getData()[i] * (1.0 - t * t);
+				gradInputData[i] = std::tanh(inputData[i]);
 			}
+			simd::tanhBackward(gradInputData, gradOutput.getData().data(),
+			                   gradInputData, inputCache.size());
 			break;
 		}
 
 		case ActivationType::Softmax: {
-			Tensor softmaxOutput = forward(inputCache);
+			BasicTensor<T> softmaxOutput = forward(inputCache);
 
 			if (inputCache.ndim() == 1) {
 				size_t n = inputCache.size();
+				Span<const T> gradOutputValues = gradOutput.getData();
+				const T* gradOutData = gradOutputValues.data();
+				const T* softmaxData = softmaxOutput.getData().data();
+				T* gradInputData = gradInput.getData().data();
 				for (size_t i = 0; i < n; i++) {
-					double sum = 0.0;
+					Acc sum = Acc(0);
 					for (size_t j = 0; j < n; j++) {
-						double delta = (i == j) ? 1.0 : 0.0;
-						sum += gradOutput.getData()[j] * softmaxOutput.getData()[i] * (delta - softmaxOutput.getData()[j]);
+						Acc delta = (i == j) ? Acc(1) : Acc(0);
+						sum += static_cast<Acc>(gradOutData[j]) * static_cast<Acc>(softmaxData[i]) *
+						       (delta - static_cast<Acc>(softmaxData[j]));
 					}
-					gradInput.getData()[i] = sum;
+					gradInputData[i] = static_cast<T>(sum);
 				}
 			} else if (inputCache.ndim() == 2) {
 				size_t batchSize = inputCache.getShape()[0];
@@ -119,12 +118,13 @@ Tensor Activation::backward(const Tensor& gradOutput) {
 
 				for (size_t b = 0; b < batchSize; b++) {
 					for (size_t i = 0; i < numClasses; i++) {
-						double sum = 0.0;
+						Acc sum = Acc(0);
 						for (size_t j = 0; j < numClasses; j++) {
-							double delta = (i == j) ? 1.0 : 0.0;
-							sum += gradOutput.get({b, j}) * softmaxOutput.get({b, i}) * (delta - softmaxOutput.get({b, j}));
+							Acc delta = (i == j) ? Acc(1) : Acc(0);
+							sum += static_cast<Acc>(gradOutput.get(b, j)) * static_cast<Acc>(softmaxOutput.get(b, i)) *
+							       (delta - static_cast<Acc>(softmaxOutput.get(b, j)));
 						}
-						gradInput.at({b, i}) = sum;
+						gradInput.at(b, i) = static_cast<T>(sum);
 					}
 				}
 			} else {
@@ -135,4 +135,8 @@ Tensor Activation::backward(const Tensor& gradOutput) {
 	}
 
 	return gradInput;
-}
\ No newline at end of file
+}
+
+template class BasicActivation<double>;
+template class BasicActivation<float>;
+template class BasicActivation<bfloat16>;
\ No newline at end of file
@@ -0,0 +1,947 @@
+/* conv2d.cpp */
+
+#include "../include/conv2d.hpp"
+#include "../../tensor/include/gemm.hpp"
+#include "../../tensor/include/parallel.hpp"
+#include "../../tensor/include/rng.hpp"
+#include "../../tensor/include/simd.hpp"
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CONV_X86 1
+#endif
+
+namespace {
+
+/* Direct convolution is used for these kernel sizes up to this many input channels */
+constexpr size_t DIRECT_MAX_CHANNELS = 8;
+
+/* Direct loops run over output rows in fixed chunks the compiler turns into vector code */
+constexpr size_t DIRECT_CHUNK = 16;
+
+/* Output rows computed together, so each loaded input chunk feeds this many accumulators */
+constexpr size_t DIRECT_BLOCK = 4;
+
+namespace generic {
+#include "conv_kernel.inc"
+}
+
+#ifdef CONV_X86
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace avx2 {
+#include "conv_kernel.inc"
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace avx512 {
+#include "conv_kernel.inc"
+}
+#pragma GCC pop_options
+
+#endif
+
+/**
+ * Direct convolution kernels compiled for the running CPU
+ */
+template <typename Acc>
+struct DirectKernels {
+	void (*row)(size_t, const Acc* const*, const Acc*, size_t, size_t, size_t, const Acc*, Acc* const*);
+	void (*block)(size_t, const Acc* const*, const Acc*, size_t, size_t, size_t, const Acc*, Acc* const*);
+	void (*taps)(size_t, const Acc*, size_t, const Acc*, size_t, size_t, size_t, size_t, Acc*);
+};
+
+template <typename Acc>
+DirectKernels<Acc> selectDirectKernels() {
+	switch (simd::activeIsa()) {
+#ifdef CONV_X86
+		case simd::Isa::AVX512:
+			return {avx512::correlateRows<Acc, 1, DIRECT_CHUNK>, avx512::correlateRows<Acc, DIRECT_BLOCK, DIRECT_CHUNK>,
+			        avx512::correlateTaps<Acc, DIRECT_CHUNK>};
+		case simd::Isa::AVX2:
+			return {avx2::correlateRows<Acc, 1, DIRECT_CHUNK>, avx2::correlateRows<Acc, DIRECT_BLOCK, DIRECT_CHUNK>,
+			        avx2::correlateTaps<Acc, DIRECT_CHUNK>};
+#endif
+		default:
+			return {generic::correlateRows<Acc, 1, DIRECT_CHUNK>, generic::correlateRows<Acc, DIRECT_BLOCK, DIRECT_CHUNK>,
+			        generic::correlateTaps<Acc, DIRECT_CHUNK>};
+	}
+}
+
+/**
+ * Run a direct kernel over `banks` banks of taps, DIRECT_BLOCK at a time
+ *
+ * Bank b reads taps + b * tapsPerBank, starts at init[b] and writes out + b * outStride.
+ */
+template <typename Acc>
+void correlateBanks(const DirectKernels<Acc>& kernels, size_t banks, size_t sources, const Acc* const* rows,
+                    const Acc* taps, size_t K, size_t dilation, size_t count, const Acc* init,
+                    Acc* out, size_t outStride) {
+	size_t tapsPerBank = sources * K;
+	size_t b = 0;
+	for (; b + DIRECT_BLOCK <= banks; b += DIRECT_BLOCK) {
+		Acc* outs[DIRECT_BLOCK];
+		for (size_t i = 0; i < DIRECT_BLOCK; i++) {
+			outs[i] = out + (b + i) * outStride;
+		}
+		kernels.block(sources, rows, taps + b * tapsPerBank, K, dilation, count, init + b, outs);
+	}
+	for (; b < banks; b++) {
+		Acc* single = out + b * outStride;
+		kernels.row(sources, rows, taps + b * tapsPerBank, K, dilation, count, init + b, &single);
+	}
+}
+
+/**
+ * Sizes of one convolution
+ */
+struct Geometry {
+	size_t batch;
+	size_t channels;
+	size_t height;
+	size_t width;
+	size_t outHeight;
+	size_t outWidth;
+	size_t kernel;
+	size_t stride;
+	size_t padding;
+	size_t dilation;
+
+	size_t patch() const { return channels * kernel * kernel; }
+	size_t positions() const { return outHeight * outWidth; }
+
+	/* Input coordinate of output position 0 under kernel tap k (negative inside the padding) */
+	ptrdiff_t offset(size_t k) const {
+		return static_cast<ptrdiff_t>(k * dilation) - static_cast<ptrdiff_t>(padding);
+	}
+
+	/* Input coordinate of output position o under kernel tap k (o must be in its valid range) */
+	size_t input(size_t o, size_t k) const {
+		return o * stride + k * dilation - padding;
+	}
+
+	/*
+	 * Stride-1 direct layout. Rows are processed in whole chunks, so every
+	 * buffer is wide enough for the last chunk to run past the real data.
+	 * Input planes are zero-padded by the convolution padding; output
+	 * gradient planes get a border of span = (K - 1) * dilation so the
+	 * input gradient becomes a plain correlation too.
+	 */
+	static size_t chunked(size_t n) { return (n + DIRECT_CHUNK - 1) / DIRECT_CHUNK * DIRECT_CHUNK; }
+	size_t span() const { return (kernel - 1) * dilation; }
+	size_t paddedWidth() const { return chunked(outWidth) + span(); }
+	size_t paddedPlane() const { return (outHeight + span()) * paddedWidth(); }
+	size_t borderedWidth() const { return std::max(chunked(width) + padding, chunked(outWidth)) + span(); }
+	size_t borderedPlane() const { return (outHeight + 2 * span()) * borderedWidth(); }
+};
+
+/**
+ * Find the output positions [first, last) whose tap lands inside the input
+ *
+ * offset: Input coordinate of output position 0
+ * size: Input height or width
+ * stride: Step between output positions
+ * outSize: Output height or width
+ */
+void validRange(ptrdiff_t offset, size_t size, size_t stride, size_t outSize, size_t& first, size_t& last) {
+	ptrdiff_t s = static_cast<ptrdiff_t>(stride);
+	ptrdiff_t end = static_cast<ptrdiff_t>(size) - offset;
+	ptrdiff_t lo = (offset >= 0) ? 0 : (-offset + s - 1) / s;
+	ptrdiff_t hi = (end <= 0) ? 0 : (end + s - 1) / s;
+	first = std::min(static_cast<size_t>(lo), outSize);
+	last = std::max(first, std::min(static_cast<size_t>(hi), outSize));
+}
+
+/**
+ * Unfold one {C, H, W} sample into a {C * K * K, OH * OW} column matrix
+ */
+template <typename T>
+void im2col(const Geometry& g, const T* x, T* col) {
+	size_t P = g.positions();
+	std::fill(col, col + g.patch() * P, T(0));
+	for (size_t c = 0; c < g.channels; c++) {
+		for (size_t kh = 0; kh < g.kernel; kh++) {
+			size_t oh0, oh1;
+			validRange(g.offset(kh), g.height, g.stride, g.outHeight, oh0, oh1);
+			for (size_t kw = 0; kw < g.kernel; kw++) {
+				size_t ow0, ow1;
+				validRange(g.offset(kw), g.width, g.stride, g.outWidth, ow0, ow1);
+				T* row = col + ((c * g.kernel + kh) * g.kernel + kw) * P;
+				for (size_t oh = oh0; oh < oh1; oh++) {
+					const T* src = x + (c * g.height + g.input(oh, kh)) * g.width;
+					T* dst = row + oh * g.outWidth;
+					for (size_t ow = ow0; ow < ow1; ow++) {
+						dst[ow] = src[g.input(ow, kw)];
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Fold a column matrix back onto one zeroed {C, H, W} sample, summing overlaps
+ */
+template <typename T>
+void col2im(const Geometry& g, const T* col, T* x) {
+	using Acc = typename ComputeType<T>::type;
+	size_t P = g.positions();
+	for (size_t c = 0; c < g.channels; c++) {
+		for (size_t kh = 0; kh < g.kernel; kh++) {
+			size_t oh0, oh1;
+			validRange(g.offset(kh), g.height, g.stride, g.outHeight, oh0, oh1);
+			for (size_t kw = 0; kw < g.kernel; kw++) {
+				size_t ow0, ow1;
+				validRange(g.offset(kw), g.width, g.stride, g.outWidth, ow0, ow1);
+				const T* row = col + ((c * g.kernel + kh) * g.kernel + kw) * P;
+				for (size_t oh = oh0; oh < oh1; oh++) {
+					T* dst = x + (c * g.height + g.input(oh, kh)) * g.width;
+					const T* src = row + oh * g.outWidth;
+					for (size_t ow = ow0; ow < ow1; ow++) {
+						T& target = dst[g.input(ow, kw)];
+						target = static_cast<T>(static_cast<Acc>(target) + static_cast<Acc>(src[ow]));
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Widen a rows x cols plane into a zeroed plane of the given width and size, offset by border
+ */
+template <typename T, typename Acc>
+void borderPlane(const T* x, size_t rows, size_t cols, size_t border, size_t width, size_t size, Acc* dst) {
+	std::fill(dst, dst + size, Acc(0));
+	for (size_t i = 0; i < rows; i++) {
+		Acc* row = dst + (i + border) * width + border;
+		for (size_t j = 0; j < cols; j++) {
+			row[j] = static_cast<Acc>(x[i * cols + j]);
+		}
+	}
+}
+
+/**
+ * Transform matrices of Winograd F(m x m, 3 x 3): Y = A^T [(G g G^T) * (B^T d B)] A
+ *
+ * tile: Output tile side m
+ * alpha: Input tile side m + 2
+ * BT: alpha x alpha input transform
+ * G: alpha x 3 kernel transform
+ * AT: m x alpha output transform
+ */
+struct Winograd {
+	size_t tile;
+	size_t alpha;
+	const double* BT;
+	const double* G;
+	const double* AT;
+};
+
+/* F(2x2, 3x3), interpolation points 0, 1, -1 */
+constexpr double F2_BT[] = {
+	1,  0, -1,  0,
+	0,  1,  1,  0,
+	0, -1,  1,  0,
+	0,  1,  0, -1
+};
+constexpr double F2_G[] = {
+	1.0,  0.0, 0.0,
+	0.5,  0.5, 0.5,
+	0.5, -0.5, 0.5,
+	0.0,  0.0, 1.0
+};
+constexpr double F2_AT[] = {
+	1, 1,  1,  0,
+	0, 1, -1, -1
+};
+
+/* F(4x4, 3x3), interpolation points 0, 1, -1, 2, -2 */
+constexpr double F4_BT[] = {
+	4,  0, -5,  0, 1, 0,
+	0, -4, -4,  1, 1, 0,
+	0,  4, -4, -1, 1, 0,
+	0, -2, -1,  2, 1, 0,
+	0,  2, -1, -2, 1, 0,
+	0,  4,  0, -5, 0, 1
+};
+constexpr double F4_G[] = {
+	 1.0 / 4,   0.0,       0.0,
+	-1.0 / 6,  -1.0 / 6,  -1.0 / 6,
+	-1.0 / 6,   1.0 / 6,  -1.0 / 6,
+	 1.0 / 24,  1.0 / 12,  1.0 / 6,
+	 1.0 / 24, -1.0 / 12,  1.0 / 6,
+	 0.0,       0.0,       1.0
+};
+constexpr double F4_AT[] = {
+	1, 1,  1, 1,  1, 0,
+	0, 1, -1, 2, -2, 0,
+	0, 1,  1, 4,  4, 0,
+	0, 1, -1, 8, -8, 1
+};
+
+Winograd winograd(size_t tile) {
+	if (tile == 2) {
+		return {2, 4, F2_BT, F2_G, F2_AT};
+	}
+	return {4, 6, F4_BT, F4_G, F4_AT};
+}
+
+/**
+ * dst = l * src on the first term of a sum, dst += l * src after it
+ */
+template <typename Acc>
+void accumulate(Acc l, const Acc* src, Acc* dst, size_t count, bool& first) {
+	if (first) {
+		simd::scale(src, l, dst, count);
+		first = false;
+	} else {
+		simd::axpy(l, src, dst, count);
+	}
+}
+
+/**
+ * Two-sided transform out = L X L^T of count c x c matrices at once
+ *
+ * Element (j, k) of matrix t is X[(j * c + k) * xStride + t], element (i, k)
+ * of its result out[(i * r + k) * outStride + t], so both passes run as
+ * vector operations across the matrices and skip the zero coefficients.
+ *
+ * L: r x c matrix, or its c x r transpose when transposed is set
+ * scratch: Workspace resized to r * c * count
+ */
+template <typename Acc>
+void sandwich(const double* L, size_t r, size_t c, bool transposed, const Acc* X, size_t xStride,
+              Acc* out, size_t outStride, size_t count, std::vector<Acc>& scratch) {
+	auto coefficient = [&](size_t i, size_t j) {
+		return static_cast<Acc>(transposed ? L[j * r + i] : L[i * c + j]);
+	};
+	scratch.resize(r * c * count);
+	for (size_t i = 0; i < r; i++) {
+		for (size_t k = 0; k < c; k++) {
+			Acc* dst = scratch.data() + (i * c + k) * count;
+			bool first = true;
+			for (size_t j = 0; j < c; j++) {
+				Acc l = coefficient(i, j);
+				if (l != Acc(0)) {
+					accumulate(l, X + (j * c + k) * xStride, dst, count, first);
+				}
+			}
+			if (first) {
+				simd::fill(dst, Acc(0), count);
+			}
+		}
+	}
+	for (size_t i = 0; i < r; i++) {
+		for (size_t k = 0; k < r; k++) {
+			Acc* dst = out + (i * r + k) * outStride;
+			bool first = true;
+			for (size_t j = 0; j < c; j++) {
+				Acc l = coefficient(k, j);
+				if (l != Acc(0)) {
+					accumulate(l, scratch.data() + (i * c + j) * count, dst, count, first);
+				}
+			}
+			if (first) {
+				simd::fill(dst, Acc(0), count);
+			}
+		}
+	}
+}
+
+}
+
+template <typename T>
+BasicConv2D<T>::BasicConv2D(size_t inChannels, size_t outChannels, size_t kernelSize,
+                            size_t stride, size_t padding, size_t dilation)
+	: inChannels(inChannels), outChannels(outChannels), kernelSize(kernelSize),
+	  stride(stride), padding(padding), dilation(dilation),
+	  algorithm(ConvAlgorithm::Auto),
+	  weights({outChannels, inChannels, kernelSize, kernelSize}),
+	  biases({outChannels}),
+	  weightGrad({outChannels, inChannels, kernelSize, kernelSize}),
+	  biasGrad({outChannels}),
+	  inputCache({1}),
+	  transformTile(0),
+	  columnsValid(false),
+	  usedAlgorithm(ConvAlgorithm::Im2col) {
+
+	if (inChannels == 0 || outChannels == 0 || kernelSize == 0 || stride == 0 || dilation == 0) {
+		throw LayerDimensionError();
+	}
+	size_t area = kernelSize * kernelSize;
+	rng::defaultGenerator().xavierUniform(weights, inChannels * area, outChannels * area);
+	biases.fill(T(0));
+}
+
+template <typename T>
+size_t BasicConv2D<T>::outputSize(size_t size) const {
+	size_t span = dilation * (kernelSize - 1) + 1;
+	if (size + 2 * padding < span) {
+		throw LayerDimensionError();
+	}
+	return (size + 2 * padding - span) / stride + 1;
+}
+
+template <typename T>
+void BasicConv2D<T>::setAlgorithm(ConvAlgorithm algorithm) {
+	this->algorithm = algorithm;
+}
+
+template <typename T>
+ConvAlgorithm BasicConv2D<T>::selectedAlgorithm() const {
+	if (algorithm != ConvAlgorithm::Auto) {
+		return algorithm;
+	}
+	bool smallKernel = (kernelSize == 3 || kernelSize == 5);
+	if (smallKernel && stride == 1 && inChannels <= DIRECT_MAX_CHANNELS) {
+		return ConvAlgorithm::Direct;
+	}
+	if (kernelSize == 3 && stride == 1 && dilation == 1) {
+		return ConvAlgorithm::Winograd4x4;
+	}
+	return ConvAlgorithm::Im2col;
+}
+
+template <typename T>
+BasicTensor<T> BasicConv2D<T>::forward(const BasicTensor<T>& input) {
+	if (input.ndim() != 4 || input.getShape()[1] != inChannels) {
+		throw LayerDimensionError();
+	}
+	const Shape& shape = input.getShape();
+	BasicTensor<T> output({shape[0], outChannels, outputSize(shape[2]), outputSize(shape[3])});
+
+	inputCache = input;
+	usedAlgorithm = selectedAlgorithm();
+	bool winogradShape = (kernelSize == 3 && stride == 1 && dilation == 1);
+	bool winograd = (usedAlgorithm == ConvAlgorithm::Winograd2x2 || usedAlgorithm == ConvAlgorithm::Winograd4x4);
+	if ((usedAlgorithm == ConvAlgorithm::Direct && stride != 1) || (winograd && !winogradShape)) {
+		usedAlgorithm = ConvAlgorithm::Im2col;
+	}
+
+	switch (usedAlgorithm) {
+		case ConvAlgorithm::Direct:
+			columnsValid = false;
+			forwardDirect(input, output);
+			break;
+		case ConvAlgorithm::Winograd2x2:
+			columnsValid = false;
+			forwardWinograd(input, output, 2);
+			break;
+		case ConvAlgorithm::Winograd4x4:
+			columnsValid = false;
+			forwardWinograd(input, output, 4);
+			break;
+		default:
+			forwardIm2col(input, output);
+			break;
+	}
+	return output;
+}
+
+template <typename T>
+void BasicConv2D<T>::lower(const BasicTensor<T>& input) {
+	const Shape& shape = input.getShape();
+	Geometry g{shape[0], inChannels, shape[2], shape[3], outputSize(shape[2]), outputSize(shape[3]),
+	           kernelSize, stride, padding, dilation};
+	size_t colSize = g.patch() * g.positions();
+	columns.resize(g.batch * colSize);
+
+	Span<const T> inputValues = input.getData();
+	const T* x = inputValues.data();
+	T* cols = columns.data();
+	size_t sampleSize = g.channels * g.height * g.width;
+	parallel::parallelFor(g.batch, [&](size_t n) {
+		im2col(g, x + n * sampleSize, cols + n * colSize);
+	});
+	columnsValid = true;
+}
+
+template <typename T>
+void BasicConv2D<T>::forwardIm2col(const BasicTensor<T>& input, BasicTensor<T>& output) {
+	lower(input);
+
+	const Shape& shape = output.getShape();
+	size_t batch = shape[0];
+	size_t P = shape[2] * shape[3];
+	size_t patch = inChannels * kernelSize * kernelSize;
+
+	/* Start from the bias and let the GEMM accumulate onto it */
+	T* out = output.getData().data();
+	const T* bias = biases.getData().data();
+	for (size_t n = 0; n < batch; n++) {
+		for (size_t o = 0; o < outChannels; o++) {
+			simd::fill(out + (n * outChannels + o) * P, bias[o], P);
+		}
+	}
+
+	std::vector<const T*> a(batch, weights.getData().data());
+	std::vector<const T*> b(batch);
+	std::vector<T*> c(batch);
+	for (size_t n = 0; n < batch; n++) {
+		b[n] = columns.data() + n * patch * P;
+		c[n] = out + n * outChannels * P;
+	}
+	gemmBatched<T>(batch, outChannels, P, patch, 1, a.data(), patch, 1, b.data(), P, 1, 1, c.data(), P, 1);
+}
+
+template <typename T>
+void BasicConv2D<T>::forwardDirect(const BasicTensor<T>& input, BasicTensor<T>& output) {
+	using Acc = typename ComputeType<T>::type;
+	const Shape& shape = input.getShape();
+	Geometry g{shape[0], inChannels, shape[2], shape[3], outputSize(shape[2]), outputSize(shape[3]),
+	           kernelSize, stride, padding, dilation};
+	size_t K = g.kernel;
+	size_t width = g.paddedWidth();
+	size_t plane = g.paddedPlane();
+	size_t count = Geometry::chunked(g.outWidth);
+	size_t sources = g.channels * K;
+	padded.resize(g.batch * g.channels * plane);
+
+	DirectKernels<Acc> kernels = selectDirectKernels<Acc>();
+	Span<const T> inputValues = input.getData();
+	const T* x = inputValues.data();
+	const T* w = weights.getData().data();
+	const T* b = biases.getData().data();
+	std::vector<Acc> taps(w, w + weights.size());
+	std::vector<Acc> bias(b, b + outChannels);
+	T* out = output.getData().data();
+
+	/* One task per sample: pad its planes once, then build each output row of every channel */
+	parallel::parallelFor(g.batch, [&](size_t n) {
+		Acc* xp = padded.data() + n * g.channels * plane;
+		for (size_t c = 0; c < g.channels; c++) {
+			borderPlane(x + (n * g.channels + c) * g.height * g.width, g.height, g.width,
+			            g.padding, width, plane, xp + c * plane);
+		}
+
+		static thread_local std::vector<const Acc*> rows;
+		static thread_local std::vector<Acc> result;
+		rows.resize(sources);
+		result.resize(outChannels * count);
+		for (size_t oh = 0; oh < g.outHeight; oh++) {
+			for (size_t c = 0; c < g.channels; c++) {
+				for (size_t kh = 0; kh < K; kh++) {
+					rows[c * K + kh] = xp + c * plane + (oh + kh * g.dilation) * width;
+				}
+			}
+			correlateBanks(kernels, outChannels, sources, rows.data(), taps.data(), K, g.dilation,
+			               count, bias.data(), result.data(), count);
+			for (size_t o = 0; o < outChannels; o++) {
+				T* dst = out + ((n * outChannels + o) * g.outHeight + oh) * g.outWidth;
+				for (size_t ow = 0; ow < g.outWidth; ow++) {
+					dst[ow] = static_cast<T>(result[o * count + ow]);
+				}
+			}
+		}
+	});
+}
+
+template <typename T>
+BasicTensor<T> BasicConv2D<T>::backward(const BasicTensor<T>& gradOutput) {
+	const Shape& shape = inputCache.getShape();
+	if (inputCache.ndim() != 4 || gradOutput.ndim() != 4 ||
+	    gradOutput.getShape() != Shape{shape[0], outChannels, outputSize(shape[2]), outputSize(shape[3])}) {
+		throw LayerDimensionError();
+	}
+
+	BasicTensor<T> gradInput(shape);
+	switch (usedAlgorithm) {
+		case ConvAlgorithm::Direct:
+			backwardDirect(gradOutput, gradInput);
+			break;
+		case ConvAlgorithm::Winograd2x2:
+			backwardWinograd(gradOutput, gradInput, 2);
+			break;
+		case ConvAlgorithm::Winograd4x4:
+			backwardWinograd(gradOutput, gradInput, 4);
+			break;
+		default:
+			backwardIm2col(gradOutput, gradInput);
+			break;
+	}
+	return gradInput;
+}
+
+template <typename T>
+void BasicConv2D<T>::backwardIm2col(const BasicTensor<T>& gradOutput, BasicTensor<T>& gradInput) {
+	using Acc = typename ComputeType<T>::type;
+	if (!columnsValid) {
+		lower(inputCache);
+	}
+
+	const Shape& shape = inputCache.getShape();
+	Geometry g{shape[0], inChannels, shape[2], shape[3], outputSize(shape[2]), outputSize(shape[3]),
+	           kernelSize, stride, padding, dilation};
+	size_t P = g.positions();
+	size_t patch = g.patch();
+	Span<const T> gradOutputValues = gradOutput.getData();
+	const T* gy = gradOutputValues.data();
+
+	/* dW = sum_n dY_n * columns_n^T, db = sum_n sum_p dY_n */
+	T* dw = weightGrad.getData().data();
+	for (size_t n = 0; n < g.batch; n++) {
+		gemm<T>(outChannels, patch, P, 1, gy + n * outChannels * P, P, 1,
+		        columns.data() + n * patch * P, 1, P, (n == 0) ? 0 : 1, dw, patch, 1);
+	}
+	T* db = biasGrad.getData().data();
+	for (size_t o = 0; o < outChannels; o++) {
+		Acc sum = Acc(0);
+		for (size_t n = 0; n < g.batch; n++) {
+			sum += simd::reduceSum(gy + (n * outChannels + o) * P, P);
+		}
+		db[o] = static_cast<T>(sum);
+	}
+
+	/* dColumns_n = W^T * dY_n overwrites the columns, then folds back onto dX_n */
+	std::vector<const T*> a(g.batch, weights.getData().data());
+	std::vector<const T*> b(g.batch);
+	std::vector<T*> c(g.batch);
+	for (size_t n = 0; n < g.batch; n++) {
+		b[n] = gy + n * outChannels * P;
+		c[n] = columns.data() + n * patch * P;
+	}
+	gemmBatched<T>(g.batch, patch, P, outChannels, 1, a.data(), 1, patch, b.data(), P, 1, 0, c.data(), P, 1);
+	columnsValid = false;
+
+	T* dx = gradInput.getData().data();
+	size_t sampleSize = g.channels * g.height * g.width;
+	parallel::parallelFor(g.batch, [&](size_t n) {
+		col2im(g, columns.data() + n * patch * P, dx + n * sampleSize);
+	});
+}
+
+template <typename T>
+void BasicConv2D<T>::backwardDirect(const BasicTensor<T>& gradOutput, BasicTensor<T>& gradInput) {
+	using Acc = typename ComputeType<T>::type;
+	const Shape& shape = inputCache.getShape();
+	Geometry g{shape[0], inChannels, shape[2], shape[3], outputSize(shape[2]), outputSize(shape[3]),
+	           kernelSize, stride, padding, dilation};
+	size_t K = g.kernel;
+	size_t span = g.span();
+	size_t width = g.paddedWidth();
+	size_t plane = g.paddedPlane();
+	size_t bordered = g.borderedWidth();
+	size_t borderedPlane = g.borderedPlane();
+	size_t P = g.positions();
+
+	DirectKernels<Acc> kernels = selectDirectKernels<Acc>();
+	const T* w = weights.getData().data();
+	Span<const T> gradOutputValues = gradOutput.getData();
+	const T* gy = gradOutputValues.data();
+	T* dw = weightGrad.getData().data();
+	T* db = biasGrad.getData().data();
+	T* dx = gradInput.getData().data();
+
+	/* Output gradients widened into zero-bordered planes, so no loop needs bounds checks */
+	std::vector<Acc> gyb(g.batch * outChannels * borderedPlane);
+	parallel::parallelFor(g.batch * outChannels, [&](size_t task) {
+		borderPlane(gy + task * P, g.outHeight, g.outWidth, span, bordered, borderedPlane,
+		            gyb.data() + task * borderedPlane);
+	});
+
+	/* Kernel gradients: each kernel row correlates output-gradient rows with shifted padded input rows */
+	parallel::parallelFor(outChannels, [&](size_t o) {
+		Acc biasSum = Acc(0);
+		for (size_t n = 0; n < g.batch; n++) {
+			biasSum += simd::reduceSum(gy + (n * outChannels + o) * P, P);
+		}
+		db[o] = static_cast<T>(biasSum);
+
+		std::vector<Acc> sums(K);
+		for (size_t c = 0; c < g.channels; c++) {
+			for (size_t kh = 0; kh < K; kh++) {
+				std::fill(sums.begin(), sums.end(), Acc(0));
+				for (size_t n = 0; n < g.batch; n++) {
+					const Acc* grad = gyb.data() + (n * outChannels + o) * borderedPlane + span * bordered + span;
+					const Acc* xp = padded.data() + (n * g.channels + c) * plane + kh * g.dilation * width;
+					kernels.taps(g.outHeight, grad, bordered, xp, width, Geometry::chunked(g.outWidth),
+					             K, g.dilation, sums.data());
+				}
+				for (size_t kw = 0; kw < K; kw++) {
+					dw[((o * g.channels + c) * K + kh) * K + kw] = static_cast<T>(sums[kw]);
+				}
+			}
+		}
+	});
+
+	/* Input gradients: the bordered output gradients correlated with the flipped kernels */
+	std::vector<Acc> flipped(weights.size());
+	for (size_t c = 0; c < g.channels; c++) {
+		for (size_t o = 0; o < outChannels; o++) {
+			for (size_t kh = 0; kh < K; kh++) {
+				for (size_t kw = 0; kw < K; kw++) {
+					flipped[((c * outChannels + o) * K + kh) * K + kw] =
+						static_cast<Acc>(w[((o * g.channels + c) * K + kh) * K + (K - 1 - kw)]);
+				}
+			}
+		}
+	}
+	std::vector<Acc> zeros(g.channels, Acc(0));
+	size_t count = Geometry::chunked(g.width);
+	size_t sources = outChannels * K;
+
+	parallel::parallelFor(g.batch, [&](size_t n) {
+		static thread_local std::vector<const Acc*> rows;
+		static thread_local std::vector<Acc> result;
+		rows.resize(sources);
+		result.resize(g.channels * count);
+		for (size_t i = 0; i < g.height; i++) {
+			for (size_t o = 0; o < outChannels; o++) {
+				const Acc* grad = gyb.data() + (n * outChannels + o) * borderedPlane + g.padding;
+				for (size_t kh = 0; kh < K; kh++) {
+					rows[o * K + kh] = grad + (i + g.padding + span - kh * g.dilation) * bordered;
+				}
+			}
+			correlateBanks(kernels, g.channels, sources, rows.data(), flipped.data(), K, g.dilation,
+			               count, zeros.data(), result.data(), count);
+			for (size_t c = 0; c < g.channels; c++) {
+				T* dst = dx + ((n * g.channels + c) * g.height + i) * g.width;
+				for (size_t j = 0; j < g.width; j++) {
+					dst[j] = static_cast<T>(result[c * count + j]);
+				}
+			}
+		}
+	});
+}
+
+template <typename T>
+void BasicConv2D<T>::transformWeights(size_t tile) {
+	using Acc = typename ComputeType<T>::type;
+	const T* w = weights.getData().data();
+	size_t count = weights.size();
+	if (tile == transformTile && transformSource.size() == count &&
+	    std::equal(w, w + count, transformSource.begin())) {
+		return;
+	}
+
+	/* U[xi][o][c] = (G g G^T)[xi], all kernels transformed at once */
+	Winograd wg = winograd(tile);
+	size_t pairs = outChannels * inChannels;
+	std::vector<Acc> kernels(9 * pairs);
+	std::vector<Acc> scratch;
+	for (size_t k = 0; k < pairs; k++) {
+		for (size_t i = 0; i < 9; i++) {
+			kernels[i * pairs + k] = static_cast<Acc>(w[k * 9 + i]);
+		}
+	}
+	transformedWeights.resize(wg.alpha * wg.alpha * pairs);
+	sandwich(wg.G, wg.alpha, 3, false, kernels.data(), pairs, transformedWeights.data(), pairs, pairs, scratch);
+	transformSource.assign(w, w + count);
+	transformTile = tile;
+}
+
+template <typename T>
+void BasicConv2D<T>::forwardWinograd(const BasicTensor<T>& input, BasicTensor<T>& output, size_t tile) {
+	using Acc = typename ComputeType<T>::type;
+	transformWeights(tile);
+
+	const Shape& shape = input.getShape();
+	Winograd wg = winograd(tile);
+	size_t alpha = wg.alpha;
+	size_t area = alpha * alpha;
+	size_t batch = shape[0];
+	size_t H = shape[2];
+	size_t W = shape[3];
+	size_t OH = outputSize(H);
+	size_t OW = outputSize(W);
+	size_t tilesH = (OH + tile - 1) / tile;
+	size_t tilesW = (OW + tile - 1) / tile;
+	size_t perSample = tilesH * tilesW;
+	size_t tiles = batch * perSample;
+	transformedTiles.resize(area * inChannels * tiles);
+	products.resize(area * outChannels * tiles);
+
+	/* V[xi][c][t] = (B^T d B)[xi] for every overlapping alpha x alpha input tile d, zero outside the input */
+	Span<const T> inputValues = input.getData();
+	const T* x = inputValues.data();
+	Acc* v = transformedTiles.data();
+	parallel::parallelFor(inChannels, [&](size_t c) {
+		std::vector<Acc> d(area * tiles);
+		std::vector<Acc> scratch;
+		for (size_t n = 0; n < batch; n++) {
+			const T* plane = x + (n * inChannels + c) * H * W;
+			for (size_t i = 0; i < alpha; i++) {
+				for (size_t j = 0; j < alpha; j++) {
+					Acc* dst = d.data() + (i * alpha + j) * tiles + n * perSample;
+					for (size_t th = 0; th < tilesH; th++) {
+						ptrdiff_t row = static_cast<ptrdiff_t>(th * tile + i) - static_cast<ptrdiff_t>(padding);
+						bool rowInside = row >= 0 && row < static_cast<ptrdiff_t>(H);
+						for (size_t tw = 0; tw < tilesW; tw++) {
+							ptrdiff_t col = static_cast<ptrdiff_t>(tw * tile + j) - static_cast<ptrdiff_t>(padding);
+							bool inside = rowInside && col >= 0 && col < static_cast<ptrdiff_t>(W);
+							dst[th * tilesW + tw] = inside ? static_cast<Acc>(plane[row * W + col]) : Acc(0);
+						}
+					}
+				}
+			}
+		}
+		sandwich(wg.BT, alpha, alpha, false, d.data(), tiles, v + c * tiles, inChannels * tiles, tiles, scratch);
+	});
+
+	/* M[xi] = U[xi] V[xi]: one {outChannels, inChannels} x {inChannels, tiles} product per element */
+	std::vector<const Acc*> a(area);
+	std::vector<const Acc*> b(area);
+	std::vector<Acc*> c(area);
+	for (size_t xi = 0; xi < area; xi++) {
+		a[xi] = transformedWeights.data() + xi * outChannels * inChannels;
+		b[xi] = v + xi * inChannels * tiles;
+		c[xi] = products.data() + xi * outChannels * tiles;
+	}
+	gemmBatched<Acc>(area, outChannels, tiles, inChannels, 1, a.data(), inChannels, 1,
+	                 b.data(), tiles, 1, 0, c.data(), tiles, 1);
+
+	/* Y = A^T M A gives tile x tile output blocks, cropped at the edges */
+	const Acc* m = products.data();
+	const T* bias = biases.getData().data();
+	T* out = output.getData().data();
+	parallel::parallelFor(outChannels, [&](size_t o) {
+		std::vector<Acc> y(tile * tile * tiles);
+		std::vector<Acc> scratch;
+		sandwich(wg.AT, tile, alpha, false, m + o * tiles, outChannels * tiles, y.data(), tiles, tiles, scratch);
+		Acc shift = static_cast<Acc>(bias[o]);
+		for (size_t n = 0; n < batch; n++) {
+			const Acc* blocks = y.data() + n * perSample;
+			T* plane = out + (n * outChannels + o) * OH * OW;
+			for (size_t oh = 0; oh < OH; oh++) {
+				for (size_t ow = 0; ow < OW; ow++) {
+					size_t t = (oh / tile) * tilesW + ow / tile;
+					plane[oh * OW + ow] = static_cast<T>(blocks[((oh % tile) * tile + ow % tile) * tiles + t] + shift);
+				}
+			}
+		}
+	});
+}
+
+template <typename T>
+void BasicConv2D<T>::backwardWinograd(const BasicTensor<T>& gradOutput, BasicTensor<T>& gradInput, size_t tile) {
+	using Acc = typename ComputeType<T>::type;
+	const Shape& shape = inputCache.getShape();
+	Winograd wg = winograd(tile);
+	size_t alpha = wg.alpha;
+	size_t area = alpha * alpha;
+	size_t batch = shape[0];
+	size_t H = shape[2];
+	size_t W = shape[3];
+	size_t OH = outputSize(H);
+	size_t OW = outputSize(W);
+	size_t P = OH * OW;
+	size_t tilesH = (OH + tile - 1) / tile;
+	size_t tilesW = (OW + tile - 1) / tile;
+	size_t perSample = tilesH * tilesW;
+	size_t tiles = batch * perSample;
+
+	/* dM = A dY A^T per output tile, zero past the output edge */
+	Span<const T> gradOutputValues = gradOutput.getData();
+	const T* gy = gradOutputValues.data();
+	Acc* dm = products.data();
+	parallel::parallelFor(outChannels, [&](size_t o) {
+		std::vector<Acc> dy(tile * tile * tiles, Acc(0));
+		std::vector<Acc> scratch;
+		for (size_t n = 0; n < batch; n++) {
+			const T* plane = gy + (n * outChannels + o) * P;
+			Acc* blocks = dy.data() + n * perSample;
+			for (size_t oh = 0; oh < OH; oh++) {
+				for (size_t ow = 0; ow < OW; ow++) {
+					size_t t = (oh / tile) * tilesW + ow / tile;
+					blocks[((oh % tile) * tile + ow % tile) * tiles + t] = static_cast<Acc>(plane[oh * OW + ow]);
+				}
+			}
+		}
+		sandwich(wg.AT, alpha, tile, true, dy.data(), tiles, dm + o * tiles, outChannels * tiles, tiles, scratch);
+	});
+
+	/* dU = dM V^T, then dW = G^T dU G */
+	size_t pairs = outChannels * inChannels;
+	std::vector<Acc> du(area * pairs);
+	std::vector<const Acc*> a(area);
+	std::vector<const Acc*> b(area);
+	std::vector<Acc*> c(area);
+	for (size_t xi = 0; xi < area; xi++) {
+		a[xi] = dm + xi * outChannels * tiles;
+		b[xi] = transformedTiles.data() + xi * inChannels * tiles;
+		c[xi] = du.data() + xi * pairs;
+	}
+	gemmBatched<Acc>(area, outChannels, inChannels, tiles, 1, a.data(), tiles, 1,
+	                 b.data(), 1, tiles, 0, c.data(), inChannels, 1);
+
+	T* dw = weightGrad.getData().data();
+	T* db = biasGrad.getData().data();
+	std::vector<Acc> kernels(9 * pairs);
+	std::vector<Acc> scratch;
+	sandwich(wg.G, 3, alpha, true, du.data(), pairs, kernels.data(), pairs, pairs, scratch);
+	for (size_t k = 0; k < pairs; k++) {
+		for (size_t i = 0; i < 9; i++) {
+			dw[k * 9 + i] = static_cast<T>(kernels[i * pairs + k]);
+		}
+	}
+	parallel::parallelFor(outChannels, [&](size_t o) {
+		Acc biasSum = Acc(0);
+		for (size_t n = 0; n < batch; n++) {
+			biasSum += simd::reduceSum(gy + (n * outChannels + o) * P, P);
+		}
+		db[o] = static_cast<T>(biasSum);
+	});
+
+	/* dV = U^T dM in its own buffer (the tile transforms stay valid for another backward),
+	   then dX = B dV B^T summed over overlapping tiles */
+	std::vector<Acc> tileGrads(area * inChannels * tiles);
+	Acc* dv = tileGrads.data();
+	for (size_t xi = 0; xi < area; xi++) {
+		a[xi] = transformedWeights.data() + xi * pairs;
+		b[xi] = dm + xi * outChannels * tiles;
+		c[xi] = dv + xi * inChannels * tiles;
+	}
+	gemmBatched<Acc>(area, inChannels, tiles, outChannels, 1, a.data(), 1, inChannels,
+	                 b.data(), tiles, 1, 0, c.data(), tiles, 1);
+
+	T* dx = gradInput.getData().data();
+	parallel::parallelFor(inChannels, [&](size_t ci) {
+		std::vector<Acc> d(area * tiles);
+		std::vector<Acc> sums(H * W);
+		std::vector<Acc> scratch;
+		sandwich(wg.BT, alpha, alpha, true, dv + ci * tiles, inChannels * tiles, d.data(), tiles, tiles, scratch);
+		for (size_t n = 0; n < batch; n++) {
+			std::fill(sums.begin(), sums.end(), Acc(0));
+			for (size_t i = 0; i < alpha; i++) {
+				for (size_t j = 0; j < alpha; j++) {
+					const Acc* src = d.data() + (i * alpha + j) * tiles + n * perSample;
+					for (size_t th = 0; th < tilesH; th++) {
+						ptrdiff_t row = static_cast<ptrdiff_t>(th * tile + i) - static_cast<ptrdiff_t>(padding);
+						if (row < 0 || row >= static_cast<ptrdiff_t>(H)) {
+							continue;
+						}
+						for (size_t tw = 0; tw < tilesW; tw++) {
+							ptrdiff_t col = static_cast<ptrdiff_t>(tw * tile + j) - static_cast<ptrdiff_t>(padding);
+							if (col >= 0 && col < static_cast<ptrdiff_t>(W)) {
+								sums[row * W + col] += src[th * tilesW + tw];
+							}
+						}
+					}
+				}
+			}
+			T* plane = dx + (n * inChannels + ci) * H * W;
+			for (size_t i = 0; i < H * W; i++) {
+				plane[i] = static_cast<T>(sums[i]);
+			}
+		}
+	});
+}
+
+template <typename T>
+std::vector<BasicTensor<T>*> BasicConv2D<T>::getWeights() {
+	return {&weights, &biases};
+}
+
+template <typename T>
+std::vector<BasicTensor<T>*> BasicConv2D<T>::getGradients() {
+	return {&weightGrad, &biasGrad};
+}
+
+template class BasicConv2D<double>;
+template class BasicConv2D<float>;
+template class BasicConv2D<bfloat16>;
\ No newline at end of file
@@ -1,31 +1,51 @@
 /* dense.cpp */
 
 #include "../include/dense.hpp"
-#include <cmath>
-#include <cstdlib>
-#include <ctime>
+#include "../../tensor/include/rng.hpp"
 #include <cassert>
+#include <utility>
 
-Dense::Dense(size_t inputSize, size_t outputSize)
+template <typename T>
+BasicDense<T>::BasicDense(size_t inputSize, size_t outputSize)
 	: weights({outputSize, inputSize}),
 	  biases({outputSize}),
 	  weightGrad({outputSize, inputSize}),
 	  biasGrad({outputSize}),
-	  inputCache({1}) {
+	  inputCache({1}),
+	  sparseInput(false) {
 
-	std::srand(static_cast<unsigned int>(std::time(nullptr)));
-	double limit = std::sqrt(6.0 / (inputSize + outputSize));
+	rng::defaultGenerator().xavierUniform(weights, inputSize, outputSize);
+	biases.fill(T(0));
+}
 
-	double* weightsData = weights.getData().data();
-	for (size_t i = 0; i < weights.size(); i++) {
-		weightsData[i] = ((double)std::rand() / RAND_MAX) * 2 * limit - limit;
+template <typename T>
+BasicDense<T>::BasicDense(BasicTensor<T> weights, BasicTensor<T> biases)
+	: weights(std::move(weights)),
+	  biases(std::move(biases)),
+	  weightGrad({1}),
+	  biasGrad({1}),
+	  inputCache({1}),
+	  sparseInput(false) {
+
+	if (this->weights.ndim() != 2 || this->biases.ndim() != 1 ||
+	    this->biases.getShape()[0] != this->weights.getShape()[0]) {
+		throw LayerDimensionError();
 	}
+}
 
-	biases.fill(0.0);
+template <typename T>
+void BasicDense<T>::ensureGradients() {
+	if (weightGrad.getShape() != weights.getShape()) {
+		weightGrad = BasicTensor<T>(weights.getShape());
+		biasGrad = BasicTensor<T>(biases.getShape());
+	}
 }
 
-Tensor Dense::forward(const Tensor& input) {
+template <typename T>
+BasicTensor<T> BasicDense<T>::forward(const BasicTensor<T>& input) {
+	using Acc = typename ComputeType<T>::type;
 	inputCache = input;
+	sparseInput = false;
 
 	if (input.ndim() == 1) {
 		size_t outputSize = biases.getShape()[0];
@@ -33,108 +53,127 @@ Tensor Dense::forward(const Tensor& input) {
 		assert(weights.getShape()[0] == outputSize);
 		assert(weights.getShape()[1] == inputSize);
 
-		Tensor result({outputSize});
-		double* resultData = result.getData().data();
-		const double* inputData = input.getData().data();
-		const double* weightsData = weights.getData().data();
-		const double* biasData = biases.getData().data();
+		BasicTensor<T> result({outputSize});
+		T* resultData = result.getData().data();
+		Span<const T> inputValues = input.getData();
+		const T* inputData = inputValues.data();
+		const T* weightsData = weights.getData().data();
+		const T* biasData = biases.getData().data();
 
 		for (size_t i = 0; i < outputSize; i++) {
-			double sum = biasData[i];
+			Acc sum = biasData[i];
 			for (size_t j = 0; j < inputSize; j++) {
-				sum += weightsData[i * inputSize + j] * inputData[j];
+				sum += static_cast<Acc>(weightsData[i * inputSize + j]) * static_cast<Acc>(inputData[j]);
 			}
-			resultData[i] = sum;
+			resultData[i] = static_cast<T>(sum);
 		}
 		return result;
 	} else if (input.ndim() == 2) {
 		assert(input.getShape()[1] == weights.getShape()[1]);
 
-		Tensor inputT = input.transpose();
-		Tensor outputT = weights.matmul(inputT);
-		Tensor output = outputT.transpose();
+		BasicTensor<T> output({input.getShape()[0], weights.getShape()[0]});
+		BasicTensor<T>::matmul(output, input, weights, T(1), T(0), false, true);
 
-		double* outputData = output.getData().data();
-		const double* biasData = biases.getData().data();
-		size_t batchSize = output.getShape()[0];
-		size_t outputSize = output.getShape()[1];
-
-		for (size_t b = 0; b < batchSize; b++) {
-			for (size_t i = 0; i < outputSize; i++) {
-				outputData[b * outputSize + i] += biasData[i];
-			}
-		}
+		BasicTensor<T>::add(output, output, biases);
 		return output;
 	} else {
 		throw LayerDimensionError();
 	}
 }
 
-Tensor Dense::backward(const Tensor& gradOutput) {
+template <typename T>
+BasicTensor<T> BasicDense<T>::forward(const BasicSparseTensor<T>& input) {
+	if (input.cols() != weights.getShape()[1]) {
+		throw LayerDimensionError();
+	}
+	sparseCache = input;
+	sparseInput = true;
+
+	BasicTensor<T> output({input.rows(), weights.getShape()[0]});
+	BasicSparseTensor<T>::matmul(output, input, weights, T(1), T(0), true);
+
+	BasicTensor<T>::add(output, output, biases);
+	return output;
+}
+
+template <typename T>
+BasicTensor<T> BasicDense<T>::backward(const BasicTensor<T>& gradOutput) {
+	ensureGradients();
+
+	if (sparseInput) {
+		assert(gradOutput.getShape()[0] == sparseCache.rows());
+		assert(gradOutput.getShape()[1] == weightGrad.getShape()[0]);
+
+		BasicSparseTensor<T>::transposeMatmul(weightGrad, gradOutput, sparseCache);
+
+		BasicTensor<T>::sum(biasGrad, gradOutput, 0);
+
+		BasicTensor<T> gradInput({sparseCache.rows(), sparseCache.cols()});
+		BasicSparseTensor<T>::sampledMatmul(gradInput, sparseCache, gradOutput, weights);
+		return gradInput;
+	}
+
 	if (inputCache.ndim() == 1) {
+		using Acc = typename ComputeType<T>::type;
 		size_t outputSize = weightGrad.getShape()[0];
 		size_t inputSize = weightGrad.getShape()[1];
 		assert(gradOutput.getShape()[0] == outputSize);
 		assert(inputCache.getShape()[0] == inputSize);
 
-		double* weightGradData = weightGrad.getData().data();
-		const double* gradOutData = gradOutput.getData().data();
-		const double* inputData = inputCache.getData().data();
+		T* weightGradData = weightGrad.getData().data();
+		Span<const T> gradOutputValues = gradOutput.getData();
+		const T* gradOutData = gradOutputValues.data();
+		const T* inputData = inputCache.getData().data();
 
 		for (size_t i = 0; i < outputSize; i++) {
 			for (size_t j = 0; j < inputSize; j++) {
-				weightGradData[i * inputSize + j] = gradOutData[i] * inputData[j];
+				weightGradData[i * inputSize + j] = static_cast<T>(gradOutData[i] * inputData[j]);
 			}
 		}
 
-		double* biasGradData = biasGrad.getData().data();
+		T* biasGradData = biasGrad.getData().data();
 		for (size_t i = 0; i < outputSize; i++) {
 			biasGradData[i] = gradOutData[i];
 		}
 
-		Tensor gradInput({inputSize});
-		double* gradInputData = gradInput.getData().data();
-		const double* weightsData = weights.getData().data();
+		BasicTensor<T> gradInput({inputSize});
+		T* gradInputData = gradInput.getData().data();
+		const T* weightsData = weights.getData().data();
 
 		for (size_t j = 0; j < inputSize; j++) {
-			double sum = 0.0;
+			Acc sum = Acc(0);
 			for (size_t i = 0; i < outputSize; i++) {
-				sum += weightsData[i * inputSize + j] * gradOutData[i];
+				sum += static_cast<Acc>(weightsData[i * inputSize + j]) * static_cast<Acc>(gradOutData[i]);
 			}
-			gradInputData[j] = sum;
+			gradInputData[j] = static_cast<T>(sum);
 		}
 		return gradInput;
 	} else if (inputCache.ndim() == 2) {
 		assert(gradOutput.getShape()[1] == weightGrad.getShape()[0]);
 		assert(inputCache.getShape()[1] == weightGrad.getShape()[1]);
 
-		weightGrad = gradOutput.transpose().matmul(inputCache);
+		BasicTensor<T>::matmul(weightGrad, gradOutput, inputCache, T(1), T(0), true, false);
 
-		double* biasGradData = biasGrad.getData().data();
-		const double* gradOutData = gradOutput.getData().data();
-		size_t batchSize = gradOutput.getShape()[0];
-		size_t outputSize = biasGrad.getShape()[0];
+		BasicTensor<T>::sum(biasGrad, gradOutput, 0);
 
-		for (size_t i = 0; i < outputSize; i++) {
-			double sum = 0.0;
-			for (size_t b = 0; b < batchSize; b++) {
-				sum += gradOutData[b * outputSize + i];
-			}
-			biasGradData[i] = sum;
-		}
-
-		Tensor weightsT = weights.transpose();
-		Tensor gradInput = gradOutput.matmul(weightsT);
+		BasicTensor<T> gradInput = gradOutput.matmul(weights);
 		return gradInput;
 	} else {
 		throw LayerDimensionError();
 	}
 }
 
-std::vector<Tensor*> Dense::getWeights() {
+template <typename T>
+std::vector<BasicTensor<T>*> BasicDense<T>::getWeights() {
 	return {&weights, &biases};
 }
 
-std::vector<Tensor*> Dense::getGradients() {
+template <typename T>
+std::vector<BasicTensor<T>*> BasicDense<T>::getGradients() {
+	ensureGradients();
 	return {&weightGrad, &biasGrad};
-}
\ No newline at end of file
+}
+
+template class BasicDense<double>;
+template class BasicDense<float>;
+template class BasicDense<bfloat16>;
\ No newline at end of file
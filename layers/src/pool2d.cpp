@@ -0,0 +1,361 @@
+/* pool2d.cpp */
+
+#include "../include/pool2d.hpp"
+#include "../../tensor/include/parallel.hpp"
+#include "../../tensor/include/simd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+namespace {
+
+/**
+ * Sizes of one pooling problem and of its bordered plane
+ *
+ * The bordered plane holds the padded input split by stride phase in both
+ * directions: padded (row, col) is stored in sub-plane (row % stride,
+ * col % stride) at (row / stride, col / stride). Window tap (kh, kw) of
+ * output (oh, ow) then reads sub-plane (kh % stride, kw % stride) at
+ * (oh + kh / stride, ow + kw / stride), so over a whole output plane laid
+ * out with sub-plane rows each tap is one contiguous run. The columns past
+ * outWidth in every run are computed and thrown away.
+ */
+struct PoolGeometry {
+	size_t height;
+	size_t width;
+	size_t outHeight;
+	size_t outWidth;
+	size_t kernel;
+	size_t stride;
+	size_t padding;
+
+	size_t reach() const { return (kernel - 1) / stride; }
+	size_t phaseWidth() const { return outWidth + reach(); }
+	size_t phaseRows() const { return outHeight + reach() + 1; }
+	size_t phasePlane() const { return phaseRows() * phaseWidth(); }
+	size_t plane() const { return stride * stride * phasePlane(); }
+
+	/**
+	 * Get the length of a tap run: every output row widened to phaseWidth
+	 */
+	size_t outputs() const { return outHeight * phaseWidth(); }
+
+	/**
+	 * Get the start of the run of window tap (kh, kw)
+	 */
+	size_t tap(size_t kh, size_t kw) const {
+		return ((kh % stride) * stride + kw % stride) * phasePlane() + (kh / stride) * phaseWidth() + kw / stride;
+	}
+
+	/**
+	 * Get the sub-plane indices [first, last) along one axis that hold input positions
+	 *
+	 * size: Input height or width
+	 * phase: Row or column phase (0 to stride - 1)
+	 * limit: Sub-plane rows or columns
+	 */
+	void kept(size_t size, size_t phase, size_t limit, size_t& first, size_t& last) const {
+		first = (padding > phase) ? (padding - phase + stride - 1) / stride : 0;
+		last = std::min(limit, (size + padding - phase + stride - 1) / stride);
+		first = std::min(first, last);
+	}
+};
+
+/**
+ * Copy one input plane into a bordered plane filled with border elsewhere
+ */
+template <typename T, typename Acc>
+void borderPlane(const PoolGeometry& g, const T* x, Acc border, Acc* dst) {
+	std::fill(dst, dst + g.plane(), border);
+	for (size_t a = 0; a < g.stride; a++) {
+		size_t r0, r1;
+		g.kept(g.height, a, g.phaseRows(), r0, r1);
+		for (size_t b = 0; b < g.stride; b++) {
+			size_t c0, c1;
+			g.kept(g.width, b, g.phaseWidth(), c0, c1);
+			Acc* sub = dst + (a * g.stride + b) * g.phasePlane();
+			for (size_t r = r0; r < r1; r++) {
+				const T* src = x + (r * g.stride + a - g.padding) * g.width;
+				for (size_t c = c0; c < c1; c++) {
+					sub[r * g.phaseWidth() + c] = static_cast<Acc>(src[c * g.stride + b - g.padding]);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Read the input positions of a bordered plane back into one plane; positions it does not keep are zero
+ */
+template <typename T, typename Acc>
+void unborderPlane(const PoolGeometry& g, const Acc* src, T* x) {
+	std::fill(x, x + g.height * g.width, T(0));
+	for (size_t a = 0; a < g.stride; a++) {
+		size_t r0, r1;
+		g.kept(g.height, a, g.phaseRows(), r0, r1);
+		for (size_t b = 0; b < g.stride; b++) {
+			size_t c0, c1;
+			g.kept(g.width, b, g.phaseWidth(), c0, c1);
+			const Acc* sub = src + (a * g.stride + b) * g.phasePlane();
+			for (size_t r = r0; r < r1; r++) {
+				T* dst = x + (r * g.stride + a - g.padding) * g.width;
+				for (size_t c = c0; c < c1; c++) {
+					dst[c * g.stride + b - g.padding] = static_cast<T>(sub[r * g.phaseWidth() + c]);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Max pooling of one bordered plane, writing maxima and window offsets of the maxima
+ *
+ * The offsets are tracked in Acc lanes next to the maxima so each tap is
+ * one vector compare and two selects.
+ */
+template <typename T, typename Acc, typename Index>
+void maxPlane(const PoolGeometry& g, const Acc* plane, Acc* best, Acc* arg, T* y, Index* argmax) {
+	std::fill(best, best + g.outputs(), -std::numeric_limits<Acc>::infinity());
+	std::fill(arg, arg + g.outputs(), Acc(0));
+	for (size_t kh = 0; kh < g.kernel; kh++) {
+		for (size_t kw = 0; kw < g.kernel; kw++) {
+			Acc offset = static_cast<Acc>(kh * g.kernel + kw);
+			simd::maxUpdate(plane + g.tap(kh, kw), offset, best, arg, g.outputs());
+		}
+	}
+	for (size_t oh = 0; oh < g.outHeight; oh++) {
+		for (size_t ow = 0; ow < g.outWidth; ow++) {
+			y[oh * g.outWidth + ow] = static_cast<T>(best[oh * g.phaseWidth() + ow]);
+			argmax[oh * g.outWidth + ow] = static_cast<Index>(arg[oh * g.phaseWidth() + ow]);
+		}
+	}
+}
+
+/**
+ * Scatter one plane of output gradients onto the window maxima
+ */
+template <typename T, typename Acc, typename Index>
+void scatterPlane(const PoolGeometry& g, const T* gy, const Index* argmax, Acc* sums, T* dx) {
+	size_t area = g.height * g.width;
+	std::fill(sums, sums + area, Acc(0));
+	for (size_t oh = 0; oh < g.outHeight; oh++) {
+		for (size_t ow = 0; ow < g.outWidth; ow++) {
+			size_t tap = argmax[oh * g.outWidth + ow];
+			size_t row = oh * g.stride + tap / g.kernel;
+			size_t col = ow * g.stride + tap % g.kernel;
+			if (row >= g.padding && col >= g.padding && row - g.padding < g.height && col - g.padding < g.width) {
+				sums[(row - g.padding) * g.width + col - g.padding] += static_cast<Acc>(gy[oh * g.outWidth + ow]);
+			}
+		}
+	}
+	for (size_t i = 0; i < area; i++) {
+		dx[i] = static_cast<T>(sums[i]);
+	}
+}
+
+/**
+ * Max pooling of every plane, parallel across the batch
+ */
+template <typename T, typename Index>
+void maxPool(const PoolGeometry& g, size_t batch, size_t channels, const T* x, T* y, Index* argmax) {
+	using Acc = typename ComputeType<T>::type;
+	size_t inPlane = g.height * g.width;
+	size_t outPlane = g.outHeight * g.outWidth;
+	parallel::parallelFor(batch, [&](size_t n) {
+		std::vector<Acc> plane(g.plane());
+		std::vector<Acc> best(g.outputs());
+		std::vector<Acc> arg(g.outputs());
+		for (size_t c = 0; c < channels; c++) {
+			size_t p = n * channels + c;
+			borderPlane(g, x + p * inPlane, -std::numeric_limits<Acc>::infinity(), plane.data());
+			maxPlane(g, plane.data(), best.data(), arg.data(), y + p * outPlane, argmax + p * outPlane);
+		}
+	});
+}
+
+/**
+ * Max pooling backward for every plane, parallel across the batch
+ */
+template <typename T, typename Index>
+void maxUnpool(const PoolGeometry& g, size_t batch, size_t channels, const T* gy, const Index* argmax, T* dx) {
+	using Acc = typename ComputeType<T>::type;
+	size_t inPlane = g.height * g.width;
+	size_t outPlane = g.outHeight * g.outWidth;
+	parallel::parallelFor(batch, [&](size_t n) {
+		std::vector<Acc> sums(inPlane);
+		for (size_t c = 0; c < channels; c++) {
+			size_t p = n * channels + c;
+			scatterPlane(g, gy + p * outPlane, argmax + p * outPlane, sums.data(), dx + p * inPlane);
+		}
+	});
+}
+
+}
+
+template <typename T>
+BasicPool2D<T>::BasicPool2D(size_t kernelSize, size_t stride, size_t padding)
+	: kernelSize(kernelSize), stride(stride == 0 ? kernelSize : stride), padding(padding) {
+	if (kernelSize == 0 || padding >= kernelSize) {
+		throw LayerDimensionError();
+	}
+}
+
+template <typename T>
+size_t BasicPool2D<T>::outputSize(size_t size) const {
+	if (size + 2 * padding < kernelSize) {
+		throw LayerDimensionError();
+	}
+	return (size + 2 * padding - kernelSize) / stride + 1;
+}
+
+template <typename T>
+Shape BasicPool2D<T>::prepare(const BasicTensor<T>& input) {
+	if (input.ndim() != 4) {
+		throw LayerDimensionError();
+	}
+	const Shape& shape = input.getShape();
+	Shape output{shape[0], shape[1], outputSize(shape[2]), outputSize(shape[3])};
+	inputShape = shape;
+	return output;
+}
+
+template <typename T>
+void BasicPool2D<T>::checkGradient(const BasicTensor<T>& gradOutput) const {
+	if (inputShape.size() != 4 || gradOutput.getShape() !=
+	    Shape{inputShape[0], inputShape[1], outputSize(inputShape[2]), outputSize(inputShape[3])}) {
+		throw LayerDimensionError();
+	}
+}
+
+template <typename T>
+BasicTensor<T> BasicMaxPool2D<T>::forward(const BasicTensor<T>& input) {
+	BasicTensor<T> output(this->prepare(input));
+	const Shape& shape = output.getShape();
+	PoolGeometry g{this->inputShape[2], this->inputShape[3], shape[2], shape[3],
+	               this->kernelSize, this->stride, this->padding};
+	Span<const T> inputValues = input.getData();
+	const T* x = inputValues.data();
+	T* y = output.getData().data();
+
+	/* Window offsets fit a byte up to 16 x 16 windows */
+	if (this->kernelSize * this->kernelSize <= 256) {
+		wideArgmax.clear();
+		argmax.resize(output.size());
+		maxPool(g, shape[0], shape[1], x, y, argmax.data());
+	} else {
+		argmax.clear();
+		wideArgmax.resize(output.size());
+		maxPool(g, shape[0], shape[1], x, y, wideArgmax.data());
+	}
+	return output;
+}
+
+template <typename T>
+BasicTensor<T> BasicMaxPool2D<T>::backward(const BasicTensor<T>& gradOutput) {
+	this->checkGradient(gradOutput);
+	const Shape& shape = gradOutput.getShape();
+	PoolGeometry g{this->inputShape[2], this->inputShape[3], shape[2], shape[3],
+	               this->kernelSize, this->stride, this->padding};
+	BasicTensor<T> gradInput(this->inputShape);
+	Span<const T> gradOutputValues = gradOutput.getData();
+	const T* gy = gradOutputValues.data();
+	T* dx = gradInput.getData().data();
+	if (!argmax.empty()) {
+		maxUnpool(g, shape[0], shape[1], gy, argmax.data(), dx);
+	} else {
+		maxUnpool(g, shape[0], shape[1], gy, wideArgmax.data(), dx);
+	}
+	return gradInput;
+}
+
+template <typename T>
+BasicTensor<T> BasicAvgPool2D<T>::forward(const BasicTensor<T>& input) {
+	using Acc = typename ComputeType<T>::type;
+	BasicTensor<T> output(this->prepare(input));
+	const Shape& shape = output.getShape();
+	PoolGeometry g{this->inputShape[2], this->inputShape[3], shape[2], shape[3],
+	               this->kernelSize, this->stride, this->padding};
+	size_t batch = shape[0];
+	size_t channels = shape[1];
+	size_t inPlane = g.height * g.width;
+	size_t outPlane = g.outHeight * g.outWidth;
+	Acc scale = Acc(1) / static_cast<Acc>(g.kernel * g.kernel);
+	Span<const T> inputValues = input.getData();
+	const T* x = inputValues.data();
+	T* y = output.getData().data();
+
+	parallel::parallelFor(batch, [&](size_t n) {
+		std::vector<Acc> plane(g.plane());
+		std::vector<Acc> sum(g.outputs());
+		for (size_t c = 0; c < channels; c++) {
+			size_t p = n * channels + c;
+			borderPlane(g, x + p * inPlane, Acc(0), plane.data());
+			simd::fill(sum.data(), Acc(0), sum.size());
+			for (size_t kh = 0; kh < g.kernel; kh++) {
+				for (size_t kw = 0; kw < g.kernel; kw++) {
+					simd::add(sum.data(), plane.data() + g.tap(kh, kw), sum.data(), sum.size());
+				}
+			}
+			for (size_t oh = 0; oh < g.outHeight; oh++) {
+				T* dst = y + p * outPlane + oh * g.outWidth;
+				for (size_t ow = 0; ow < g.outWidth; ow++) {
+					dst[ow] = static_cast<T>(sum[oh * g.phaseWidth() + ow] * scale);
+				}
+			}
+		}
+	});
+	return output;
+}
+
+template <typename T>
+BasicTensor<T> BasicAvgPool2D<T>::backward(const BasicTensor<T>& gradOutput) {
+	using Acc = typename ComputeType<T>::type;
+	this->checkGradient(gradOutput);
+	const Shape& shape = gradOutput.getShape();
+	PoolGeometry g{this->inputShape[2], this->inputShape[3], shape[2], shape[3],
+	               this->kernelSize, this->stride, this->padding};
+	size_t batch = shape[0];
+	size_t channels = shape[1];
+	size_t inPlane = g.height * g.width;
+	size_t outPlane = g.outHeight * g.outWidth;
+	Acc scale = Acc(1) / static_cast<Acc>(g.kernel * g.kernel);
+	BasicTensor<T> gradInput(this->inputShape);
+	Span<const T> gradOutputValues = gradOutput.getData();
+	const T* gy = gradOutputValues.data();
+	T* dx = gradInput.getData().data();
+
+	/* Add the scaled gradients onto every tap run of the bordered plane, then read the input positions back;
+	   the thrown-away columns of each run carry zeros */
+	parallel::parallelFor(batch, [&](size_t n) {
+		std::vector<Acc> plane(g.plane());
+		std::vector<Acc> grad(g.outputs(), Acc(0));
+		for (size_t c = 0; c < channels; c++) {
+			size_t p = n * channels + c;
+			simd::fill(plane.data(), Acc(0), plane.size());
+			for (size_t oh = 0; oh < g.outHeight; oh++) {
+				const T* src = gy + p * outPlane + oh * g.outWidth;
+				for (size_t ow = 0; ow < g.outWidth; ow++) {
+					grad[oh * g.phaseWidth() + ow] = static_cast<Acc>(src[ow]) * scale;
+				}
+			}
+			for (size_t kh = 0; kh < g.kernel; kh++) {
+				for (size_t kw = 0; kw < g.kernel; kw++) {
+					Acc* dst = plane.data() + g.tap(kh, kw);
+					simd::add(dst, grad.data(), dst, grad.size());
+				}
+			}
+			unborderPlane(g, plane.data(), dx + p * inPlane);
+		}
+	});
+	return gradInput;
+}
+
+template class BasicPool2D<double>;
+template class BasicPool2D<float>;
+template class BasicPool2D<bfloat16>;
+template class BasicMaxPool2D<double>;
+template class BasicMaxPool2D<float>;
+template class BasicMaxPool2D<bfloat16>;
+template class BasicAvgPool2D<double>;
+template class BasicAvgPool2D<float>;
+template class BasicAvgPool2D<bfloat16>;
\ No newline at end of file
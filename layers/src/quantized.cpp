@@ -0,0 +1,42 @@
+/* quantized.cpp */
+
+#include "../include/quantized.hpp"
+#include <vector>
+
+template <typename T>
+BasicQuantizedDense<T>::BasicQuantizedDense(BasicDense<T>& dense, bool fuseRelu)
+	: biases(*dense.getWeights()[1]), relu(fuseRelu) {
+
+	const BasicTensor<T>& matrix = *dense.getWeights()[0];
+	weights = quant::PackedWeights(matrix.getData().data(), dense.outputSize(), dense.inputSize());
+}
+
+template <typename T>
+BasicTensor<T> BasicQuantizedDense<T>::forward(const BasicTensor<T>& input) {
+	if ((input.ndim() != 1 && input.ndim() != 2) || input.getShape()[input.ndim() - 1] != weights.inputs()) {
+		throw LayerDimensionError();
+	}
+
+	size_t batch = (input.ndim() == 2) ? input.getShape()[0] : 1;
+	size_t stride = weights.stride();
+	static thread_local std::vector<uint8_t> codes;
+	if (codes.size() < batch * stride) {
+		codes.resize(batch * stride);
+	}
+
+	quant::QuantParams params = quant::quantize(input.getData().data(), batch, weights.inputs(), codes.data(), stride);
+
+	BasicTensor<T> output = (input.ndim() == 2) ? BasicTensor<T>({batch, weights.outputs()})
+	                                             : BasicTensor<T>({weights.outputs()});
+	quant::gemm(batch, codes.data(), params, weights, biases.getData().data(), relu, output.getData().data());
+	return output;
+}
+
+template <typename T>
+BasicTensor<T> BasicQuantizedDense<T>::backward(const BasicTensor<T>&) {
+	throw InferenceOnlyError();
+}
+
+template class BasicQuantizedDense<double>;
+template class BasicQuantizedDense<float>;
+template class BasicQuantizedDense<bfloat16>;
\ No newline at end of file
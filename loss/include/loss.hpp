@@ -20,10 +20,13 @@ public:
 
 /**
  * Abstract base class for loss functions
+ *
+ * T: Element type of predictions and targets
  */
-class Loss {
+template <typename T>
+class BasicLoss {
 public:
-    virtual ~Loss() = default;
+    virtual ~BasicLoss() = default;
 
     /**
      * Compute the loss value
@@ -32,7 +35,7 @@ public:
      * targets: Ground truth targets
      * Output: Tensor containing the loss value (typically scalar)
      */
-    virtual Tensor forward(const Tensor& predictions, const Tensor& targets) = 0;
+    virtual BasicTensor<T> forward(const BasicTensor<T>& predictions, const BasicTensor<T>& targets) = 0;
 
     /**
      * Compute gradient: dL/d(predictions)
@@ -41,7 +44,10 @@ public:
      * targets: Ground truth targets
      * Output: Tensor containing gradient of loss with respect to predictions
      */
-    virtual Tensor backward(const Tensor& predictions, const Tensor& targets) = 0;
+    virtual BasicTensor<T> backward(const BasicTensor<T>& predictions, const BasicTensor<T>& targets) = 0;
 };
 
+using Loss = BasicLoss<double>;
+using LossF = BasicLoss<float>;
+
 #endif
\ No newline at end of file
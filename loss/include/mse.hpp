@@ -8,8 +8,11 @@
  *
  * Forward: L = (1/n) * sum((predictions - targets)^2)
  * Backward: dL/d(predictions) = (2/n) * (predictions - targets)
+ *
+ * T: Element type of predictions and targets
  */
-class MSE : public Loss {
+template <typename T>
+class BasicMSE : public BasicLoss<T> {
 public:
     /**
      * Compute MSE loss value
@@ -18,7 +21,7 @@ public:
      * targets: Ground truth targets
      * Output: Scalar tensor containing mean squared error
      */
-    Tensor forward(const Tensor& predictions, const Tensor& targets) override;
+    BasicTensor<T> forward(const BasicTensor<T>& predictions, const BasicTensor<T>& targets) override;
 
     /**
      * Compute gradient: dL/d(predictions) = (2/n) * (predictions - targets)
@@ -27,7 +30,15 @@ public:
      * targets: Ground truth targets
      * Output: Gradient tensor with same shape as predictions
      */
-    Tensor backward(const Tensor& predictions, const Tensor& targets) override;
+    BasicTensor<T> backward(const BasicTensor<T>& predictions, const BasicTensor<T>& targets) override;
 };
 
+extern template class BasicMSE<double>;
+extern template class BasicMSE<float>;
+extern template class BasicMSE<bfloat16>;
+
+using MSE = BasicMSE<double>;
+using MSEF = BasicMSE<float>;
+using MSEBF16 = BasicMSE<bfloat16>;
+
 #endif
\ No newline at end of file
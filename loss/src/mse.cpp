@@ -1,30 +1,34 @@
 /* mse.cpp */
 
 #include "../include/mse.hpp"
+#include "../../tensor/include/expr.hpp"
 
-Tensor MSE::forward(const Tensor& predictions, const Tensor& targets) {
+template <typename T>
+BasicTensor<T> BasicMSE<T>::forward(const BasicTensor<T>& predictions, const BasicTensor<T>& targets) {
     if (predictions.getShape() != targets.getShape()) {
         throw LossShapeMismatchError("Predictions and targets must have the same shape");
     }
 
-    Tensor diff = predictions - targets;
-    Tensor squared = diff.hadamard(diff);
+    /* One fused pass, no temporaries */
+    auto diff = lazy(predictions) - lazy(targets);
+    double sum = diff.hadamard(diff).sum();
 
-    double sum = 0.0;
-    for (size_t i = 0; i < squared.size(); i++) {
-        sum += squared.getData()[i];
-    }
-
-    double mse = sum / squared.size();
-    return Tensor({1}, {mse});
+    T mse = static_cast<T>(sum / predictions.size());
+    return BasicTensor<T>({1}, mse);
 }
 
-Tensor MSE::backward(const Tensor& predictions, const Tensor& targets) {
+template <typename T>
+BasicTensor<T> BasicMSE<T>::backward(const BasicTensor<T>& predictions, const BasicTensor<T>& targets) {
     if (predictions.getShape() != targets.getShape()) {
         throw LossShapeMismatchError("Predictions and targets must have the same shape");
     }
 
-    Tensor diff = predictions - targets;
-    double scale = 2.0 / diff.size();
-    return diff * scale;
-}
\ No newline at end of file
+    BasicTensor<T> diff = predictions - targets;
+    T scale = static_cast<T>(2.0 / diff.size());
+    diff.scale_(scale);
+    return diff;
+}
+
+template class BasicMSE<double>;
+template class BasicMSE<float>;
+template class BasicMSE<bfloat16>;
\ No newline at end of file
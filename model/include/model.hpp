@@ -27,19 +27,32 @@ public:
 	}
 };
 
+/**
+ * Exception thrown when a checkpoint cannot be written, read or trusted
+ */
+class CheckpointError : public std::exception {
+public:
+	const char* what() const noexcept override {
+		return "Checkpoint file is unreadable, corrupt or incompatible.";
+	}
+};
+
 /**
  * Abstract base class for neural network models
  *
  * Defines the interface for models composed of layers
  * Inspired by PyTorch's nn.Module
+ *
+ * T: Element type of activations and parameters
  */
-class Model {
+template <typename T>
+class BasicModel {
 protected:
 	bool training;
 
 public:
-	Model() : training(true) {}
-	virtual ~Model() = default;
+	BasicModel() : training(true) {}
+	virtual ~BasicModel() = default;
 
 	/**
 	 * Forward pass through the model
@@ -47,21 +60,21 @@ public:
 	 * input: Input tensor
 	 * Output: Model output tensor
 	 */
-	virtual Tensor forward(const Tensor& input) = 0;
+	virtual BasicTensor<T> forward(const BasicTensor<T>& input) = 0;
 
 	/**
 	 * Get all trainable parameters from the model
 	 *
 	 * Output: Vector of pointers to all weight tensors
 	 */
-	virtual std::vector<Tensor*> getParameters() = 0;
+	virtual std::vector<BasicTensor<T>*> getParameters() = 0;
 
 	/**
 	 * Get all parameter gradients from the model
 	 *
 	 * Output: Vector of pointers to all gradient tensors
 	 */
-	virtual std::vector<Tensor*> getGradients() = 0;
+	virtual std::vector<BasicTensor<T>*> getGradients() = 0;
 
 	/**
 	 * Set model to training mode
@@ -87,4 +100,8 @@ public:
 	}
 };
 
+using Model = BasicModel<double>;
+using ModelF = BasicModel<float>;
+using ModelBF16 = BasicModel<bfloat16>;
+
 #endif
\ No newline at end of file
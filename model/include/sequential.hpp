@@ -7,28 +7,43 @@
 #include "../../layers/include/layer.hpp"
 #include <vector>
 #include <memory>
+#include <string>
+
+/**
+ * How BasicSequential::load brings parameters into memory
+ *
+ * Read: Copy every parameter blob into pool memory
+ * Map: Map the blobs copy-on-write; pages are read on first use, so
+ *      startup cost does not grow with the parameter count
+ */
+enum class CheckpointLoad {
+	Read,
+	Map
+};
 
 /**
  * Sequential model that stacks layers in order
  *
+ * T: Element type of activations and parameters
  * layers: Ordered list of layers to apply
  *
  * Inspired by PyTorch's nn.Sequential
  */
-class Sequential : public Model {
+template <typename T>
+class BasicSequential : public BasicModel<T> {
 private:
-	std::vector<std::shared_ptr<Layer>> layers;
+	std::vector<std::shared_ptr<BasicLayer<T>>> layers;
 
 public:
-	Sequential();
-	~Sequential() override = default;
+	BasicSequential();
+	~BasicSequential() override = default;
 
 	/**
 	 * Add a layer to the end of the sequence
 	 *
 	 * layer: Shared pointer to layer to add
 	 */
-	void addLayer(std::shared_ptr<Layer> layer);
+	void addLayer(std::shared_ptr<BasicLayer<T>> layer);
 
 	/**
 	 * Forward pass through all layers in sequence
@@ -36,7 +51,7 @@ public:
 	 * input: Input tensor
 	 * Output: Output after passing through all layers
 	 */
-	Tensor forward(const Tensor& input) override;
+	BasicTensor<T> forward(const BasicTensor<T>& input) override;
 
 	/**
 	 * Backward pass: chain rule through all layers in reverse
@@ -44,21 +59,21 @@ public:
 	 * gradOutput: Gradient of loss with respect to output (dL/dy)
 	 * Output: Gradient of loss with respect to input (dL/dx)
 	 */
-	Tensor backward(const Tensor& gradOutput);
+	BasicTensor<T> backward(const BasicTensor<T>& gradOutput);
 
 	/**
 	 * Get all trainable parameters from all layers
 	 *
 	 * Output: Vector of pointers to all weight tensors
 	 */
-	std::vector<Tensor*> getParameters() override;
+	std::vector<BasicTensor<T>*> getParameters() override;
 
 	/**
 	 * Get all parameter gradients from all layers
 	 *
 	 * Output: Vector of pointers to all gradient tensors
 	 */
-	std::vector<Tensor*> getGradients() override;
+	std::vector<BasicTensor<T>*> getGradients() override;
 
 	/**
 	 * Get number of layers in the model
@@ -73,7 +88,56 @@ public:
 	 * index: Layer index (0-based)
 	 * Output: Shared pointer to the layer
 	 */
-	std::shared_ptr<Layer> getLayer(size_t index);
+	std::shared_ptr<BasicLayer<T>> getLayer(size_t index);
+
+	/**
+	 * Write the model to a binary checkpoint
+	 *
+	 * The file is little-endian and versioned: a 64-byte header, one record
+	 * per layer (Dense sizes or ActivationType), one record per parameter
+	 * with its offset, size and checksum, then the raw parameters, each
+	 * starting on a 64-byte boundary. It is assembled in memory, written
+	 * with one call to a temporary file and renamed over path, so a reader
+	 * never sees a partial checkpoint. Only Dense and Activation layers
+	 * can be saved.
+	 *
+	 * path: Destination file (throws CheckpointError or InvalidModelError)
+	 */
+	void save(const std::string& path) const;
+
+	/**
+	 * Rebuild a model from a binary checkpoint
+	 *
+	 * Checksums cover the layer and parameter tables and every parameter
+	 * blob. Verifying the blobs touches all of them, so pass verify = false
+	 * with CheckpointLoad::Map for startup in time independent of model size.
+	 *
+	 * path: Checkpoint written by save for the same element type
+	 * mode: Copy parameters in or map them from the file
+	 * verify: Check parameter checksums
+	 * Output: Model with the saved layers and parameters (throws CheckpointError)
+	 */
+	static BasicSequential load(const std::string& path, CheckpointLoad mode = CheckpointLoad::Read,
+	                            bool verify = true);
+
+	/**
+	 * Build an int8 inference copy of the model
+	 *
+	 * Every Dense layer becomes a QuantizedDense, and a ReLU directly after
+	 * it is fused into its epilogue instead of running as its own layer.
+	 * Other layers are carried over unchanged. The copy cannot be trained.
+	 *
+	 * Output: Quantized model sharing no parameters with this one
+	 */
+	BasicSequential quantize() const;
 };
 
+extern template class BasicSequential<double>;
+extern template class BasicSequential<float>;
+extern template class BasicSequential<bfloat16>;
+
+using Sequential = BasicSequential<double>;
+using SequentialF = BasicSequential<float>;
+using SequentialBF16 = BasicSequential<bfloat16>;
+
 #endif
\ No newline at end of file
@@ -1,19 +1,134 @@
 /* sequential.cpp */
 
 #include "../include/sequential.hpp"
+#include "../../layers/include/dense.hpp"
+#include "../../layers/include/activation.hpp"
+#include "../../layers/include/quantized.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 
-Sequential::Sequential() : Model() {}
+namespace {
 
-void Sequential::addLayer(std::shared_ptr<Layer> layer) {
+/* Parameters are stored as raw little-endian elements */
+constexpr bool HOST_LITTLE_ENDIAN = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+constexpr char CHECKPOINT_MAGIC[8] = {'C', 'N', 'N', 'C', 'K', 'P', 'T', '\0'};
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+/* Header, layer records and parameter records are fixed-size */
+constexpr size_t HEADER_BYTES = 64;
+constexpr size_t RECORD_BYTES = 32;
+
+/* Every parameter blob starts on a cache line */
+constexpr size_t BLOB_ALIGNMENT = 64;
+
+constexpr uint32_t LAYER_DENSE = 0;
+constexpr uint32_t LAYER_ACTIVATION = 1;
+
+constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+
+size_t alignUp(size_t bytes) {
+	return (bytes + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+}
+
+void putU32(unsigned char* p, uint32_t value) {
+	for (size_t i = 0; i < 4; i++) {
+		p[i] = static_cast<unsigned char>(value >> (8 * i));
+	}
+}
+
+void putU64(unsigned char* p, uint64_t value) {
+	for (size_t i = 0; i < 8; i++) {
+		p[i] = static_cast<unsigned char>(value >> (8 * i));
+	}
+}
+
+uint32_t getU32(const unsigned char* p) {
+	uint32_t value = 0;
+	for (size_t i = 0; i < 4; i++) {
+		value |= static_cast<uint32_t>(p[i]) << (8 * i);
+	}
+	return value;
+}
+
+uint64_t getU64(const unsigned char* p) {
+	uint64_t value = 0;
+	for (size_t i = 0; i < 8; i++) {
+		value |= static_cast<uint64_t>(p[i]) << (8 * i);
+	}
+	return value;
+}
+
+uint64_t rotl(uint64_t x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+uint64_t mix(uint64_t acc, uint64_t word) {
+	return rotl(acc + word * PRIME2, 31) * PRIME1;
+}
+
+/**
+ * 64-bit checksum over four independent lanes of 8-byte words
+ *
+ * The lanes keep several multiplies in flight, so verifying a blob runs
+ * close to memory bandwidth.
+ */
+uint64_t checksum(const unsigned char* data, size_t bytes) {
+	uint64_t lanes[4] = {PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1};
+	size_t i = 0;
+	for (; i + 32 <= bytes; i += 32) {
+		for (size_t k = 0; k < 4; k++) {
+			lanes[k] = mix(lanes[k], getU64(data + i + 8 * k));
+		}
+	}
+
+	uint64_t hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+	hash += bytes;
+	for (; i + 8 <= bytes; i += 8) {
+		hash = mix(hash, getU64(data + i));
+	}
+	uint64_t tail = 0;
+	for (size_t k = 0; i + k < bytes; k++) {
+		tail |= static_cast<uint64_t>(data[i + k]) << (8 * k);
+	}
+	hash = mix(hash, tail);
+
+	hash ^= hash >> 33;
+	hash *= PRIME2;
+	hash ^= hash >> 29;
+	hash *= PRIME1;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+/**
+ * One parameter blob: where it lives in the file and what it should hash to
+ */
+struct BlobRecord {
+	uint64_t offset;
+	uint64_t bytes;
+	uint64_t sum;
+};
+
+}
+
+template <typename T>
+BasicSequential<T>::BasicSequential() : BasicModel<T>() {}
+
+template <typename T>
+void BasicSequential<T>::addLayer(std::shared_ptr<BasicLayer<T>> layer) {
 	layers.push_back(layer);
 }
 
-Tensor Sequential::forward(const Tensor& input) {
+template <typename T>
+BasicTensor<T> BasicSequential<T>::forward(const BasicTensor<T>& input) {
 	if (layers.empty()) {
 		return input;
 	}
 
-	Tensor output = layers[0]->forward(input);
+	BasicTensor<T> output = layers[0]->forward(input);
 	for (size_t i = 1; i < layers.size(); i++) {
 		output = layers[i]->forward(output);
 	}
@@ -21,12 +136,13 @@ Tensor Sequential::forward(const Tensor& input) {
 	return output;
 }
 
-Tensor Sequential::backward(const Tensor& gradOutput) {
+template <typename T>
+BasicTensor<T> BasicSequential<T>::backward(const BasicTensor<T>& gradOutput) {
 	if (layers.empty()) {
 		return gradOutput;
 	}
 
-	Tensor gradInput = gradOutput;
+	BasicTensor<T> gradInput = gradOutput;
 	for (int i = layers.size() - 1; i >= 0; i--) {
 		gradInput = layers[i]->backward(gradInput);
 	}
@@ -34,12 +150,13 @@ Tensor Sequential::backward(const Tensor& gradOutput) {
 	return gradInput;
 }
 
-std::vector<Tensor*> Sequential::getParameters() {
-	std::vector<Tensor*> params;
+template <typename T>
+std::vector<BasicTensor<T>*> BasicSequential<T>::getParameters() {
+	std::vector<BasicTensor<T>*> params;
 
 	for (auto& layer : layers) {
 		if (layer->hasWeights()) {
-			std::vector<Tensor*> layerParams = layer->getWeights();
+			std::vector<BasicTensor<T>*> layerParams = layer->getWeights();
 			params.insert(params.end(), layerParams.begin(), layerParams.end());
 		}
 	}
@@ -47,12 +164,13 @@ std::vector<Tensor*> Sequential::getParameters() {
 	return params;
 }
 
-std::vector<Tensor*> Sequential::getGradients() {
-	std::vector<Tensor*> grads;
+template <typename T>
+std::vector<BasicTensor<T>*> BasicSequential<T>::getGradients() {
+	std::vector<BasicTensor<T>*> grads;
 
 	for (auto& layer : layers) {
 		if (layer->hasWeights()) {
-			std::vector<Tensor*> layerGrads = layer->getGradients();
+			std::vector<BasicTensor<T>*> layerGrads = layer->getGradients();
 			grads.insert(grads.end(), layerGrads.begin(), layerGrads.end());
 		}
 	}
@@ -60,13 +178,216 @@ std::vector<Tensor*> Sequential::getGradients() {
 	return grads;
 }
 
-size_t Sequential::numLayers() const {
+template <typename T>
+size_t BasicSequential<T>::numLayers() const {
 	return layers.size();
 }
 
-std::shared_ptr<Layer> Sequential::getLayer(size_t index) {
+template <typename T>
+std::shared_ptr<BasicLayer<T>> BasicSequential<T>::getLayer(size_t index) {
 	if (index >= layers.size()) {
 		throw LayerIndexOutOfRangeError();
 	}
 	return layers[index];
-}
\ No newline at end of file
+}
+
+template <typename T>
+void BasicSequential<T>::save(const std::string& path) const {
+	if (!HOST_LITTLE_ENDIAN) {
+		throw CheckpointError();
+	}
+
+	std::vector<unsigned char> records;
+	std::vector<BasicTensor<T>*> blobs;
+	for (const auto& layer : layers) {
+		unsigned char record[RECORD_BYTES] = {};
+		if (auto dense = std::dynamic_pointer_cast<BasicDense<T>>(layer)) {
+			putU32(record, LAYER_DENSE);
+			putU64(record + 8, dense->inputSize());
+			putU64(record + 16, dense->outputSize());
+			std::vector<BasicTensor<T>*> params = dense->getWeights();
+			blobs.insert(blobs.end(), params.begin(), params.end());
+		} else if (auto activation = std::dynamic_pointer_cast<BasicActivation<T>>(layer)) {
+			putU32(record, LAYER_ACTIVATION);
+			putU32(record + 4, static_cast<uint32_t>(activation->getType()));
+		} else {
+			throw InvalidModelError();
+		}
+		records.insert(records.end(), record, record + RECORD_BYTES);
+	}
+
+	size_t tableBytes = RECORD_BYTES * (layers.size() + blobs.size());
+	size_t dataOffset = alignUp(HEADER_BYTES + tableBytes);
+	std::vector<BlobRecord> placement(blobs.size());
+	size_t fileBytes = dataOffset;
+	for (size_t i = 0; i < blobs.size(); i++) {
+		placement[i].offset = fileBytes;
+		placement[i].bytes = blobs[i]->size() * sizeof(T);
+		fileBytes = alignUp(fileBytes + placement[i].bytes);
+	}
+
+	/* Assemble the whole file so it goes out in a single write */
+	std::vector<unsigned char> buffer(fileBytes, 0);
+	for (size_t i = 0; i < blobs.size(); i++) {
+		unsigned char* dst = buffer.data() + placement[i].offset;
+		Span<T> data = blobs[i]->getData();
+		std::memcpy(dst, data.data(), placement[i].bytes);
+		placement[i].sum = checksum(dst, placement[i].bytes);
+	}
+
+	unsigned char* table = buffer.data() + HEADER_BYTES;
+	std::memcpy(table, records.data(), records.size());
+	for (size_t i = 0; i < blobs.size(); i++) {
+		unsigned char* record = table + records.size() + i * RECORD_BYTES;
+		putU64(record, placement[i].offset);
+		putU64(record + 8, placement[i].bytes);
+		putU64(record + 16, placement[i].sum);
+	}
+
+	unsigned char* header = buffer.data();
+	std::memcpy(header, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+	putU32(header + 8, CHECKPOINT_VERSION);
+	putU32(header + 12, static_cast<uint32_t>(DTypeOf<T>::value));
+	putU64(header + 16, layers.size());
+	putU64(header + 24, blobs.size());
+	putU64(header + 32, dataOffset);
+	putU64(header + 40, fileBytes);
+	putU64(header + 48, checksum(table, tableBytes));
+
+	std::string temp = path + ".tmp";
+	std::FILE* file = std::fopen(temp.c_str(), "wb");
+	if (file == nullptr) {
+		throw CheckpointError();
+	}
+	bool ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+	ok = (std::fclose(file) == 0) && ok;
+	if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+		std::remove(temp.c_str());
+		throw CheckpointError();
+	}
+}
+
+template <typename T>
+BasicSequential<T> BasicSequential<T>::load(const std::string& path, CheckpointLoad mode, bool verify) {
+	if (!HOST_LITTLE_ENDIAN) {
+		throw CheckpointError();
+	}
+
+	std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+	if (file == nullptr) {
+		throw CheckpointError();
+	}
+
+	unsigned char header[HEADER_BYTES];
+	if (std::fread(header, 1, HEADER_BYTES, file.get()) != HEADER_BYTES ||
+	    std::memcmp(header, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 ||
+	    getU32(header + 8) != CHECKPOINT_VERSION ||
+	    getU32(header + 12) != static_cast<uint32_t>(DTypeOf<T>::value)) {
+		throw CheckpointError();
+	}
+
+	uint64_t layerCount = getU64(header + 16);
+	uint64_t blobCount = getU64(header + 24);
+	uint64_t fileBytes = getU64(header + 40);
+	if (std::fseek(file.get(), 0, SEEK_END) != 0 ||
+	    static_cast<uint64_t>(std::ftell(file.get())) != fileBytes ||
+	    layerCount > fileBytes / RECORD_BYTES || blobCount > fileBytes / RECORD_BYTES ||
+	    HEADER_BYTES + RECORD_BYTES * (layerCount + blobCount) > fileBytes) {
+		throw CheckpointError();
+	}
+
+	std::vector<unsigned char> table(RECORD_BYTES * (layerCount + blobCount));
+	if (std::fseek(file.get(), HEADER_BYTES, SEEK_SET) != 0 ||
+	    std::fread(table.data(), 1, table.size(), file.get()) != table.size() ||
+	    checksum(table.data(), table.size()) != getU64(header + 48)) {
+		throw CheckpointError();
+	}
+
+	const unsigned char* blobTable = table.data() + RECORD_BYTES * layerCount;
+	size_t nextBlob = 0;
+	auto loadBlob = [&](const Shape& shape) {
+		if (nextBlob >= blobCount) {
+			throw CheckpointError();
+		}
+		const unsigned char* record = blobTable + RECORD_BYTES * nextBlob++;
+		BlobRecord blob = {getU64(record), getU64(record + 8), getU64(record + 16)};
+		if (blob.bytes != shape.numel() * sizeof(T) || blob.offset % BLOB_ALIGNMENT != 0 ||
+		    blob.offset > fileBytes || blob.bytes > fileBytes - blob.offset) {
+			throw CheckpointError();
+		}
+
+		BasicTensor<T> tensor(Shape{1});
+		if (mode == CheckpointLoad::Map) {
+			try {
+				tensor = BasicTensor<T>::mapFile(path, blob.offset, shape, DTypeOf<T>::value, MapMode::CopyOnWrite);
+			} catch (const TensorFileError&) {
+				throw CheckpointError();
+			}
+		} else {
+			tensor = BasicTensor<T>(shape);
+			if (std::fseek(file.get(), static_cast<long>(blob.offset), SEEK_SET) != 0 ||
+			    std::fread(tensor.getData().data(), 1, blob.bytes, file.get()) != blob.bytes) {
+				throw CheckpointError();
+			}
+		}
+
+		if (verify) {
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(tensor.getData().data());
+			if (checksum(bytes, blob.bytes) != blob.sum) {
+				throw CheckpointError();
+			}
+		}
+		return tensor;
+	};
+
+	BasicSequential<T> model;
+	for (uint64_t i = 0; i < layerCount; i++) {
+		const unsigned char* record = table.data() + RECORD_BYTES * i;
+		uint32_t kind = getU32(record);
+		if (kind == LAYER_DENSE) {
+			size_t inputSize = getU64(record + 8);
+			size_t outputSize = getU64(record + 16);
+			BasicTensor<T> weights = loadBlob(Shape{outputSize, inputSize});
+			BasicTensor<T> biases = loadBlob(Shape{outputSize});
+			model.addLayer(std::make_shared<BasicDense<T>>(std::move(weights), std::move(biases)));
+		} else if (kind == LAYER_ACTIVATION && getU32(record + 4) <= static_cast<uint32_t>(ActivationType::Softmax)) {
+			model.addLayer(std::make_shared<BasicActivation<T>>(static_cast<ActivationType>(getU32(record + 4))));
+		} else {
+			throw CheckpointError();
+		}
+	}
+	if (nextBlob != blobCount) {
+		throw CheckpointError();
+	}
+
+	return model;
+}
+
+template <typename T>
+BasicSequential<T> BasicSequential<T>::quantize() const {
+	BasicSequential<T> result;
+	for (size_t i = 0; i < layers.size(); i++) {
+		auto dense = std::dynamic_pointer_cast<BasicDense<T>>(layers[i]);
+		if (!dense) {
+			auto activation = std::dynamic_pointer_cast<BasicActivation<T>>(layers[i]);
+			result.addLayer(activation ? std::make_shared<BasicActivation<T>>(activation->getType()) : layers[i]);
+			continue;
+		}
+
+		bool fuseRelu = false;
+		if (i + 1 < layers.size()) {
+			auto next = std::dynamic_pointer_cast<BasicActivation<T>>(layers[i + 1]);
+			fuseRelu = next && next->getType() == ActivationType::ReLU;
+		}
+		result.addLayer(std::make_shared<BasicQuantizedDense<T>>(*dense, fuseRelu));
+		if (fuseRelu) {
+			i++;
+		}
+	}
+	result.eval();
+	return result;
+}
+
+template class BasicSequential<double>;
+template class BasicSequential<float>;
+template class BasicSequential<bfloat16>;
\ No newline at end of file
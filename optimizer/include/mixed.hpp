@@ -0,0 +1,103 @@
+/* mixed.hpp */
+
+#ifndef MIXED_HPP
+#define MIXED_HPP
+
+#include "optimizer.hpp"
+#include <cstddef>
+#include <vector>
+
+/**
+ * Mixed-precision training driver with dynamic loss scaling
+ *
+ * The model runs its forward and backward passes in a narrow type while
+ * the wrapped optimizer updates float32 master copies of every parameter;
+ * after each update the masters are rounded back into the model. The loss
+ * gradient is multiplied by a scale before backward so small gradients
+ * survive the narrow type, and divided out again when gradients are
+ * widened. A step whose gradients hold an inf or NaN is skipped and halves
+ * the scale; every growthInterval clean steps double it.
+ *
+ * T: Element type of the model (bfloat16 or float)
+ */
+template <typename T>
+class BasicMixedPrecision {
+private:
+	std::vector<BasicTensor<T>*> parameters;
+	std::vector<BasicTensor<T>*> gradients;
+	std::vector<BasicTensor<float>> masters;
+	std::vector<BasicTensor<float>> masterGrads;
+	std::vector<BasicTensor<float>*> masterPtrs;
+	std::vector<BasicTensor<float>*> masterGradPtrs;
+	BasicOptimizer<float>& optimizer;
+	float scale;
+	size_t growthInterval;
+	size_t goodSteps;
+	size_t skippedSteps;
+
+public:
+	/**
+	 * Take float32 master copies of the model parameters
+	 *
+	 * parameters: Model parameters (from Model::getParameters())
+	 * gradients: Matching gradients (from Model::getGradients())
+	 * optimizer: Optimizer applied to the master copies
+	 * initialScale: First loss scale (a power of two keeps scaling exact)
+	 * growthInterval: Clean steps before the scale doubles
+	 */
+	BasicMixedPrecision(std::vector<BasicTensor<T>*> parameters, std::vector<BasicTensor<T>*> gradients,
+	                    BasicOptimizer<float>& optimizer, float initialScale = 65536.0f,
+	                    size_t growthInterval = 2000);
+
+	/**
+	 * Scale a loss gradient before it is passed to backward
+	 *
+	 * lossGrad: Gradient of the loss with respect to the model output
+	 * Output: lossGrad multiplied by the current loss scale
+	 */
+	BasicTensor<T> scaleLoss(const BasicTensor<T>& lossGrad) const;
+
+	/**
+	 * Unscale the gradients and update the parameters
+	 *
+	 * On overflow the update is skipped, the scale is halved and the
+	 * gradients are zeroed. The gradients are left as they are otherwise.
+	 *
+	 * Output: True if the parameters were updated
+	 */
+	bool step();
+
+	/**
+	 * Zero out the model gradients
+	 */
+	void zeroGrad();
+
+	/**
+	 * Get the current loss scale
+	 *
+	 * Output: Loss scale
+	 */
+	float lossScale() const { return scale; }
+
+	/**
+	 * Get the number of steps skipped because of overflow
+	 *
+	 * Output: Skipped step count
+	 */
+	size_t skipped() const { return skippedSteps; }
+
+	/**
+	 * Get the float32 master copies of the parameters
+	 *
+	 * Output: One master tensor per parameter
+	 */
+	const std::vector<BasicTensor<float>>& getMasters() const { return masters; }
+};
+
+extern template class BasicMixedPrecision<float>;
+extern template class BasicMixedPrecision<bfloat16>;
+
+using MixedPrecisionF = BasicMixedPrecision<float>;
+using MixedPrecisionBF16 = BasicMixedPrecision<bfloat16>;
+
+#endif
\ No newline at end of file
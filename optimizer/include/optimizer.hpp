@@ -17,10 +17,13 @@ public:
 
 /**
  * Abstract base class for optimization algorithms
+ *
+ * T: Element type of parameters and gradients
  */
-class Optimizer {
+template <typename T>
+class BasicOptimizer {
 public:
-	virtual ~Optimizer() = default;
+	virtual ~BasicOptimizer() = default;
 
 	/**
 	 * Perform a single optimization step
@@ -28,14 +31,22 @@ public:
 	 * parameters: Vector of pointers to parameter tensors
 	 * gradients: Vector of pointers to gradient tensors
 	 */
-	virtual void step(std::vector<Tensor*>& parameters, std::vector<Tensor*>& gradients) = 0;
+	virtual void step(std::vector<BasicTensor<T>*>& parameters, std::vector<BasicTensor<T>*>& gradients) = 0;
 
 	/**
 	 * Zero out all gradients
 	 *
 	 * gradients: Vector of pointers to gradient tensors
 	 */
-	virtual void zeroGrad(std::vector<Tensor*>& gradients);
+	virtual void zeroGrad(std::vector<BasicTensor<T>*>& gradients);
 };
 
+extern template class BasicOptimizer<double>;
+extern template class BasicOptimizer<float>;
+extern template class BasicOptimizer<bfloat16>;
+
+using Optimizer = BasicOptimizer<double>;
+using OptimizerF = BasicOptimizer<float>;
+using OptimizerBF16 = BasicOptimizer<bfloat16>;
+
 #endif
\ No newline at end of file
@@ -6,9 +6,11 @@
 /**
  * Stochastic Gradient Descent optimizer
  *
+ * T: Element type of parameters and gradients
  * learningRate: Step size for parameter updates
  */
-class SGD : public Optimizer {
+template <typename T>
+class BasicSGD : public BasicOptimizer<T> {
 private:
 	double learningRate;
 
@@ -18,7 +20,7 @@ public:
 	 *
 	 * lr: Learning rate (default 0.01)
 	 */
-	SGD(double lr = 0.01);
+	BasicSGD(double lr = 0.01);
 
 	/**
 	 * Perform SGD update: param = param - learningRate * grad
@@ -26,7 +28,7 @@ public:
 	 * parameters: Vector of pointers to parameter tensors
 	 * gradients: Vector of pointers to gradient tensors
 	 */
-	void step(std::vector<Tensor*>& parameters, std::vector<Tensor*>& gradients) override;
+	void step(std::vector<BasicTensor<T>*>& parameters, std::vector<BasicTensor<T>*>& gradients) override;
 
 	/**
 	 * Get current learning rate
@@ -43,4 +45,10 @@ public:
 	void setLearningRate(double lr);
 };
 
+extern template class BasicSGD<double>;
+extern template class BasicSGD<float>;
+
+using SGD = BasicSGD<double>;
+using SGDF = BasicSGD<float>;
+
 #endif
\ No newline at end of file
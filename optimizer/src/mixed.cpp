@@ -0,0 +1,114 @@
+/* mixed.cpp */
+
+#include "../include/mixed.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+/* The scale never shrinks below one: unscaled gradients are the floor */
+constexpr float MIN_LOSS_SCALE = 1.0f;
+
+/* Upper bound on the loss scale so it cannot keep growing without limit */
+constexpr float MAX_LOSS_SCALE = 16777216.0f;
+
+}
+
+template <typename T>
+BasicMixedPrecision<T>::BasicMixedPrecision(std::vector<BasicTensor<T>*> parameters, std::vector<BasicTensor<T>*> gradients,
+                                            BasicOptimizer<float>& optimizer, float initialScale, size_t growthInterval)
+	: parameters(std::move(parameters)), gradients(std::move(gradients)), optimizer(optimizer),
+	  scale(initialScale), growthInterval(growthInterval), goodSteps(0), skippedSteps(0) {
+
+	if (this->parameters.size() != this->gradients.size()) {
+		throw OptimizerSizeMismatchError();
+	}
+
+	masters.reserve(this->parameters.size());
+	masterGrads.reserve(this->parameters.size());
+	for (size_t i = 0; i < this->parameters.size(); i++) {
+		const BasicTensor<T>& param = *this->parameters[i];
+		if (param.size() != this->gradients[i]->size()) {
+			throw OptimizerSizeMismatchError();
+		}
+
+		BasicTensor<float> master(param.getShape());
+		Span<const T> paramValues = param.getData();
+		const T* src = paramValues.data();
+		float* dst = master.getData().data();
+		for (size_t j = 0; j < param.size(); j++) {
+			dst[j] = static_cast<float>(src[j]);
+		}
+		masters.push_back(std::move(master));
+		masterGrads.emplace_back(param.getShape());
+	}
+	for (size_t i = 0; i < masters.size(); i++) {
+		masterPtrs.push_back(&masters[i]);
+		masterGradPtrs.push_back(&masterGrads[i]);
+	}
+}
+
+template <typename T>
+BasicTensor<T> BasicMixedPrecision<T>::scaleLoss(const BasicTensor<T>& lossGrad) const {
+	BasicTensor<T> result(lossGrad.getShape());
+	Span<const T> lossGradValues = lossGrad.getData();
+	const T* src = lossGradValues.data();
+	T* dst = result.getData().data();
+	for (size_t i = 0; i < lossGrad.size(); i++) {
+		dst[i] = static_cast<T>(static_cast<float>(src[i]) * scale);
+	}
+	return result;
+}
+
+template <typename T>
+bool BasicMixedPrecision<T>::step() {
+	/* Widen and unscale, watching for values the narrow backward could not hold */
+	float inverse = 1.0f / scale;
+	bool overflow = false;
+	for (size_t i = 0; i < gradients.size(); i++) {
+		if (gradients[i]->size() != masterGrads[i].size()) {
+			throw OptimizerSizeMismatchError();
+		}
+		const T* src = gradients[i]->getData().data();
+		float* dst = masterGrads[i].getData().data();
+		for (size_t j = 0; j < masterGrads[i].size(); j++) {
+			float value = static_cast<float>(src[j]) * inverse;
+			overflow |= !std::isfinite(value);
+			dst[j] = value;
+		}
+	}
+
+	if (overflow) {
+		scale = std::max(scale * 0.5f, MIN_LOSS_SCALE);
+		goodSteps = 0;
+		skippedSteps++;
+		zeroGrad();
+		return false;
+	}
+
+	optimizer.step(masterPtrs, masterGradPtrs);
+	for (size_t i = 0; i < parameters.size(); i++) {
+		const float* src = masters[i].getData().data();
+		T* dst = parameters[i]->getData().data();
+		for (size_t j = 0; j < masters[i].size(); j++) {
+			dst[j] = static_cast<T>(src[j]);
+		}
+	}
+
+	if (++goodSteps >= growthInterval) {
+		scale = std::min(scale * 2.0f, MAX_LOSS_SCALE);
+		goodSteps = 0;
+	}
+	return true;
+}
+
+template <typename T>
+void BasicMixedPrecision<T>::zeroGrad() {
+	for (auto* grad : gradients) {
+		grad->fill(T(0));
+	}
+}
+
+template class BasicMixedPrecision<float>;
+template class BasicMixedPrecision<bfloat16>;
\ No newline at end of file
@@ -2,8 +2,13 @@
 
 #include "../include/optimizer.hpp"
 
-void Optimizer::zeroGrad(std::vector<Tensor*>& gradients) {
+template <typename T>
+void BasicOptimizer<T>::zeroGrad(std::vector<BasicTensor<T>*>& gradients) {
 	for (auto* grad : gradients) {
-		grad->fill(0.0);
+		grad->fill(T(0));
 	}
-}
\ No newline at end of file
+}
+
+template class BasicOptimizer<double>;
+template class BasicOptimizer<float>;
+template class BasicOptimizer<bfloat16>;
\ No newline at end of file
@@ -1,32 +1,38 @@
 /* sgd.cpp */
 
 #include "../include/sgd.hpp"
+#include "../../tensor/include/simd.hpp"
 
-SGD::SGD(double lr) : learningRate(lr) {}
+template <typename T>
+BasicSGD<T>::BasicSGD(double lr) : learningRate(lr) {}
 
-void SGD::step(std::vector<Tensor*>& parameters, std::vector<Tensor*>& gradients) {
+template <typename T>
+void BasicSGD<T>::step(std::vector<BasicTensor<T>*>& parameters, std::vector<BasicTensor<T>*>& gradients) {
 	if (parameters.size() != gradients.size()) {
 		throw OptimizerSizeMismatchError();
 	}
 
 	for (size_t i = 0; i < parameters.size(); i++) {
-		Tensor* param = parameters[i];
-		Tensor* grad = gradients[i];
+		BasicTensor<T>* param = parameters[i];
+		BasicTensor<T>* grad = gradients[i];
 
 		if (param->size() != grad->size()) {
 			throw OptimizerSizeMismatchError();
 		}
 
-		for (size_t j = 0; j < param->size(); j++) {
-			param->getData()[j] -= learningRate * grad->getData()[j];
-		}
+		simd::axpy(static_cast<T>(-learningRate), grad->getData().data(), param->getData().data(), param->size());
 	}
 }
 
-double SGD::getLearningRate() const {
+template <typename T>
+double BasicSGD<T>::getLearningRate() const {
 	return learningRate;
 }
 
-void SGD::setLearningRate(double lr) {
+template <typename T>
+void BasicSGD<T>::setLearningRate(double lr) {
 	learningRate = lr;
-}
\ No newline at end of file
+}
+
+template class BasicSGD<double>;
+template class BasicSGD<float>;
\ No newline at end of file
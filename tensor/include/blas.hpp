@@ -0,0 +1,35 @@
+/* blas.hpp */
+
+#ifndef BLAS_HPP
+#define BLAS_HPP
+
+#include <cstddef>
+
+/**
+ * Thin wrappers over the CBLAS library linked with make BLAS=<library>
+ *
+ * Kept apart from the rest of the tensor code because some cblas.h
+ * headers (OpenBLAS) declare types that clash with dtype.hpp. Only
+ * compiled in when GEMM_CBLAS is defined; gemm() is the only caller.
+ */
+namespace blas {
+
+/**
+ * C = alpha * op(A) * op(B) + beta * C through cblas_dgemm / cblas_sgemm
+ *
+ * rowMajor: Layout of all three matrices
+ * transA, transB: Use the operand transposed
+ * M, N, K: Product dimensions
+ * A, lda / B, ldb / C, ldc: Operands and their leading dimensions
+ */
+void gemm(bool rowMajor, bool transA, bool transB, size_t M, size_t N, size_t K,
+          double alpha, const double* A, size_t lda, const double* B, size_t ldb,
+          double beta, double* C, size_t ldc);
+
+void gemm(bool rowMajor, bool transA, bool transB, size_t M, size_t N, size_t K,
+          float alpha, const float* A, size_t lda, const float* B, size_t ldb,
+          float beta, float* C, size_t ldc);
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,95 @@
+/* dtype.hpp */
+
+#ifndef DTYPE_HPP
+#define DTYPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Element types a tensor can hold
+ */
+enum class DType {
+	Float32,
+	Float64,
+	BFloat16
+};
+
+/**
+ * Brain floating point: the upper 16 bits of an IEEE float32
+ *
+ * Keeps float32's exponent range with an 8-bit mantissa. Intended for
+ * storage; arithmetic promotes to float and rounds back on assignment.
+ *
+ * bits: Raw 16-bit encoding
+ */
+struct bfloat16 {
+	uint16_t bits;
+
+	bfloat16() : bits(0) {}
+
+	/**
+	 * Round a float to the nearest bfloat16 (ties to even)
+	 *
+	 * value: Value to convert
+	 */
+	bfloat16(float value) {
+		uint32_t u;
+		std::memcpy(&u, &value, sizeof(u));
+		if ((u & 0x7fffffffu) > 0x7f800000u) {
+			bits = static_cast<uint16_t>((u >> 16) | 0x40u);
+		} else {
+			u += 0x7fffu + ((u >> 16) & 1u);
+			bits = static_cast<uint16_t>(u >> 16);
+		}
+	}
+
+	/**
+	 * Widen to float (exact)
+	 *
+	 * Output: Float with the same value
+	 */
+	operator float() const {
+		uint32_t u = static_cast<uint32_t>(bits) << 16;
+		float value;
+		std::memcpy(&value, &u, sizeof(value));
+		return value;
+	}
+};
+
+/**
+ * Map an element type to its DType tag
+ */
+template <typename T> struct DTypeOf;
+template <> struct DTypeOf<float> { static constexpr DType value = DType::Float32; };
+template <> struct DTypeOf<double> { static constexpr DType value = DType::Float64; };
+template <> struct DTypeOf<bfloat16> { static constexpr DType value = DType::BFloat16; };
+
+/**
+ * Type used for arithmetic on elements of type T
+ *
+ * Storage-only types such as bfloat16 are computed in float.
+ */
+template <typename T> struct ComputeType { using type = T; };
+template <> struct ComputeType<bfloat16> { using type = float; };
+
+/**
+ * Get the size in bytes of one element of a dtype
+ *
+ * dtype: Element type
+ * Output: Bytes per element
+ */
+inline size_t dtypeSize(DType dtype) {
+	switch (dtype) {
+		case DType::Float32:
+			return sizeof(float);
+		case DType::Float64:
+			return sizeof(double);
+		case DType::BFloat16:
+			return sizeof(bfloat16);
+	}
+	return 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,256 @@
+/* expr.hpp */
+
+#ifndef EXPR_HPP
+#define EXPR_HPP
+
+#include "tensor.hpp"
+#include <type_traits>
+
+/**
+ * Lazy element-wise tensor expressions
+ *
+ * lazy(t) wraps a tensor so that +, -, scalar * and hadamard build an
+ * expression tree instead of computing intermediate tensors. The tree is
+ * evaluated in a single fused loop when it is assigned to a tensor or
+ * reduced with sum():
+ *
+ *   Tensor r = lazy(param) - lazy(grad) * lr;
+ *   double s = (lazy(a) - lazy(b)).hadamard(lazy(a) - lazy(b)).sum();
+ *
+ * Leaves refer to their tensor's buffer, so an expression must be
+ * consumed within the lifetime of the tensors it was built from. Elements
+ * are computed in ComputeType<T>; assigning an expression to one of its
+ * own operands is safe because every element only reads its own index.
+ */
+
+namespace expr {
+
+struct Add {
+	template <typename V>
+	static V apply(V a, V b) { return a + b; }
+};
+
+struct Sub {
+	template <typename V>
+	static V apply(V a, V b) { return a - b; }
+};
+
+struct Mul {
+	template <typename V>
+	static V apply(V a, V b) { return a * b; }
+};
+
+struct Div {
+	template <typename V>
+	static V apply(V a, V b) { return a / b; }
+};
+
+}
+
+template <typename Op, typename L, typename R>
+class BinaryExpr;
+
+/**
+ * Base of every expression node (CRTP)
+ *
+ * E: Concrete node type, which provides element_type, value_type,
+ *    operator[](size_t) and shape()
+ */
+template <typename E>
+class TensorExpr {
+public:
+	const E& self() const {
+		return static_cast<const E&>(*this);
+	}
+
+	/**
+	 * Get the number of elements the expression produces
+	 *
+	 * Output: Product of the shape
+	 */
+	size_t size() const {
+		size_t total = 1;
+		for (size_t dim : self().shape()) {
+			total *= dim;
+		}
+		return total;
+	}
+
+	/**
+	 * Lazy element-wise multiplication
+	 *
+	 * other: Expression with the same shape
+	 * Output: Product expression
+	 */
+	template <typename R>
+	BinaryExpr<expr::Mul, E, R> hadamard(const TensorExpr<R>& other) const {
+		return BinaryExpr<expr::Mul, E, R>(self(), other.self());
+	}
+
+	/**
+	 * Evaluate the expression and add up all elements
+	 *
+	 * Accumulates in double regardless of the element type.
+	 *
+	 * Output: Sum of all elements
+	 */
+	auto sum() const {
+		const E& e = self();
+		size_t n = size();
+		double total = 0.0;
+		for (size_t i = 0; i < n; i++) {
+			total += static_cast<double>(e[i]);
+		}
+		return static_cast<typename E::value_type>(total);
+	}
+};
+
+/**
+ * Leaf node reading the elements of a tensor
+ *
+ * T: Element type of the tensor
+ */
+template <typename T>
+class LeafExpr : public TensorExpr<LeafExpr<T>> {
+private:
+	Span<const T> data;
+	const Shape* dims;
+
+public:
+	using element_type = T;
+	using value_type = typename ComputeType<T>::type;
+
+	/**
+	 * Wrap a tensor (a non-contiguous view is read through a compact copy)
+	 *
+	 * tensor: Tensor to read from
+	 */
+	explicit LeafExpr(const BasicTensor<T>& tensor)
+		: data(tensor.getData()), dims(&tensor.getShape()) {}
+
+	value_type operator[](size_t i) const {
+		return static_cast<value_type>(data[i]);
+	}
+
+	const Shape& shape() const {
+		return *dims;
+	}
+};
+
+/**
+ * Element-wise combination of two expressions of the same shape
+ *
+ * Op: Operation with a static apply(a, b)
+ */
+template <typename Op, typename L, typename R>
+class BinaryExpr : public TensorExpr<BinaryExpr<Op, L, R>> {
+private:
+	L lhs;
+	R rhs;
+
+public:
+	using element_type = typename L::element_type;
+	using value_type = typename L::value_type;
+
+	static_assert(std::is_same<element_type, typename R::element_type>::value,
+	              "Expression operands must have the same element type");
+
+	BinaryExpr(const L& lhs, const R& rhs) : lhs(lhs), rhs(rhs) {
+		if (lhs.shape() != rhs.shape()) {
+			throw TensorDismatchError();
+		}
+	}
+
+	value_type operator[](size_t i) const {
+		return Op::apply(lhs[i], rhs[i]);
+	}
+
+	const Shape& shape() const {
+		return lhs.shape();
+	}
+};
+
+/**
+ * Expression multiplied by a scalar
+ */
+template <typename E>
+class ScaledExpr : public TensorExpr<ScaledExpr<E>> {
+private:
+	E inner;
+	typename E::value_type scalar;
+
+public:
+	using element_type = typename E::element_type;
+	using value_type = typename E::value_type;
+
+	ScaledExpr(const E& inner, value_type scalar) : inner(inner), scalar(scalar) {}
+
+	value_type operator[](size_t i) const {
+		return inner[i] * scalar;
+	}
+
+	const Shape& shape() const {
+		return inner.shape();
+	}
+};
+
+/**
+ * Start a lazy expression from a tensor
+ *
+ * tensor: Tensor to read from (must outlive the expression)
+ * Output: Leaf expression
+ */
+template <typename T>
+LeafExpr<T> lazy(const BasicTensor<T>& tensor) {
+	return LeafExpr<T>(tensor);
+}
+
+template <typename L, typename R>
+BinaryExpr<expr::Add, L, R> operator+(const TensorExpr<L>& lhs, const TensorExpr<R>& rhs) {
+	return BinaryExpr<expr::Add, L, R>(lhs.self(), rhs.self());
+}
+
+template <typename L, typename R>
+BinaryExpr<expr::Sub, L, R> operator-(const TensorExpr<L>& lhs, const TensorExpr<R>& rhs) {
+	return BinaryExpr<expr::Sub, L, R>(lhs.self(), rhs.self());
+}
+
+template <typename E>
+ScaledExpr<E> operator*(const TensorExpr<E>& e, typename E::value_type scalar) {
+	return ScaledExpr<E>(e.self(), scalar);
+}
+
+template <typename E>
+ScaledExpr<E> operator*(typename E::value_type scalar, const TensorExpr<E>& e) {
+	return ScaledExpr<E>(e.self(), scalar);
+}
+
+template <typename T>
+template <typename E>
+BasicTensor<T>::BasicTensor(const TensorExpr<E>& expr) : BasicTensor(expr.self().shape()) {
+	*this = expr;
+}
+
+template <typename T>
+template <typename E>
+BasicTensor<T>& BasicTensor<T>::operator=(const TensorExpr<E>& expr) {
+	static_assert(std::is_same<typename E::element_type, T>::value,
+	              "Expression element type must match the tensor");
+
+	const E& e = expr.self();
+	if (shape != e.shape()) {
+		*this = BasicTensor(e.shape());
+	}
+
+	Span<T> out = getData();
+	T* outData = out.data();
+	size_t n = out.size();
+	/* Element i only reads index i of each operand, so operands may alias the output */
+#pragma GCC ivdep
+	for (size_t i = 0; i < n; i++) {
+		outData[i] = static_cast<T>(e[i]);
+	}
+	return *this;
+}
+
+#endif
\ No newline at end of file
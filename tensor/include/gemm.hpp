@@ -0,0 +1,125 @@
+/* gemm.hpp */
+
+#ifndef GEMM_HPP
+#define GEMM_HPP
+
+#include "dtype.hpp"
+#include <cstddef>
+
+/**
+ * Implementations a product can run on
+ *
+ * Auto: The CBLAS library for products of at least blasThreshold()
+ *       multiply-adds, the built-in kernel below that (by default the
+ *       threshold is never reached)
+ * Builtin: Always the built-in kernel
+ * Blas: Always the CBLAS library
+ */
+enum class GemmBackend {
+	Auto,
+	Builtin,
+	Blas
+};
+
+/**
+ * Check whether the build links a CBLAS library (make BLAS=<library>)
+ *
+ * Output: True if double and float products can go to CBLAS
+ */
+bool hasBlas();
+
+/**
+ * Choose how products are dispatched (not thread-safe)
+ *
+ * Without CBLAS every product runs on the built-in kernel regardless.
+ *
+ * backend: Dispatch mode
+ * Output: False if Blas was requested but no library is linked
+ */
+bool setGemmBackend(GemmBackend backend);
+
+/**
+ * Get the current dispatch mode
+ *
+ * Output: Dispatch mode (Auto by default)
+ */
+GemmBackend gemmBackend();
+
+/**
+ * Set the size from which Auto dispatch calls CBLAS (not thread-safe)
+ *
+ * The default is SIZE_MAX, so Auto stays on the built-in kernel until a
+ * cut-off measured with make bench is set here.
+ *
+ * flops: Smallest M * N * K sent to the library
+ */
+void setBlasThreshold(size_t flops);
+
+/**
+ * Get the size from which Auto dispatch calls CBLAS
+ *
+ * Output: Smallest M * N * K sent to the library
+ */
+size_t blasThreshold();
+
+/**
+ * General matrix multiplication: C = alpha * A * B + beta * C
+ *
+ * Operands are described by a base pointer plus a row stride and a column
+ * stride, so element (i, j) of A lives at A[i * rsA + j * csA]. A row-major
+ * matrix uses (ld, 1); its transpose is the same buffer with (1, ld).
+ *
+ * The product is computed by packing A into MC x KC row panels and B into
+ * KC x NC column panels sized for the L2/L1 caches, and running a register-
+ * tiled MR x NR micro-kernel over the packed panels. The micro-kernel and
+ * its tile shape follow the instruction set selected by simd::activeIsa().
+ * Tiny products skip the packing and use a direct loop.
+ *
+ * Large products split their MC-row blocks (and, when there are fewer
+ * blocks than threads, column panels) across the parallel:: worker pool;
+ * smaller ones stay on the calling thread to avoid wake-up overhead.
+ *
+ * Instantiated for double, float and bfloat16; bfloat16 operands are
+ * widened to float while packing and accumulate in float. In builds with
+ * CBLAS, large double and float products go to the library instead when
+ * their strides fit its layout (see GemmBackend); bfloat16 never does.
+ *
+ * M: Rows of A and C
+ * N: Columns of B and C
+ * K: Columns of A and rows of B
+ * alpha: Scale applied to A * B
+ * A, rsA, csA: Left operand (M x K) and its strides
+ * B, rsB, csB: Right operand (K x N) and its strides
+ * beta: Scale applied to C before accumulation (C is not read when zero)
+ * C, rsC, csC: Output (M x N) and its strides
+ */
+template <typename T>
+void gemm(size_t M, size_t N, size_t K,
+          typename ComputeType<T>::type alpha,
+          const T* A, size_t rsA, size_t csA,
+          const T* B, size_t rsB, size_t csB,
+          typename ComputeType<T>::type beta,
+          T* C, size_t rsC, size_t csC);
+
+/**
+ * A batch of independent products C[i] = alpha * A[i] * B[i] + beta * C[i]
+ *
+ * Every product shares the shape and strides; only the base pointers
+ * differ, and A[i] or B[i] may repeat to broadcast one operand. Products
+ * too small to be parallelized on their own are spread over the worker
+ * pool one whole product per task; larger ones run one after another,
+ * each split across the pool by gemm. The C[i] must not overlap.
+ *
+ * batch: Number of products
+ * A, B, C: Arrays of batch base pointers
+ * (remaining parameters as for gemm)
+ */
+template <typename T>
+void gemmBatched(size_t batch, size_t M, size_t N, size_t K,
+                 typename ComputeType<T>::type alpha,
+                 const T* const* A, size_t rsA, size_t csA,
+                 const T* const* B, size_t rsB, size_t csB,
+                 typename ComputeType<T>::type beta,
+                 T* const* C, size_t rsC, size_t csC);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+/* mapped.hpp */
+
+#ifndef MAPPED_HPP
+#define MAPPED_HPP
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+
+/**
+ * Exception thrown when a file cannot be opened, mapped or is too short
+ */
+class TensorFileError : public std::exception {
+public:
+	const char* what() const noexcept override {
+		return "Tensor file could not be mapped.";
+	}
+};
+
+/**
+ * Exception thrown when a tensor over read-only mapped pages is written in place
+ */
+class ReadOnlyTensorError : public TensorFileError {
+public:
+	const char* what() const noexcept override {
+		return "Tensor is mapped read-only and cannot be written in place.";
+	}
+};
+
+/**
+ * How the pages of a mapped tensor may be written
+ *
+ * ReadOnly: Shared read-only pages; processes mapping the same file share
+ *           physical memory, and writing to the tensor in place throws
+ *           ReadOnlyTensorError
+ * CopyOnWrite: Private writable pages; a written page is copied on first
+ *              write and the file itself never changes
+ */
+enum class MapMode {
+	ReadOnly,
+	CopyOnWrite
+};
+
+/**
+ * A region of a file mapped into memory, unmapped on destruction
+ *
+ * Pages are loaded from the file on first touch, so mapping is O(1) in the
+ * size of the region.
+ */
+class MappedFile {
+private:
+	void* base;
+	size_t length;
+	char* region;
+	size_t bytes;
+	bool canWrite;
+
+	MappedFile(void* base, size_t length, char* region, size_t bytes, bool canWrite);
+
+public:
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * Map bytes bytes of a file starting at offset
+	 *
+	 * path: File to map
+	 * offset: Byte offset of the region (any value; page alignment is handled)
+	 * bytes: Length of the region
+	 * mode: Read-only or copy-on-write pages
+	 * Output: Shared handle to the mapping (throws TensorFileError)
+	 */
+	static std::shared_ptr<MappedFile> open(const std::string& path, size_t offset, size_t bytes, MapMode mode);
+
+	/**
+	 * Get the first byte of the requested region
+	 *
+	 * Output: Pointer to the region
+	 */
+	char* data() const { return region; }
+
+	/**
+	 * Get the length of the requested region
+	 *
+	 * Output: Bytes in the region
+	 */
+	size_t size() const { return bytes; }
+
+	/**
+	 * Check whether the pages may be written
+	 *
+	 * Output: True for copy-on-write mappings
+	 */
+	bool writable() const { return canWrite; }
+};
+
+#endif
\ No newline at end of file
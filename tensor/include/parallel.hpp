@@ -0,0 +1,59 @@
+/* parallel.hpp */
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <cstddef>
+
+/**
+ * Persistent worker pool for data-parallel kernels
+ *
+ * Workers are started on first use and sleep between jobs, so a parallel
+ * region costs a wake-up rather than thread creation. The thread count
+ * comes from setNumThreads(), else the CNN_NUM_THREADS environment
+ * variable, else the number of hardware threads. Parallel regions started
+ * from inside a worker, or while another thread owns the pool, run
+ * serially on the calling thread.
+ */
+namespace parallel {
+
+/**
+ * Set the number of threads used by parallel regions (not thread-safe)
+ *
+ * n: Thread count including the caller; 0 restores the default
+ */
+void setNumThreads(size_t n);
+
+/**
+ * Get the number of threads used by parallel regions
+ *
+ * Output: Thread count including the caller
+ */
+size_t getNumThreads();
+
+/**
+ * Run fn(ctx, i) for every i in [0, tasks) across the pool
+ *
+ * Returns once every task has finished. The caller runs tasks too.
+ *
+ * tasks: Number of tasks
+ * fn: Task body
+ * ctx: Opaque pointer passed to fn
+ */
+void run(size_t tasks, void (*fn)(void* ctx, size_t task), void* ctx);
+
+/**
+ * Run body(i) for every i in [0, tasks) across the pool
+ *
+ * tasks: Number of tasks
+ * body: Callable taking the task index
+ */
+template <typename Body>
+void parallelFor(size_t tasks, const Body& body) {
+	run(tasks, [](void* ctx, size_t task) { (*static_cast<const Body*>(ctx))(task); },
+	    const_cast<void*>(static_cast<const void*>(&body)));
+}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,238 @@
+/* pool.hpp */
+
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Size-bucketed memory pool backing tensor storage
+ *
+ * Requests are rounded up to one of a set of size classes (four per power
+ * of two, 64 bytes to 64 MiB). Freed blocks go to a small per-thread cache
+ * first and overflow into central free lists shared by all threads, so a
+ * training loop that keeps allocating the same shapes stops reaching the
+ * system allocator after its first iteration. Larger requests bypass the
+ * pool.
+ *
+ * While a StepArena::Scope is active on a thread, tensor storage created
+ * on that thread is bump-allocated from the arena instead and the whole
+ * arena is rewound when the scope ends.
+ *
+ * Every block starts on a 64-byte cache line. Blocks of 2 MiB or more
+ * start on a huge page boundary and, on Linux, are advised for
+ * transparent huge pages (MADV_HUGEPAGE) to cut TLB misses on large
+ * weights. Setting CNN_HUGEPAGES=0 or calling setHugePages(false) skips
+ * the advice.
+ */
+namespace pool {
+
+/**
+ * Allocation statistics accumulated since the last resetStats()
+ *
+ * liveBytes: Bytes in blocks handed out and not yet released
+ * peakBytes: Largest value liveBytes has reached
+ * cachedBytes: Bytes in free blocks kept for reuse
+ * requests: Number of allocation requests
+ * hits: Requests served without calling the system allocator
+ */
+struct PoolStats {
+	size_t liveBytes;
+	size_t peakBytes;
+	size_t cachedBytes;
+	size_t requests;
+	size_t hits;
+
+	/**
+	 * Get the number of requests that reached the system allocator
+	 *
+	 * Output: requests - hits
+	 */
+	size_t systemAllocations() const { return requests - hits; }
+
+	/**
+	 * Get the fraction of requests served from the pool
+	 *
+	 * Output: hits / requests, or 1 when there were no requests
+	 */
+	double hitRate() const { return requests == 0 ? 1.0 : static_cast<double>(hits) / requests; }
+};
+
+/**
+ * A block obtained from acquire()
+ *
+ * ptr: First byte of the block (nullptr for empty requests)
+ * bytes: Requested size
+ * chunk: Arena chunk the block lives in, or nullptr for pool blocks
+ */
+struct Block {
+	void* ptr;
+	size_t bytes;
+	void* chunk;
+};
+
+/**
+ * Allocate a block from the pool (never from a step arena)
+ *
+ * bytes: Requested size
+ * Output: Pointer to at least bytes bytes
+ */
+void* allocate(size_t bytes);
+
+/**
+ * Return a block obtained from allocate()
+ *
+ * ptr: Block to release (nullptr is ignored)
+ * bytes: Size passed to allocate()
+ */
+void deallocate(void* ptr, size_t bytes);
+
+/**
+ * Allocate tensor storage, from the active step arena if there is one
+ *
+ * bytes: Requested size
+ * Output: Block describing the allocation
+ */
+Block acquire(size_t bytes);
+
+/**
+ * Return a block obtained from acquire()
+ *
+ * block: Block to release
+ */
+void release(const Block& block);
+
+/**
+ * Get the current allocation statistics
+ *
+ * Output: Snapshot of the counters
+ */
+PoolStats stats();
+
+/**
+ * Zero the request counters and set the peak to the current live bytes
+ */
+void resetStats();
+
+/**
+ * Enable or disable the transparent huge page advice for large blocks
+ *
+ * Applies to blocks obtained from the system after the call.
+ *
+ * enabled: Whether to advise huge pages
+ */
+void setHugePages(bool enabled);
+
+/**
+ * Hand every cached free block back to the system allocator
+ *
+ * Releases this thread's cache and the central free lists.
+ */
+void trim();
+
+struct ArenaChunk;
+
+/**
+ * Bump allocator for tensors that only live for one training step
+ *
+ * Allocation is a pointer increment and freeing is a counter decrement.
+ * Rewinding never invalidates memory that is still in use: if blocks are
+ * alive when the arena is rewound, their chunk is retired and freed once
+ * the last of them is released, and the arena continues in a fresh chunk.
+ * Chunks grow to the largest step seen, so a steady loop settles on one.
+ */
+class StepArena {
+private:
+	ArenaChunk* current;
+	size_t chunkBytes;
+	size_t stepBytes;
+	size_t highWater;
+
+	void retireCurrent();
+
+public:
+	/**
+	 * Create an arena (no memory is reserved until first use)
+	 *
+	 * chunkBytes: Minimum size of each chunk
+	 */
+	explicit StepArena(size_t chunkBytes = size_t(1) << 22);
+
+	~StepArena();
+
+	StepArena(const StepArena&) = delete;
+	StepArena& operator=(const StepArena&) = delete;
+
+	/**
+	 * Bump-allocate a 64-byte aligned block
+	 *
+	 * bytes: Requested size
+	 * Output: Block describing the allocation
+	 */
+	Block allocate(size_t bytes);
+
+	/**
+	 * Rewind the arena so the next step reuses its memory
+	 */
+	void reset();
+
+	/**
+	 * Get the bytes handed out since the last reset
+	 *
+	 * Output: Bytes used in the current step
+	 */
+	size_t usedBytes() const { return stepBytes; }
+
+	/**
+	 * Route tensor allocations on this thread into an arena
+	 *
+	 * The arena is reset when the scope ends. Scopes nest; the previous
+	 * arena (or the pool) is restored on exit.
+	 */
+	class Scope {
+	private:
+		StepArena& arena;
+		StepArena* previous;
+
+	public:
+		explicit Scope(StepArena& arena);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+};
+
+/**
+ * Standard allocator drawing from the pool
+ *
+ * Used for the shared_ptr control blocks of tensor storage.
+ */
+template <typename U>
+struct PoolAllocator {
+	using value_type = U;
+
+	PoolAllocator() = default;
+
+	template <typename V>
+	PoolAllocator(const PoolAllocator<V>&) {}
+
+	U* allocate(size_t n) {
+		return static_cast<U*>(pool::allocate(n * sizeof(U)));
+	}
+
+	void deallocate(U* ptr, size_t n) {
+		pool::deallocate(ptr, n * sizeof(U));
+	}
+
+	template <typename V>
+	bool operator==(const PoolAllocator<V>&) const { return true; }
+
+	template <typename V>
+	bool operator!=(const PoolAllocator<V>&) const { return false; }
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,138 @@
+/* quant.hpp */
+
+#ifndef QUANT_HPP
+#define QUANT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 8-bit integer inference kernels
+ *
+ * Weights are quantized symmetrically to int8 with one scale per output
+ * channel, activations asymmetrically to uint8 with one scale and zero
+ * point per call. The product of the two runs on an integer GEMM
+ * accumulating in int32: AVX-512 VNNI (vpdpbusd) where the CPU has it,
+ * AVX2 pmaddubsw otherwise, and a scalar loop elsewhere. All three give
+ * bit-identical accumulators. Results are dequantized, biased and passed
+ * through an optional ReLU on each register tile as it leaves the GEMM.
+ */
+namespace quant {
+
+/**
+ * Scale and zero point mapping uint8 codes q to real values scale * (q - zeroPoint)
+ */
+struct QuantParams {
+	float scale;
+	int32_t zeroPoint;
+};
+
+/**
+ * Int8 weight matrix of a Dense layer, packed for the integer GEMM
+ *
+ * Rows (output channels) are grouped 16 at a time and columns 4 at a
+ * time, so one 64-byte load holds 4 consecutive inputs of 16 outputs -
+ * the operand layout of vpdpbusd. Row and column counts are padded with
+ * zeros to those multiples.
+ */
+class PackedWeights {
+private:
+	size_t rows;
+	size_t cols;
+	size_t paddedCols;
+	std::vector<int8_t> data;
+	std::vector<float> scales;
+	std::vector<int32_t> sums;
+
+public:
+	PackedWeights();
+
+	/**
+	 * Quantize and pack a row-major weight matrix
+	 *
+	 * Each row gets scale max|w| / 127, so codes span [-127, 127].
+	 *
+	 * weights: rows x cols matrix {outputSize, inputSize}
+	 * rows: Output channels
+	 * cols: Input features
+	 */
+	template <typename T>
+	PackedWeights(const T* weights, size_t rows, size_t cols);
+
+	size_t outputs() const { return rows; }
+	size_t inputs() const { return cols; }
+
+	/**
+	 * Get the stride activation rows must have (inputs rounded up to 4)
+	 *
+	 * Output: Padded input count
+	 */
+	size_t stride() const { return paddedCols; }
+
+	const int8_t* codes() const { return data.data(); }
+	const float* channelScales() const { return scales.data(); }
+	const int32_t* channelSums() const { return sums.data(); }
+
+	/**
+	 * Get the heap memory held by the packed weights
+	 *
+	 * Output: Bytes of codes, scales and channel sums
+	 */
+	size_t memoryBytes() const;
+};
+
+/**
+ * Quantize activations to uint8 codes covering [min(x, 0), max(x, 0)]
+ *
+ * x: rows x cols matrix with row stride cols
+ * rows: Number of rows
+ * cols: Number of columns
+ * out: rows x stride codes; columns from cols to stride are set to the zero point
+ * stride: Row stride of out (at least cols)
+ * Output: Scale and zero point of the codes
+ */
+template <typename T>
+QuantParams quantize(const T* x, size_t rows, size_t cols, uint8_t* out, size_t stride);
+
+/**
+ * Integer product with fused dequantization, bias and ReLU
+ *
+ * out[m][n] = act(sa * sw[n] * sum_k (a[m][k] - za) * w[n][k] + bias[n])
+ *
+ * Large products split their columns over the worker pool.
+ *
+ * M: Number of activation rows
+ * a: Activation codes, M rows with row stride weights.stride()
+ * params: Scale and zero point of a
+ * weights: Packed weight codes
+ * bias: One value per output channel (nullptr for none)
+ * relu: Clamp the outputs at zero
+ * out: M x weights.outputs() output with row stride weights.outputs()
+ */
+template <typename T>
+void gemm(size_t M, const uint8_t* a, QuantParams params, const PackedWeights& weights,
+          const T* bias, bool relu, T* out);
+
+/**
+ * Raw integer product: acc[m][n] = sum_k a[m][k] * w[n][k]
+ *
+ * Exposed so the instruction set kernels can be checked against each other.
+ *
+ * M: Number of activation rows
+ * a: Activation codes, M rows with row stride weights.stride()
+ * weights: Packed weight codes
+ * acc: M x weights.outputs() accumulators
+ */
+void gemmAccumulate(size_t M, const uint8_t* a, const PackedWeights& weights, int32_t* acc);
+
+/**
+ * Check whether the AVX-512 VNNI kernel is in use
+ *
+ * Output: True when the CPU has VNNI and simd::activeIsa() is AVX-512
+ */
+bool hasVnni();
+
+}
+
+#endif
\ No newline at end of file
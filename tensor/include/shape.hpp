@@ -0,0 +1,149 @@
+/* shape.hpp */
+
+#ifndef SHAPE_HPP
+#define SHAPE_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
+/**
+ * Small list of dimension sizes or strides
+ *
+ * Up to INLINE_DIMS entries are stored inside the object, so creating,
+ * copying and comparing the shape of an ordinary tensor never touches the
+ * heap. Longer lists spill to a heap buffer.
+ */
+class Shape {
+public:
+	static constexpr size_t INLINE_DIMS = 6;
+
+private:
+	size_t inlineDims[INLINE_DIMS];
+	size_t* dims;
+	size_t count;
+
+	void allocate(size_t n) {
+		count = n;
+		dims = (n <= INLINE_DIMS) ? inlineDims : new size_t[n];
+	}
+
+	void releaseHeap() {
+		if (dims != inlineDims) {
+			delete[] dims;
+		}
+	}
+
+public:
+	Shape() : dims(inlineDims), count(0) {}
+
+	Shape(std::initializer_list<size_t> values) {
+		allocate(values.size());
+		std::copy(values.begin(), values.end(), dims);
+	}
+
+	Shape(const std::vector<size_t>& values) {
+		allocate(values.size());
+		std::copy(values.begin(), values.end(), dims);
+	}
+
+	/**
+	 * Create a list of n copies of value
+	 *
+	 * n: Number of entries
+	 * value: Value of every entry
+	 */
+	explicit Shape(size_t n, size_t value) {
+		allocate(n);
+		std::fill(dims, dims + n, value);
+	}
+
+	Shape(const Shape& other) {
+		allocate(other.count);
+		std::copy(other.dims, other.dims + other.count, dims);
+	}
+
+	Shape& operator=(const Shape& other) {
+		if (this != &other) {
+			releaseHeap();
+			allocate(other.count);
+			std::copy(other.dims, other.dims + other.count, dims);
+		}
+		return *this;
+	}
+
+	Shape(Shape&& other) noexcept : count(other.count) {
+		if (other.dims == other.inlineDims) {
+			dims = inlineDims;
+			std::copy(other.dims, other.dims + count, dims);
+		} else {
+			dims = other.dims;
+			other.dims = other.inlineDims;
+			other.count = 0;
+		}
+	}
+
+	Shape& operator=(Shape&& other) noexcept {
+		if (this != &other) {
+			releaseHeap();
+			count = other.count;
+			if (other.dims == other.inlineDims) {
+				dims = inlineDims;
+				std::copy(other.dims, other.dims + count, dims);
+			} else {
+				dims = other.dims;
+				other.dims = other.inlineDims;
+				other.count = 0;
+			}
+		}
+		return *this;
+	}
+
+	~Shape() {
+		releaseHeap();
+	}
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	size_t& operator[](size_t i) { return dims[i]; }
+	size_t operator[](size_t i) const { return dims[i]; }
+	const size_t* data() const { return dims; }
+	size_t* begin() { return dims; }
+	size_t* end() { return dims + count; }
+	const size_t* begin() const { return dims; }
+	const size_t* end() const { return dims + count; }
+	size_t back() const { return dims[count - 1]; }
+
+	/**
+	 * Get the product of all entries (1 for an empty list)
+	 *
+	 * Output: Number of elements described by the shape
+	 */
+	size_t numel() const {
+		size_t total = 1;
+		for (size_t i = 0; i < count; i++) {
+			total *= dims[i];
+		}
+		return total;
+	}
+
+	/**
+	 * Copy the entries into a std::vector
+	 *
+	 * Output: Vector with the same entries
+	 */
+	std::vector<size_t> toVector() const {
+		return std::vector<size_t>(dims, dims + count);
+	}
+
+	bool operator==(const Shape& other) const {
+		return count == other.count && std::equal(dims, dims + count, other.dims);
+	}
+
+	bool operator!=(const Shape& other) const {
+		return !(*this == other);
+	}
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,176 @@
+/* simd.hpp */
+
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include "dtype.hpp"
+#include <cstddef>
+
+/**
+ * Vectorized element-wise kernels with runtime instruction set dispatch
+ *
+ * Every kernel has a portable scalar version plus SSE2, AVX2 and AVX-512
+ * versions on x86. The widest set supported by the running CPU is picked
+ * on first use, so one binary runs on every host. All pointers may be
+ * unaligned, and an output may alias any of its inputs.
+ *
+ * Kernels are instantiated for double, float and bfloat16. bfloat16 data
+ * is widened to float in small chunks, run through the float kernel and
+ * rounded back.
+ */
+namespace simd {
+
+/**
+ * Instruction sets with a dedicated kernel implementation
+ */
+enum class Isa {
+	Scalar,
+	SSE2,
+	AVX2,
+	AVX512
+};
+
+/**
+ * Detect the widest instruction set supported by this CPU
+ *
+ * Output: Best available instruction set
+ */
+Isa detectIsa();
+
+/**
+ * Get the instruction set the kernels currently dispatch to
+ *
+ * Output: Active instruction set
+ */
+Isa activeIsa();
+
+/**
+ * Force the kernels onto a given instruction set (not thread-safe)
+ *
+ * isa: Instruction set to use (must not exceed detectIsa())
+ * Output: True if the instruction set was selected, false if unsupported
+ */
+bool setIsa(Isa isa);
+
+/**
+ * Get a printable name for an instruction set
+ *
+ * isa: Instruction set
+ * Output: Name such as "avx2"
+ */
+const char* isaName(Isa isa);
+
+/**
+ * out[i] = a[i] + b[i]
+ */
+template <typename T>
+void add(const T* a, const T* b, T* out, size_t n);
+
+/**
+ * out[i] = a[i] - b[i]
+ */
+template <typename T>
+void sub(const T* a, const T* b, T* out, size_t n);
+
+/**
+ * out[i] = a[i] * b[i]
+ */
+template <typename T>
+void mul(const T* a, const T* b, T* out, size_t n);
+
+/**
+ * out[i] = a[i] / b[i]
+ */
+template <typename T>
+void div(const T* a, const T* b, T* out, size_t n);
+
+/**
+ * out[i] = a[i] * scalar
+ */
+template <typename T>
+void scale(const T* a, T scalar, T* out, size_t n);
+
+/**
+ * out[i] = value
+ */
+template <typename T>
+void fill(T* out, T value, size_t n);
+
+/**
+ * out[i] = max(a[i], b[i])
+ */
+template <typename T>
+void maximum(const T* a, const T* b, T* out, size_t n);
+
+/**
+ * Running maximum with its origin: where x[i] > best[i], best[i] = x[i] and index[i] = tag
+ *
+ * Ties and NaN keep the earlier best, so repeated calls find the first maximum.
+ */
+template <typename T>
+void maxUpdate(const T* x, T tag, T* best, T* index, size_t n);
+
+/**
+ * y[i] += alpha * x[i]
+ */
+template <typename T>
+void axpy(T alpha, const T* x, T* y, size_t n);
+
+/**
+ * y[i] = alpha * x[i] + beta * y[i]
+ */
+template <typename T>
+void axpby(T alpha, const T* x, T beta, T* y, size_t n);
+
+/**
+ * out[i] = max(x[i], 0)
+ */
+template <typename T>
+void relu(const T* x, T* out, size_t n);
+
+/**
+ * out[i] = x[i] > 0 ? grad[i] : 0
+ */
+template <typename T>
+void reluBackward(const T* x, const T* grad, T* out, size_t n);
+
+/**
+ * out[i] = grad[i] * s[i] * (1 - s[i]), where s is the sigmoid output
+ */
+template <typename T>
+void sigmoidBackward(const T* s, const T* grad, T* out, size_t n);
+
+/**
+ * out[i] = grad[i] * (1 - t[i] * t[i]), where t is the tanh output
+ */
+template <typename T>
+void tanhBackward(const T* t, const T* grad, T* out, size_t n);
+
+/**
+ * dst[j * ldDst + i] = src[i * ldSrc + j] for a rows x cols block of src
+ *
+ * The block is walked in cache-sized squares, each transposed in
+ * registers a vector-width tile at a time. dst must not overlap src.
+ */
+template <typename T>
+void transpose(const T* src, size_t rows, size_t cols, size_t ldSrc, T* dst, size_t ldDst);
+
+/**
+ * Sum of x[0..n)
+ *
+ * Blocks of a few hundred elements are summed with vector accumulators
+ * and the blocks are combined pairwise, so the rounding error grows with
+ * log(n) rather than n. bfloat16 input is summed in float.
+ */
+template <typename T>
+typename ComputeType<T>::type reduceSum(const T* x, size_t n);
+
+/**
+ * Largest element of x[0..n) (n must be at least 1)
+ */
+template <typename T>
+T reduceMax(const T* x, size_t n);
+
+}
+
+#endif
\ No newline at end of file
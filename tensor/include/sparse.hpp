@@ -0,0 +1,138 @@
+/* sparse.hpp */
+
+#ifndef SPARSE_HPP
+#define SPARSE_HPP
+
+#include "tensor.hpp"
+#include <cstddef>
+#include <vector>
+
+/**
+ * Two-dimensional sparse matrix in compressed sparse row (CSR) form
+ *
+ * Row i holds the entries colIndex[rowPtr[i] .. rowPtr[i + 1]) with values
+ * at the same positions; columns are sorted and unique within a row. The
+ * products below cost O(nnz) per output column instead of O(rows * cols),
+ * which is what makes bag-of-features inputs cheap to feed into Dense.
+ *
+ * T: Element type of the stored values (double, float or bfloat16)
+ */
+template <typename T>
+class BasicSparseTensor {
+private:
+	size_t numRows;
+	size_t numCols;
+	std::vector<size_t> rowPtr;
+	std::vector<size_t> colIndex;
+	std::vector<T> values;
+
+public:
+	/**
+	 * Create an empty (all-zero) sparse matrix
+	 *
+	 * rows: Number of rows
+	 * cols: Number of columns
+	 */
+	BasicSparseTensor(size_t rows = 0, size_t cols = 0);
+
+	/**
+	 * Create a sparse matrix from CSR arrays
+	 *
+	 * rows: Number of rows
+	 * cols: Number of columns
+	 * rowPtr: rows + 1 non-decreasing offsets into colIndex and values
+	 * colIndex: Column of each entry, sorted and unique within a row
+	 * values: Value of each entry
+	 */
+	BasicSparseTensor(size_t rows, size_t cols, std::vector<size_t> rowPtr,
+	                  std::vector<size_t> colIndex, std::vector<T> values);
+
+	/**
+	 * Create a sparse matrix from coordinate (COO) triplets
+	 *
+	 * Triplets may come in any order; duplicates are summed.
+	 *
+	 * rows: Number of rows
+	 * cols: Number of columns
+	 * rowIndex: Row of each triplet
+	 * colIndex: Column of each triplet
+	 * values: Value of each triplet
+	 * Output: CSR matrix holding the triplets
+	 */
+	static BasicSparseTensor fromCoo(size_t rows, size_t cols, const std::vector<size_t>& rowIndex,
+	                                 const std::vector<size_t>& colIndex, const std::vector<T>& values);
+
+	/**
+	 * Keep the non-zero elements of a dense matrix
+	 *
+	 * dense: Two-dimensional tensor
+	 * Output: CSR matrix with one entry per non-zero element
+	 */
+	static BasicSparseTensor fromDense(const BasicTensor<T>& dense);
+
+	/**
+	 * Expand to a dense matrix
+	 *
+	 * Output: Tensor of shape {rows, cols}
+	 */
+	BasicTensor<T> toDense() const;
+
+	size_t rows() const { return numRows; }
+	size_t cols() const { return numCols; }
+	size_t nnz() const { return values.size(); }
+	const std::vector<size_t>& getRowPtr() const { return rowPtr; }
+	const std::vector<size_t>& getColIndex() const { return colIndex; }
+	const std::vector<T>& getValues() const { return values; }
+
+	/**
+	 * Sparse-dense product: out = alpha * a * op(b) + beta * out
+	 *
+	 * With transB, b is {n, cols} and each output element is a gathered
+	 * dot product over the entries of one row of a - the layout of a Dense
+	 * weight matrix. Without it, b is {cols, n} and each entry adds a
+	 * scaled row of b. Rows of a are spread over the worker pool.
+	 *
+	 * out: Output of shape {rows, n}
+	 * a: Sparse left operand
+	 * b: Dense right operand
+	 * alpha: Scale of the product
+	 * beta: Scale of the existing output (0 overwrites it)
+	 * transB: Use b transposed
+	 */
+	static void matmul(BasicTensor<T>& out, const BasicSparseTensor& a, const BasicTensor<T>& b,
+	                   T alpha = T(1), T beta = T(0), bool transB = false);
+
+	/**
+	 * Dense-transposed times sparse: out = dense^T * a
+	 *
+	 * Only the columns of out that a touches are computed; every other
+	 * column is zero. This is the weight gradient of a Dense layer fed a
+	 * sparse input, so its cost follows nnz rather than the input width.
+	 *
+	 * out: Output of shape {dense.cols, a.cols}
+	 * dense: Dense left operand of shape {a.rows, m}
+	 * a: Sparse right operand
+	 */
+	static void transposeMatmul(BasicTensor<T>& out, const BasicTensor<T>& dense, const BasicSparseTensor& a);
+
+	/**
+	 * Sampled product: x * y evaluated only where a has entries
+	 *
+	 * out: Tensor of shape {rows, cols}, zero outside the entries of a
+	 * a: Sparsity pattern (values ignored)
+	 * x: Dense tensor of shape {rows, m}
+	 * y: Dense tensor of shape {m, cols}
+	 */
+	static void sampledMatmul(BasicTensor<T>& out, const BasicSparseTensor& a,
+	                          const BasicTensor<T>& x, const BasicTensor<T>& y);
+};
+
+extern template class BasicSparseTensor<double>;
+extern template class BasicSparseTensor<float>;
+extern template class BasicSparseTensor<bfloat16>;
+
+using SparseTensor = BasicSparseTensor<double>;
+using SparseTensorF = BasicSparseTensor<float>;
+using SparseTensorBF16 = BasicSparseTensor<bfloat16>;
+
+#endif
\ No newline at end of file
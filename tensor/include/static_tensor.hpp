@@ -0,0 +1,137 @@
+/* static_tensor.hpp */
+
+#ifndef STATIC_TENSOR_HPP
+#define STATIC_TENSOR_HPP
+
+#include "tensor.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * Tensor whose shape is fixed at compile time
+ *
+ * The elements live inside the object (no heap, no shared storage), and
+ * the shape, size and strides are constants, so loops over a StaticTensor
+ * have known trip counts the compiler can unroll and vectorize. Indexing
+ * is unchecked apart from debug assertions. Conversions to and from
+ * BasicTensor copy the elements.
+ *
+ *   StaticTensor<float, 28, 28> image;
+ *   image(3, 4) = 1.0f;
+ *   TensorF dynamic = image.toTensor();
+ *
+ * T: Element type
+ * Dims: Size of each dimension (at least one, all non-zero)
+ */
+template <typename T, size_t... Dims>
+class StaticTensor {
+	static_assert(sizeof...(Dims) > 0, "StaticTensor needs at least one dimension");
+	static_assert(((Dims > 0) && ...), "StaticTensor dimensions must be non-zero");
+
+public:
+	using value_type = T;
+
+	static constexpr size_t rank = sizeof...(Dims);
+	static constexpr size_t count = (Dims * ...);
+	static constexpr std::array<size_t, rank> dims = {Dims...};
+
+private:
+	alignas(64) T values[count];
+
+public:
+	/**
+	 * Create a zero-filled tensor
+	 */
+	StaticTensor() : values{} {}
+
+	/**
+	 * Create a tensor with every element set to value
+	 *
+	 * value: Fill value
+	 */
+	explicit StaticTensor(T value) {
+		fill(value);
+	}
+
+	static constexpr size_t size() { return count; }
+	static constexpr size_t ndim() { return rank; }
+
+	/**
+	 * Get the shape in the form dynamic tensors use
+	 *
+	 * Output: Shape {Dims...}
+	 */
+	static Shape getShape() { return Shape{Dims...}; }
+
+	/**
+	 * Get the row-major offset of an element
+	 *
+	 * indices: One index per dimension
+	 * Output: Offset into data()
+	 */
+	template <typename... Idx>
+	static constexpr size_t offset(Idx... indices) {
+		static_assert(sizeof...(Idx) == rank, "StaticTensor index needs one value per dimension");
+		const size_t index[] = {static_cast<size_t>(indices)...};
+		size_t result = 0;
+		for (size_t d = 0; d < rank; d++) {
+			assert(index[d] < dims[d]);
+			result = result * dims[d] + index[d];
+		}
+		return result;
+	}
+
+	template <typename... Idx>
+	T& operator()(Idx... indices) { return values[offset(indices...)]; }
+
+	template <typename... Idx>
+	const T& operator()(Idx... indices) const { return values[offset(indices...)]; }
+
+	T& operator[](size_t i) { return values[i]; }
+	const T& operator[](size_t i) const { return values[i]; }
+
+	T* data() { return values; }
+	const T* data() const { return values; }
+
+	/**
+	 * Set every element to value
+	 *
+	 * value: Fill value
+	 */
+	void fill(T value) {
+		std::fill(values, values + count, value);
+	}
+
+	/**
+	 * Copy into a dynamic tensor
+	 *
+	 * Output: Tensor of shape {Dims...}
+	 */
+	BasicTensor<T> toTensor() const {
+		BasicTensor<T> result(getShape());
+		std::copy(values, values + count, result.getData().data());
+		return result;
+	}
+
+	/**
+	 * Copy from a dynamic tensor of the same shape
+	 *
+	 * tensor: Tensor of shape {Dims...} (views are compacted first)
+	 * Output: Static copy of the elements
+	 */
+	static StaticTensor fromTensor(const BasicTensor<T>& tensor) {
+		if (tensor.getShape() != getShape()) {
+			throw TensorDismatchError();
+		}
+		StaticTensor result;
+		Span<const T> tensorValues = tensor.getData();
+		const T* src = tensorValues.data();
+		std::copy(src, src + count, result.values);
+		return result;
+	}
+};
+
+#endif
\ No newline at end of file
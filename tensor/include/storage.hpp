@@ -0,0 +1,125 @@
+/* storage.hpp */
+
+#ifndef STORAGE_HPP
+#define STORAGE_HPP
+
+#include "pool.hpp"
+#include "mapped.hpp"
+#include <cstddef>
+#include <memory>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Flat element buffer owned by one or more tensors
+ *
+ * Tensors hold a Storage through a shared pointer, so views produced by
+ * reshape, transpose or slice reuse the same buffer and it is freed once
+ * the last of them goes away. Memory comes from the tensor pool (or the
+ * active step arena) and is zero-filled, or from a mapped file region.
+ *
+ * T: Element type (trivially copyable, all-zero bits must mean zero)
+ */
+template <typename T>
+class Storage {
+private:
+	static_assert(std::is_trivially_copyable<T>::value, "Storage elements must be trivially copyable");
+
+	pool::Block block;
+	T* ptr;
+	size_t count;
+	std::shared_ptr<MappedFile> mapping;
+
+public:
+	/**
+	 * Allocate a zero-initialized buffer
+	 *
+	 * count: Number of elements
+	 */
+	explicit Storage(size_t count)
+		: block(pool::acquire(count * sizeof(T))), ptr(static_cast<T*>(block.ptr)), count(count) {
+		if (count > 0) {
+			std::memset(static_cast<void*>(ptr), 0, count * sizeof(T));
+		}
+	}
+
+	/**
+	 * Wrap a mapped file region without copying it
+	 *
+	 * mapping: Region holding the elements (kept alive by the storage)
+	 */
+	explicit Storage(std::shared_ptr<MappedFile> mapping)
+		: block{nullptr, 0, nullptr}, ptr(reinterpret_cast<T*>(mapping->data())),
+		  count(mapping->size() / sizeof(T)), mapping(std::move(mapping)) {}
+
+	~Storage() {
+		pool::release(block);
+	}
+
+	Storage(const Storage&) = delete;
+	Storage& operator=(const Storage&) = delete;
+
+	/**
+	 * Get the first element of the buffer
+	 *
+	 * Output: Pointer to the buffer
+	 */
+	T* data() const { return ptr; }
+
+	/**
+	 * Get the number of elements in the buffer
+	 *
+	 * Output: Element count
+	 */
+	size_t size() const { return count; }
+
+	/**
+	 * Check whether the elements may be written in place
+	 *
+	 * Output: False only for read-only file mappings
+	 */
+	bool writable() const { return mapping == nullptr || mapping->writable(); }
+};
+
+/**
+ * Non-owning window over a contiguous run of elements
+ *
+ * Returned by BasicTensor::getData. Stays valid while the tensor it came
+ * from is alive and not reassigned. A read-only span over a non-contiguous
+ * view instead owns a compact copy and stays valid while any copy of the
+ * span does.
+ *
+ * T: Element type (const-qualified for read-only access)
+ * owner: Buffer kept alive by the span (null when it only borrows)
+ */
+template <typename T>
+class Span {
+private:
+	T* ptr;
+	size_t count;
+	std::shared_ptr<const void> owner;
+
+public:
+	Span(T* ptr, size_t count, std::shared_ptr<const void> owner = nullptr)
+		: ptr(ptr), count(count), owner(std::move(owner)) {}
+
+	T* data() const { return ptr; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	T& operator[](size_t i) const { return ptr[i]; }
+	T* begin() const { return ptr; }
+	T* end() const { return ptr + count; }
+};
+
+/**
+ * Create a shared Storage whose control block also comes from the pool
+ *
+ * count: Number of elements
+ * Output: Shared pointer to the new storage
+ */
+template <typename T>
+std::shared_ptr<Storage<T>> makeStorage(size_t count) {
+	return std::allocate_shared<Storage<T>>(pool::PoolAllocator<Storage<T>>(), count);
+}
+
+#endif
\ No newline at end of file
@@ -3,8 +3,14 @@
 #ifndef TENSOR_HPP
 #define TENSOR_HPP
 
+#include "dtype.hpp"
+#include "storage.hpp"
+#include "shape.hpp"
 #include <vector>
+#include <memory>
+#include <string>
 #include <exception>
+#include <type_traits>
 
 /**
  * Exception thrown when tensor dimensions do not match for an operation
@@ -26,24 +32,109 @@ public:
 	}
 };
 
+template <typename E>
+class TensorExpr;
+
 /**
  * Multi-dimensional array (tensor) for numerical computations
  *
+ * A tensor is a strided view into a reference-counted Storage. reshape,
+ * flatten, transpose and slice return views that share the buffer in O(1);
+ * copying a tensor always produces an independent, contiguous buffer.
+ *
+ * T: Element type (double, float or bfloat16)
  * shape: Vector containing the size of each dimension
- * data: Flattened array storing all elements in row-major order
+ * strides: Distance in elements between neighbours along each dimension
+ * offset: Position of the first element inside the storage
+ * storage: Shared element buffer
  */
-class Tensor {
+template <typename T>
+class BasicTensor {
 private:
-	std::vector<size_t> shape;
-	std::vector<double> data;
+	Shape shape;
+	Shape strides;
+	size_t offset;
+	std::shared_ptr<Storage<T>> storage;
 
 	/**
-	 * Compute flat index from multi-dimensional indices
+	 * Compute storage index from multi-dimensional indices
 	 *
 	 * indices: Vector of indices for each dimension
-	 * Output: Flat index in the data array
+	 * Output: Index into the storage buffer
+	 */
+	size_t computeIndex(const Shape& indices) const;
+
+	/**
+	 * Compute storage index from one index per dimension
+	 *
+	 * Rank and bounds are only checked in debug builds (without NDEBUG).
+	 *
+	 * indices: One integral index per dimension
+	 * Output: Index into the storage buffer
+	 */
+	template <typename... Idx>
+	size_t elementIndex(Idx... indices) const {
+		const size_t idx[] = {static_cast<size_t>(indices)...};
+#ifndef NDEBUG
+		if (sizeof...(Idx) != shape.size()) {
+			throw TensorDismatchError();
+		}
+		for (size_t k = 0; k < sizeof...(Idx); k++) {
+			if (idx[k] >= shape[k]) {
+				throw IndexOutOfBoundsError();
+			}
+		}
+#endif
+		size_t index = offset;
+		for (size_t k = 0; k < sizeof...(Idx); k++) {
+			index += idx[k] * strides[k];
+		}
+		return index;
+	}
+
+	/**
+	 * Check that the elements may be written in place
+	 *
+	 * Throws ReadOnlyTensorError for a read-only file mapping.
+	 */
+	void requireWritable() const {
+		if (!storage->writable()) {
+			throw ReadOnlyTensorError();
+		}
+	}
+
+	/**
+	 * Replace a non-contiguous view by a compact row-major copy of itself
+	 *
+	 * Does nothing when the view is already contiguous.
+	 */
+	void materialize();
+
+	/**
+	 * Apply an element-wise kernel to equally shaped a and b, writing into out
+	 *
+	 * kernel: Callable (const T* a, const T* b, T* out, size_t n)
+	 */
+	template <typename Kernel>
+	static void binaryOp(BasicTensor& out, const BasicTensor& a, const BasicTensor& b, Kernel kernel);
+
+	/**
+	 * Apply an element-wise operation to a and b broadcast against each other
+	 *
+	 * Broadcast dimensions are walked with stride 0. Runs where every
+	 * operand is contiguous go to kernel, others to Op::apply.
+	 *
+	 * Op: Operation with a static apply(a, b)
+	 * kernel: Callable (const T* a, const T* b, T* out, size_t n)
+	 */
+	template <typename Op, typename Kernel>
+	static void broadcastOp(BasicTensor& out, const BasicTensor& a, const BasicTensor& b, Kernel kernel);
+
+	/**
+	 * Create a view onto existing storage
 	 */
-	size_t computeIndex(const std::vector<size_t>& indices) const;
+	BasicTensor(const Shape& shape, const Shape& strides,
+	            size_t offset, std::shared_ptr<Storage<T>> storage);
 
 public:
 	/**
@@ -51,7 +142,7 @@ public:
 	 *
 	 * shape: Vector containing size of each dimension
 	 */
-	Tensor(const std::vector<size_t>& shape);
+	BasicTensor(const Shape& shape);
 
 	/**
 	 * Create a tensor with given shape and initial values
@@ -59,7 +150,7 @@ public:
 	 * shape: Vector containing size of each dimension
 	 * values: Initial values in row-major order
 	 */
-	Tensor(const std::vector<size_t>& shape, const std::vector<double>& values);
+	BasicTensor(const Shape& shape, const std::vector<T>& values);
 
 	/**
 	 * Create a tensor with given shape, filled with a specific value
@@ -67,16 +158,57 @@ public:
 	 * shape: Vector containing size of each dimension
 	 * fillValue: Value to fill all elements
 	 */
-	Tensor(const std::vector<size_t>& shape, double fillValue);
+	BasicTensor(const Shape& shape, T fillValue);
+
+	/**
+	 * Deep copy: the new tensor owns a contiguous copy of other's elements
+	 *
+	 * other: Tensor or view to copy
+	 */
+	BasicTensor(const BasicTensor& other);
+	BasicTensor(BasicTensor&& other) = default;
+	BasicTensor& operator=(const BasicTensor& other);
+	BasicTensor& operator=(BasicTensor&& other) = default;
+
+	/**
+	 * Evaluate a lazy expression into a new tensor (see expr.hpp)
+	 *
+	 * expr: Expression to evaluate
+	 */
+	template <typename E>
+	BasicTensor(const TensorExpr<E>& expr);
 
-	Tensor(const Tensor& other) = default;
+	/**
+	 * Evaluate a lazy expression into this tensor (see expr.hpp)
+	 *
+	 * Writes into the existing buffer when the shape matches.
+	 *
+	 * expr: Expression to evaluate (may read from this tensor)
+	 * Output: Reference to this tensor
+	 */
+	template <typename E>
+	BasicTensor& operator=(const TensorExpr<E>& expr);
 
 	/**
 	 * Get the shape of the tensor
 	 *
 	 * Output: Reference to shape vector
 	 */
-	const std::vector<size_t>& getShape() const;
+	const Shape& getShape() const;
+
+	/**
+	 * Get the strides of the tensor in elements
+	 *
+	 * Output: Reference to strides vector
+	 */
+	const Shape& getStrides() const;
+
+	/**
+	 * Check whether the elements are laid out densely in row-major order
+	 *
+	 * Output: True if the tensor is contiguous
+	 */
+	bool isContiguous() const;
 
 	/**
 	 * Get the number of dimensions
@@ -95,32 +227,75 @@ public:
 	/**
 	 * Get element value at given indices (read-only)
 	 *
-	 * indices: Vector of indices for each dimension
+	 * Always checks rank and bounds.
+	 *
+	 * indices: List of indices for each dimension
 	 * Output: Value at the specified position
 	 */
-	double get(const std::vector<size_t>& indices) const;
+	T get(const Shape& indices) const;
 
 	/**
 	 * Get reference to element at given indices (read-write)
 	 *
-	 * indices: Vector of indices for each dimension
+	 * Always checks rank and bounds. Throws ReadOnlyTensorError on a
+	 * read-only mapping.
+	 *
+	 * indices: List of indices for each dimension
+	 * Output: Reference to value at the specified position
+	 */
+	T& at(const Shape& indices);
+
+	/**
+	 * Get element value, one index argument per dimension: get(i, j)
+	 *
+	 * Rank and bounds are only checked in debug builds.
+	 *
+	 * indices: One integral index per dimension
+	 * Output: Value at the specified position
+	 */
+	template <typename... Idx,
+	          typename = std::enable_if_t<(sizeof...(Idx) > 0) && (std::is_integral<Idx>::value && ...)>>
+	T get(Idx... indices) const {
+		return storage->data()[elementIndex(indices...)];
+	}
+
+	/**
+	 * Get reference to element, one index argument per dimension: at(i, j)
+	 *
+	 * Rank and bounds are only checked in debug builds. Throws
+	 * ReadOnlyTensorError on a read-only mapping.
+	 *
+	 * indices: One integral index per dimension
 	 * Output: Reference to value at the specified position
 	 */
-	double& at(const std::vector<size_t>& indices);
+	template <typename... Idx,
+	          typename = std::enable_if_t<(sizeof...(Idx) > 0) && (std::is_integral<Idx>::value && ...)>>
+	T& at(Idx... indices) {
+		requireWritable();
+		return storage->data()[elementIndex(indices...)];
+	}
 
 	/**
-	 * Get read-only access to underlying data array
+	 * Get read-only access to the elements in row-major order
+	 *
+	 * A non-contiguous view is left untouched: the span owns a compact copy
+	 * of its elements instead.
 	 *
-	 * Output: Const reference to data vector
+	 * Output: Span over size() elements
 	 */
-	const std::vector<double>& getData() const;
+	Span<const T> getData() const;
 
 	/**
-	 * Get read-write access to underlying data array
+	 * Get read-write access to the elements in row-major order
 	 *
-	 * Output: Reference to data vector
+	 * Writes through a contiguous view are visible to every tensor sharing
+	 * its storage. A non-contiguous view is compacted into its own storage
+	 * first, which detaches it from the original. A contiguous read-only
+	 * mapping throws ReadOnlyTensorError; read it through getData() const.
+	 *
+	 * Output: Span over size() elements
 	 */
-	std::vector<double>& getData();
+	Span<T> getData();
 
 	/**
 	 * Create a tensor filled with zeros
@@ -128,7 +303,7 @@ public:
 	 * shape: Vector containing size of each dimension
 	 * Output: New tensor filled with zeros
 	 */
-	static Tensor zeros(const std::vector<size_t>& shape);
+	static BasicTensor zeros(const Shape& shape);
 
 	/**
 	 * Create a tensor filled with ones
@@ -136,46 +311,123 @@ public:
 	 * shape: Vector containing size of each dimension
 	 * Output: New tensor filled with ones
 	 */
-	static Tensor ones(const std::vector<size_t>& shape);
+	static BasicTensor ones(const Shape& shape);
 
 	/**
 	 * Create a tensor filled with random values [0, 1)
 	 *
+	 * Drawn from rng::defaultGenerator(), so reproducible across runs.
+	 *
 	 * shape: Vector containing size of each dimension
 	 * Output: New tensor with random values
 	 */
-	static Tensor random(const std::vector<size_t>& shape);
+	static BasicTensor random(const Shape& shape);
+
+	/**
+	 * Create a zero tensor whose rows start on 64-byte cache lines
+	 *
+	 * The last dimension is padded up to a whole number of cache lines, so
+	 * every row begins on a line boundary and SIMD loads never straddle
+	 * two lines. The padding is hidden behind the strides: matmul, bmm,
+	 * fill and the broadcasting ops read and write such a tensor in place,
+	 * while getData() compacts it like any non-contiguous view.
+	 *
+	 * shape: Vector containing size of each dimension
+	 * Output: New zero tensor with padded row stride
+	 */
+	static BasicTensor padded(const Shape& shape);
+
+	/**
+	 * Create a tensor backed by a memory-mapped region of a file
+	 *
+	 * Nothing is read up front: pages are faulted in from the file as they
+	 * are touched, so a tensor larger than physical memory can be opened
+	 * and the kernel may drop clean pages again under pressure. A
+	 * read-only tensor shares its pages with every other process mapping
+	 * the file: writing it in place (at, non-const getData, fill, in-place
+	 * ops or use as an out argument) throws ReadOnlyTensorError, while
+	 * out-of-place ops and assignment give it a fresh buffer. A
+	 * copy-on-write tensor can be modified freely without touching the file.
+	 *
+	 * path: File holding the elements in row-major order
+	 * offset: Byte offset of the first element (multiple of sizeof(T))
+	 * shape: Vector containing size of each dimension
+	 * dtype: Element type stored in the file (must match T)
+	 * mode: Read-only or copy-on-write pages
+	 * Output: Tensor viewing the file (throws TensorFileError or TensorDismatchError)
+	 */
+	static BasicTensor mapFile(const std::string& path, size_t offset, const Shape& shape,
+	                           DType dtype, MapMode mode = MapMode::ReadOnly);
 
 	/**
 	 * Reshape tensor to new dimensions without changing data
 	 *
+	 * Shares storage with this tensor; a non-contiguous view is reshaped
+	 * from a compact copy instead.
+	 *
 	 * newShape: New shape (must have same total size)
-	 * Output: New tensor with specified shape
+	 * Output: View with specified shape
 	 */
-	Tensor reshape(const std::vector<size_t>& newShape) const;
+	BasicTensor reshape(const Shape& newShape) const;
 
 	/**
 	 * Flatten tensor to 1D array
 	 *
-	 * Output: New 1D tensor with all elements
+	 * Output: 1D view with all elements
+	 */
+	BasicTensor flatten() const;
+
+	/**
+	 * Select the index range [begin, end) along the first dimension
+	 *
+	 * begin: First index included
+	 * end: One past the last index included
+	 * Output: View sharing storage with this tensor
+	 */
+	BasicTensor slice(size_t begin, size_t end) const;
+
+	/**
+	 * Get a contiguous tensor with the same elements
+	 *
+	 * Output: This tensor's view if already contiguous, else a compact copy
 	 */
-	Tensor flatten() const;
+	BasicTensor contiguous() const;
+
+	/**
+	 * Get the shape two operands broadcast to
+	 *
+	 * Shapes are aligned at their last dimension; each pair of sizes must
+	 * be equal or contain a 1, and missing leading dimensions count as 1.
+	 *
+	 * a: Shape of the left operand
+	 * b: Shape of the right operand
+	 * Output: Broadcast shape (throws TensorDismatchError if incompatible)
+	 */
+	static Shape broadcastShape(const Shape& a, const Shape& b);
 
 	/**
 	 * Element-wise addition
 	 *
-	 * other: Tensor to add (must have same shape)
+	 * other: Tensor to add (shapes must broadcast)
 	 * Output: New tensor with element-wise sum
 	 */
-	Tensor operator+(const Tensor& other) const;
+	BasicTensor operator+(const BasicTensor& other) const;
 
 	/**
 	 * Element-wise subtraction
 	 *
-	 * other: Tensor to subtract (must have same shape)
+	 * other: Tensor to subtract (shapes must broadcast)
 	 * Output: New tensor with element-wise difference
 	 */
-	Tensor operator-(const Tensor& other) const;
+	BasicTensor operator-(const BasicTensor& other) const;
+
+	/**
+	 * Element-wise division
+	 *
+	 * other: Divisor (shapes must broadcast)
+	 * Output: New tensor with element-wise quotient
+	 */
+	BasicTensor operator/(const BasicTensor& other) const;
 
 	/**
 	 * Scalar multiplication
@@ -183,15 +435,15 @@ public:
 	 * scalar: Value to multiply all elements by
 	 * Output: New tensor with scaled values
 	 */
-	Tensor operator*(double scalar) const;
+	BasicTensor operator*(T scalar) const;
 
 	/**
 	 * Element-wise multiplication (Hadamard product)
 	 *
-	 * other: Tensor to multiply (must have same shape)
+	 * other: Tensor to multiply (shapes must broadcast)
 	 * Output: New tensor with element-wise product
 	 */
-	Tensor hadamard(const Tensor& other) const;
+	BasicTensor hadamard(const BasicTensor& other) const;
 
 	/**
 	 * Matrix multiplication (2D tensors only)
@@ -199,21 +451,290 @@ public:
 	 * other: Right operand (inner dimensions must match)
 	 * Output: Result of matrix multiplication
 	 */
-	Tensor matmul(const Tensor& other) const;
+	BasicTensor matmul(const BasicTensor& other) const;
+
+	/**
+	 * Batched matrix multiplication over leading dimensions
+	 *
+	 * The last two dimensions are the matrices; the leading ones are batch
+	 * dimensions and broadcast like element-wise ops, so a 2D operand is
+	 * applied to every matrix of the other.
+	 *
+	 * other: Right operand, [..., K, N] against this tensor's [..., M, K]
+	 * Output: New tensor of shape [broadcast batch..., M, N]
+	 */
+	BasicTensor bmm(const BasicTensor& other) const;
+
+	/**
+	 * out = a + b, written into an existing tensor
+	 *
+	 * out: Destination with the broadcast shape of a and b (may alias an
+	 *      operand of that shape)
+	 * a: Left operand
+	 * b: Right operand
+	 */
+	static void add(BasicTensor& out, const BasicTensor& a, const BasicTensor& b);
+
+	/**
+	 * out = a - b, written into an existing tensor
+	 *
+	 * out: Destination with the broadcast shape of a and b (may alias an
+	 *      operand of that shape)
+	 * a: Left operand
+	 * b: Right operand
+	 */
+	static void sub(BasicTensor& out, const BasicTensor& a, const BasicTensor& b);
+
+	/**
+	 * out = a * b element-wise, written into an existing tensor
+	 *
+	 * out: Destination with the broadcast shape of a and b (may alias an
+	 *      operand of that shape)
+	 * a: Left operand
+	 * b: Right operand
+	 */
+	static void hadamard(BasicTensor& out, const BasicTensor& a, const BasicTensor& b);
+
+	/**
+	 * out = a / b element-wise, written into an existing tensor
+	 *
+	 * out: Destination with the broadcast shape of a and b (may alias an
+	 *      operand of that shape)
+	 * a: Dividend
+	 * b: Divisor
+	 */
+	static void divide(BasicTensor& out, const BasicTensor& a, const BasicTensor& b);
+
+	/**
+	 * out = a * scalar, written into an existing tensor
+	 *
+	 * out: Destination with the same shape as a (may alias it)
+	 * a: Operand
+	 * scalar: Value to multiply all elements by
+	 */
+	static void scale(BasicTensor& out, const BasicTensor& a, T scalar);
+
+	/**
+	 * out = alpha * op(a) * op(b) + beta * out, written into an existing tensor
+	 *
+	 * op(x) is x or its transpose. Transposition only changes the strides
+	 * handed to gemm, so no operand is copied.
+	 *
+	 * out: Destination of shape M x N (must not overlap a or b)
+	 * a: Left operand, M x K after op
+	 * b: Right operand, K x N after op
+	 * alpha: Scale of the product
+	 * beta: Scale of the existing contents of out (0 overwrites them)
+	 * transA: Use a transposed
+	 * transB: Use b transposed
+	 */
+	static void matmul(BasicTensor& out, const BasicTensor& a, const BasicTensor& b,
+	                   T alpha = T(1), T beta = T(0), bool transA = false, bool transB = false);
+
+	/**
+	 * Batched out = alpha * op(a) * op(b) + beta * out over leading dimensions
+	 *
+	 * Every matrix is read in place through its strides, so sliced,
+	 * transposed and broadcast operands are never copied. Small matrices
+	 * are spread over the worker pool one product per task.
+	 *
+	 * out: Destination [broadcast batch..., M, N] (must not overlap a or b)
+	 * a: Left operand, [..., M, K] after op
+	 * b: Right operand, [..., K, N] after op
+	 * alpha: Scale of the products
+	 * beta: Scale of the existing contents of out (0 overwrites them)
+	 * transA: Transpose the matrices of a
+	 * transB: Transpose the matrices of b
+	 */
+	static void bmm(BasicTensor& out, const BasicTensor& a, const BasicTensor& b,
+	                T alpha = T(1), T beta = T(0), bool transA = false, bool transB = false);
+
+	/**
+	 * In-place element-wise addition: this += other
+	 *
+	 * other: Tensor to add (must broadcast to this tensor's shape)
+	 * Output: Reference to this tensor
+	 */
+	BasicTensor& add_(const BasicTensor& other);
+
+	/**
+	 * In-place element-wise subtraction: this -= other
+	 *
+	 * other: Tensor to subtract (must broadcast to this tensor's shape)
+	 * Output: Reference to this tensor
+	 */
+	BasicTensor& sub_(const BasicTensor& other);
+
+	/**
+	 * In-place element-wise multiplication: this *= other
+	 *
+	 * other: Tensor to multiply (must broadcast to this tensor's shape)
+	 * Output: Reference to this tensor
+	 */
+	BasicTensor& mul_(const BasicTensor& other);
+
+	/**
+	 * In-place element-wise division: this /= other
+	 *
+	 * other: Divisor (must broadcast to this tensor's shape)
+	 * Output: Reference to this tensor
+	 */
+	BasicTensor& div_(const BasicTensor& other);
+
+	/**
+	 * In-place scalar multiplication: this *= scalar
+	 *
+	 * scalar: Value to multiply all elements by
+	 * Output: Reference to this tensor
+	 */
+	BasicTensor& scale_(T scalar);
+
+	/**
+	 * In-place scaled addition: this += alpha * x
+	 *
+	 * alpha: Scale of x
+	 * x: Tensor to add (must have same shape)
+	 * Output: Reference to this tensor
+	 */
+	BasicTensor& axpy_(T alpha, const BasicTensor& x);
+
+	/**
+	 * Fused in-place update: this = alpha * this + beta * x
+	 *
+	 * alpha: Scale of this tensor
+	 * beta: Scale of x
+	 * x: Tensor to add (must have same shape)
+	 * Output: Reference to this tensor
+	 */
+	BasicTensor& scaleAdd_(T alpha, T beta, const BasicTensor& x);
 
 	/**
 	 * Transpose matrix (2D tensors only)
 	 *
-	 * Output: Transposed tensor
+	 * Output: Transposed view sharing storage with this tensor
 	 */
-	Tensor transpose() const;
+	BasicTensor transpose() const;
 
 	/**
 	 * Fill all elements with a specific value
 	 *
 	 * value: Value to fill all elements with
 	 */
-	void fill(double value);
+	void fill(T value);
+
+	/**
+	 * Sum of all elements
+	 *
+	 * Output: Sum, accumulated pairwise in ComputeType<T>
+	 */
+	T sum() const;
+
+	/**
+	 * Sum along one axis
+	 *
+	 * axis: Dimension to reduce
+	 * keepDims: Keep the reduced dimension with size 1
+	 * Output: Tensor of the remaining dimensions ({1} if none remain)
+	 */
+	BasicTensor sum(size_t axis, bool keepDims = false) const;
+
+	/**
+	 * out = sum of a along one axis, written into an existing tensor
+	 *
+	 * out: Destination shaped like a without axis, or with it set to 1
+	 * a: Tensor to reduce
+	 * axis: Dimension to reduce
+	 */
+	static void sum(BasicTensor& out, const BasicTensor& a, size_t axis);
+
+	/**
+	 * Mean of all elements
+	 *
+	 * Output: Sum divided by size()
+	 */
+	T mean() const;
+
+	/**
+	 * Mean along one axis
+	 *
+	 * axis: Dimension to reduce
+	 * keepDims: Keep the reduced dimension with size 1
+	 * Output: Tensor of the remaining dimensions ({1} if none remain)
+	 */
+	BasicTensor mean(size_t axis, bool keepDims = false) const;
+
+	/**
+	 * Largest element (the tensor must not be empty)
+	 *
+	 * Output: Maximum value
+	 */
+	T max() const;
+
+	/**
+	 * Maximum along one axis (the axis must not be empty)
+	 *
+	 * axis: Dimension to reduce
+	 * keepDims: Keep the reduced dimension with size 1
+	 * Output: Tensor of the remaining dimensions ({1} if none remain)
+	 */
+	BasicTensor max(size_t axis, bool keepDims = false) const;
+
+	/**
+	 * Position of the first largest element in row-major order
+	 *
+	 * Output: Flat index of the maximum
+	 */
+	size_t argmax() const;
+
+	/**
+	 * Positions of the first maxima along one axis
+	 *
+	 * axis: Dimension to reduce
+	 * Output: Index along axis for every position of the remaining
+	 *         dimensions, in row-major order
+	 */
+	std::vector<size_t> argmax(size_t axis) const;
+
+	/**
+	 * log(sum(exp(x))) along one axis, computed stably around the maximum
+	 *
+	 * axis: Dimension to reduce
+	 * keepDims: Keep the reduced dimension with size 1
+	 * Output: Tensor of the remaining dimensions ({1} if none remain)
+	 */
+	BasicTensor logsumexp(size_t axis, bool keepDims = false) const;
+
+	/**
+	 * Get the element type tag of this tensor
+	 *
+	 * Output: DType matching T
+	 */
+	DType dtype() const { return DTypeOf<T>::value; }
+
+	/**
+	 * Convert every element to another element type
+	 *
+	 * U: Target element type
+	 * Output: New tensor with the same shape holding converted values
+	 */
+	template <typename U>
+	BasicTensor<U> cast() const {
+		BasicTensor<U> result(shape);
+		Span<const T> in = getData();
+		Span<U> out = result.getData();
+		for (size_t i = 0; i < in.size(); i++) {
+			out[i] = static_cast<U>(static_cast<typename ComputeType<T>::type>(in[i]));
+		}
+		return result;
+	}
 };
 
+extern template class BasicTensor<double>;
+extern template class BasicTensor<float>;
+extern template class BasicTensor<bfloat16>;
+
+using Tensor = BasicTensor<double>;
+using TensorF = BasicTensor<float>;
+using TensorBF16 = BasicTensor<bfloat16>;
+
 #endif
\ No newline at end of file
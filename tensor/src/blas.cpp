@@ -0,0 +1,28 @@
+/* blas.cpp */
+
+#ifdef GEMM_CBLAS
+
+#include "../include/blas.hpp"
+#include <cblas.h>
+
+namespace blas {
+
+void gemm(bool rowMajor, bool transA, bool transB, size_t M, size_t N, size_t K,
+          double alpha, const double* A, size_t lda, const double* B, size_t ldb,
+          double beta, double* C, size_t ldc) {
+	cblas_dgemm(rowMajor ? CblasRowMajor : CblasColMajor,
+	            transA ? CblasTrans : CblasNoTrans, transB ? CblasTrans : CblasNoTrans,
+	            M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+void gemm(bool rowMajor, bool transA, bool transB, size_t M, size_t N, size_t K,
+          float alpha, const float* A, size_t lda, const float* B, size_t ldb,
+          float beta, float* C, size_t ldc) {
+	cblas_sgemm(rowMajor ? CblasRowMajor : CblasColMajor,
+	            transA ? CblasTrans : CblasNoTrans, transB ? CblasTrans : CblasNoTrans,
+	            M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+}
+
+#endif
\ No newline at end of file
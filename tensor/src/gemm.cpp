@@ -0,0 +1,448 @@
+/* gemm.cpp */
+
+#include "../include/gemm.hpp"
+#include "../include/simd.hpp"
+#include "../include/parallel.hpp"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GEMM_X86 1
+#endif
+
+#ifdef GEMM_CBLAS
+#include "../include/blas.hpp"
+#endif
+
+namespace {
+
+/* Cache blocks: an MC x KC panel of A stays in L2, a KC x NR sliver of B in L1 */
+constexpr size_t MC = 96;
+constexpr size_t KC = 256;
+constexpr size_t NC = 2048;
+
+/* Largest MR x NR tile of any micro-kernel below */
+constexpr size_t MAX_TILE = 8 * 32;
+
+/* Products with fewer multiply-adds than this skip packing entirely */
+constexpr size_t SMALL_GEMM_FLOPS = 8 * 8 * 8;
+
+/* Products with fewer multiply-adds than this stay on the calling thread */
+constexpr size_t PARALLEL_GEMM_FLOPS = 128 * 128 * 128;
+
+/* Auto never calls the library until setBlasThreshold() says so: in make bench on the
+   reference VM, OpenBLAS 0.3.21 as installed loses to the built-in kernel from n = 48 up
+   (2x slower at n = 512), so no default cut-off holds without tuning the library */
+constexpr size_t DEFAULT_BLAS_FLOPS = std::numeric_limits<size_t>::max();
+
+GemmBackend backendMode = GemmBackend::Auto;
+size_t blasFlops = DEFAULT_BLAS_FLOPS;
+
+namespace generic {
+#include "gemm_kernel.inc"
+}
+
+#ifdef GEMM_X86
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace avx2 {
+#include "gemm_kernel.inc"
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace avx512 {
+#include "gemm_kernel.inc"
+}
+#pragma GCC pop_options
+
+#endif
+
+/**
+ * Micro-kernel chosen for the running CPU together with its tile shape
+ */
+template <typename Acc>
+struct MicroKernel {
+	size_t mr;
+	size_t nr;
+	void (*run)(size_t kc, const Acc* a, const Acc* b, Acc* ab);
+};
+
+/**
+ * Pick the micro-kernel for the active instruction set
+ *
+ * Tiles are two vectors wide and as tall as the register file allows:
+ * 8 rows on AVX-512 (32 registers), 6 on AVX2 and 4 on SSE2.
+ */
+template <typename Acc>
+MicroKernel<Acc> selectMicroKernel() {
+	switch (simd::activeIsa()) {
+#ifdef GEMM_X86
+		case simd::Isa::AVX512: {
+			constexpr size_t nr = 2 * 64 / sizeof(Acc);
+			return {8, nr, avx512::microKernel<Acc, 8, nr>};
+		}
+		case simd::Isa::AVX2: {
+			constexpr size_t nr = 2 * 32 / sizeof(Acc);
+			return {6, nr, avx2::microKernel<Acc, 6, nr>};
+		}
+#endif
+		default: {
+			constexpr size_t nr = 2 * 16 / sizeof(Acc);
+			return {4, nr, generic::microKernel<Acc, 4, nr>};
+		}
+	}
+}
+
+template <typename Acc, typename T>
+inline Acc widen(T value) {
+	return static_cast<Acc>(static_cast<typename ComputeType<T>::type>(value));
+}
+
+/**
+ * Pack an mc x kc block of A into consecutive mr-row slivers
+ *
+ * Each sliver is stored k-major (mr values per k) and zero-padded when
+ * fewer than mr rows remain, so the micro-kernel never branches on edges.
+ */
+template <typename T, typename Acc>
+void packA(size_t mc, size_t kc, size_t mr, const T* A, size_t rsA, size_t csA, Acc* packed) {
+	for (size_t i0 = 0; i0 < mc; i0 += mr) {
+		size_t rows = std::min(mr, mc - i0);
+		for (size_t k = 0; k < kc; k++) {
+			const T* src = A + i0 * rsA + k * csA;
+			for (size_t i = 0; i < rows; i++) {
+				packed[i] = widen<Acc>(src[i * rsA]);
+			}
+			for (size_t i = rows; i < mr; i++) {
+				packed[i] = Acc(0);
+			}
+			packed += mr;
+		}
+	}
+}
+
+/**
+ * Pack a kc x nc block of B into consecutive nr-column slivers
+ *
+ * Each sliver is stored k-major (nr values per k) and zero-padded when
+ * fewer than nr columns remain.
+ */
+template <typename T, typename Acc>
+void packB(size_t kc, size_t nc, size_t nr, const T* B, size_t rsB, size_t csB, Acc* packed) {
+	for (size_t j0 = 0; j0 < nc; j0 += nr) {
+		size_t cols = std::min(nr, nc - j0);
+		for (size_t k = 0; k < kc; k++) {
+			const T* src = B + k * rsB + j0 * csB;
+			for (size_t j = 0; j < cols; j++) {
+				packed[j] = widen<Acc>(src[j * csB]);
+			}
+			for (size_t j = cols; j < nr; j++) {
+				packed[j] = Acc(0);
+			}
+			packed += nr;
+		}
+	}
+}
+
+/**
+ * Write a micro-kernel tile back to C: C = alpha * ab + beta * C
+ *
+ * Only the leading rows x cols part is stored, which handles matrix edges.
+ * ldab is the row length of the tile buffer.
+ */
+template <typename T, typename Acc>
+void storeTile(size_t rows, size_t cols, Acc alpha, const Acc* ab, size_t ldab, Acc beta,
+               T* C, size_t rsC, size_t csC) {
+	for (size_t i = 0; i < rows; i++) {
+		T* c = C + i * rsC;
+		const Acc* tile = ab + i * ldab;
+		if (beta == Acc(0)) {
+			for (size_t j = 0; j < cols; j++) {
+				c[j * csC] = static_cast<T>(alpha * tile[j]);
+			}
+		} else {
+			for (size_t j = 0; j < cols; j++) {
+				c[j * csC] = static_cast<T>(alpha * tile[j] + beta * widen<Acc>(c[j * csC]));
+			}
+		}
+	}
+}
+
+template <typename T, typename Acc>
+void scaleMatrix(size_t M, size_t N, Acc beta, T* C, size_t rsC, size_t csC) {
+	for (size_t i = 0; i < M; i++) {
+		for (size_t j = 0; j < N; j++) {
+			T& c = C[i * rsC + j * csC];
+			c = (beta == Acc(0)) ? T(0) : static_cast<T>(beta * widen<Acc>(c));
+		}
+	}
+}
+
+/**
+ * Get this thread's buffer for packed A panels
+ *
+ * Reused across calls to keep the hot path allocation-free.
+ */
+template <typename Acc>
+Acc* packBufferA(size_t size) {
+	static thread_local std::vector<Acc> buffer;
+	if (buffer.size() < size) {
+		buffer.resize(size);
+	}
+	return buffer.data();
+}
+
+/**
+ * Unpacked dot-product loop for operands too small to amortize packing
+ */
+template <typename T, typename Acc>
+void smallGemm(size_t M, size_t N, size_t K, Acc alpha,
+               const T* A, size_t rsA, size_t csA,
+               const T* B, size_t rsB, size_t csB,
+               Acc beta, T* C, size_t rsC, size_t csC) {
+	for (size_t i = 0; i < M; i++) {
+		for (size_t j = 0; j < N; j++) {
+			Acc sum = Acc(0);
+			for (size_t k = 0; k < K; k++) {
+				sum += widen<Acc>(A[i * rsA + k * csA]) * widen<Acc>(B[k * rsB + j * csB]);
+			}
+			T& c = C[i * rsC + j * csC];
+			c = (beta == Acc(0)) ? static_cast<T>(alpha * sum)
+			                     : static_cast<T>(alpha * sum + beta * widen<Acc>(c));
+		}
+	}
+}
+
+#ifdef GEMM_CBLAS
+
+/**
+ * Describe one strided operand to CBLAS
+ *
+ * CBLAS needs a unit stride along one axis: in the layout of C, a matrix
+ * whose other stride is 1 is passed transposed. Leading dimensions must
+ * also cover the matrix, which rules out broadcast (zero-stride) operands.
+ */
+bool blasOperand(bool rowMajor, size_t rows, size_t cols, size_t rs, size_t cs, bool& trans, size_t& ld) {
+	size_t inner = rowMajor ? cs : rs;
+	size_t outer = rowMajor ? rs : cs;
+	size_t innerLength = rowMajor ? cols : rows;
+	size_t outerLength = rowMajor ? rows : cols;
+	if (inner == 1 && outer >= std::max<size_t>(innerLength, 1)) {
+		trans = false;
+		ld = outer;
+		return true;
+	}
+	if (outer == 1 && inner >= std::max<size_t>(outerLength, 1)) {
+		trans = true;
+		ld = inner;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Hand a double or float product to the CBLAS library
+ *
+ * Output: False if the strides cannot be expressed, leaving C untouched
+ */
+template <typename T>
+bool blasGemm(size_t M, size_t N, size_t K, T alpha,
+              const T* A, size_t rsA, size_t csA,
+              const T* B, size_t rsB, size_t csB,
+              T beta, T* C, size_t rsC, size_t csC) {
+	bool rowMajor = (csC == 1 && rsC >= N);
+	if (!rowMajor && !(rsC == 1 && csC >= M)) {
+		return false;
+	}
+
+	bool transA, transB;
+	size_t lda, ldb;
+	if (!blasOperand(rowMajor, M, K, rsA, csA, transA, lda) ||
+	    !blasOperand(rowMajor, K, N, rsB, csB, transB, ldb)) {
+		return false;
+	}
+
+	blas::gemm(rowMajor, transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, rowMajor ? rsC : csC);
+	return true;
+}
+
+/**
+ * Decide whether a product goes to the CBLAS library
+ */
+bool useBlas(size_t M, size_t N, size_t K) {
+	switch (backendMode) {
+		case GemmBackend::Blas:
+			return true;
+		case GemmBackend::Builtin:
+			return false;
+		default:
+			return M * N * K >= blasFlops;
+	}
+}
+
+#endif
+
+}
+
+bool hasBlas() {
+#ifdef GEMM_CBLAS
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool setGemmBackend(GemmBackend backend) {
+	if (backend == GemmBackend::Blas && !hasBlas()) {
+		return false;
+	}
+	backendMode = backend;
+	return true;
+}
+
+GemmBackend gemmBackend() {
+	return backendMode;
+}
+
+void setBlasThreshold(size_t flops) {
+	blasFlops = flops;
+}
+
+size_t blasThreshold() {
+	return blasFlops;
+}
+
+template <typename T>
+void gemm(size_t M, size_t N, size_t K,
+          typename ComputeType<T>::type alpha,
+          const T* A, size_t rsA, size_t csA,
+          const T* B, size_t rsB, size_t csB,
+          typename ComputeType<T>::type beta,
+          T* C, size_t rsC, size_t csC) {
+	using Acc = typename ComputeType<T>::type;
+
+	if (M == 0 || N == 0) {
+		return;
+	}
+
+	if (K == 0 || alpha == Acc(0)) {
+		scaleMatrix(M, N, beta, C, rsC, csC);
+		return;
+	}
+
+#ifdef GEMM_CBLAS
+	if constexpr (!std::is_same<T, bfloat16>::value) {
+		if (useBlas(M, N, K) && blasGemm<T>(M, N, K, alpha, A, rsA, csA, B, rsB, csB, beta, C, rsC, csC)) {
+			return;
+		}
+	}
+#endif
+
+	if (M * N * K <= SMALL_GEMM_FLOPS) {
+		smallGemm(M, N, K, alpha, A, rsA, csA, B, rsB, csB, beta, C, rsC, csC);
+		return;
+	}
+
+	MicroKernel<Acc> kernel = selectMicroKernel<Acc>();
+	size_t mr = kernel.mr;
+	size_t nr = kernel.nr;
+
+	/* B panels are packed once per block by the caller and shared by all tasks */
+	static thread_local std::vector<Acc> packedBBuffer;
+	packedBBuffer.resize(((std::min(NC, N) + nr - 1) / nr) * nr * KC);
+	Acc* packedB = packedBBuffer.data();
+	size_t packedASize = ((MC + mr - 1) / mr) * mr * KC;
+
+	size_t threads = (M * N * K >= PARALLEL_GEMM_FLOPS) ? parallel::getNumThreads() : 1;
+	size_t mBlocks = (M + MC - 1) / MC;
+
+	for (size_t jc = 0; jc < N; jc += NC) {
+		size_t nc = std::min(NC, N - jc);
+		size_t nPanels = (nc + nr - 1) / nr;
+
+		/* Tasks are MC-row blocks, further split by column when there are too few rows */
+		size_t nGroups = std::min(nPanels, (threads + mBlocks - 1) / mBlocks);
+
+		for (size_t pc = 0; pc < K; pc += KC) {
+			size_t kc = std::min(KC, K - pc);
+			Acc betaBlock = (pc == 0) ? beta : Acc(1);
+
+			packB(kc, nc, nr, B + pc * rsB + jc * csB, rsB, csB, packedB);
+
+			auto task = [&](size_t t) {
+				size_t ic = (t / nGroups) * MC;
+				size_t mc = std::min(MC, M - ic);
+				size_t group = t % nGroups;
+				size_t firstPanel = group * nPanels / nGroups;
+				size_t lastPanel = (group + 1) * nPanels / nGroups;
+
+				Acc* packedA = packBufferA<Acc>(packedASize);
+				packA(mc, kc, mr, A + ic * rsA + pc * csA, rsA, csA, packedA);
+
+				Acc ab[MAX_TILE];
+				for (size_t panel = firstPanel; panel < lastPanel; panel++) {
+					size_t jr = panel * nr;
+					size_t cols = std::min(nr, nc - jr);
+					const Acc* b = packedB + jr * kc;
+
+					for (size_t ir = 0; ir < mc; ir += mr) {
+						size_t rows = std::min(mr, mc - ir);
+						const Acc* a = packedA + ir * kc;
+
+						kernel.run(kc, a, b, ab);
+						storeTile(rows, cols, alpha, ab, nr, betaBlock,
+						          C + (ic + ir) * rsC + (jc + jr) * csC, rsC, csC);
+					}
+				}
+			};
+
+			size_t tasks = mBlocks * nGroups;
+			if (threads > 1) {
+				parallel::parallelFor(tasks, task);
+			} else {
+				for (size_t t = 0; t < tasks; t++) {
+					task(t);
+				}
+			}
+		}
+	}
+}
+
+template <typename T>
+void gemmBatched(size_t batch, size_t M, size_t N, size_t K,
+                 typename ComputeType<T>::type alpha,
+                 const T* const* A, size_t rsA, size_t csA,
+                 const T* const* B, size_t rsB, size_t csB,
+                 typename ComputeType<T>::type beta,
+                 T* const* C, size_t rsC, size_t csC) {
+	auto product = [&](size_t i) {
+		gemm<T>(M, N, K, alpha, A[i], rsA, csA, B[i], rsB, csB, beta, C[i], rsC, csC);
+	};
+
+	if (batch > 1 && M * N * K < PARALLEL_GEMM_FLOPS && parallel::getNumThreads() > 1) {
+		parallel::parallelFor(batch, product);
+		return;
+	}
+	for (size_t i = 0; i < batch; i++) {
+		product(i);
+	}
+}
+
+#define INSTANTIATE_GEMM(T) \
+	template void gemm<T>(size_t, size_t, size_t, typename ComputeType<T>::type, \
+	                      const T*, size_t, size_t, const T*, size_t, size_t, \
+	                      typename ComputeType<T>::type, T*, size_t, size_t); \
+	template void gemmBatched<T>(size_t, size_t, size_t, size_t, typename ComputeType<T>::type, \
+	                             const T* const*, size_t, size_t, const T* const*, size_t, size_t, \
+	                             typename ComputeType<T>::type, T* const*, size_t, size_t);
+
+INSTANTIATE_GEMM(double)
+INSTANTIATE_GEMM(float)
+INSTANTIATE_GEMM(bfloat16)
+
+#undef INSTANTIATE_GEMM
\ No newline at end of file
@@ -0,0 +1,52 @@
+/* mapped.cpp */
+
+#include "../include/mapped.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(void* base, size_t length, char* region, size_t bytes, bool canWrite)
+	: base(base), length(length), region(region), bytes(bytes), canWrite(canWrite) {}
+
+MappedFile::~MappedFile() {
+	if (base != nullptr) {
+		munmap(base, length);
+	}
+}
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path, size_t offset, size_t bytes, MapMode mode) {
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw TensorFileError();
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || offset + bytes < offset ||
+	    offset + bytes > static_cast<size_t>(info.st_size)) {
+		close(fd);
+		throw TensorFileError();
+	}
+
+	if (bytes == 0) {
+		close(fd);
+		return std::shared_ptr<MappedFile>(new MappedFile(nullptr, 0, nullptr, 0, mode == MapMode::CopyOnWrite));
+	}
+
+	/* mmap offsets must be page aligned: map from the enclosing page and skip the head */
+	size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	size_t head = offset % page;
+	size_t length = head + bytes;
+	bool canWrite = (mode == MapMode::CopyOnWrite);
+	int protection = canWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+	int flags = canWrite ? MAP_PRIVATE : MAP_SHARED;
+
+	void* base = mmap(nullptr, length, protection, flags, fd, static_cast<off_t>(offset - head));
+	close(fd);
+	if (base == MAP_FAILED) {
+		throw TensorFileError();
+	}
+
+	return std::shared_ptr<MappedFile>(
+		new MappedFile(base, length, static_cast<char*>(base) + head, bytes, canWrite));
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+/* parallel.cpp */
+
+#include "../include/parallel.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+namespace {
+
+thread_local bool insideWorker = false;
+
+size_t defaultThreads() {
+	const char* env = std::getenv("CNN_NUM_THREADS");
+	if (env != nullptr) {
+		long value = std::strtol(env, nullptr, 10);
+		if (value > 0) {
+			return static_cast<size_t>(value);
+		}
+	}
+	unsigned hardware = std::thread::hardware_concurrency();
+	return hardware > 0 ? hardware : 1;
+}
+
+/**
+ * Sleeping workers plus the job currently being executed
+ *
+ * A job is published by bumping generation; workers and the caller then
+ * claim task indices from next until they run out.
+ */
+class Pool {
+private:
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	size_t generation = 0;
+	bool stopping = false;
+
+	void (*fn)(void*, size_t) = nullptr;
+	void* ctx = nullptr;
+	size_t tasks = 0;
+	std::atomic<size_t> next{0};
+	size_t active = 0;
+
+	void work() {
+		for (;;) {
+			size_t task = next.fetch_add(1, std::memory_order_relaxed);
+			if (task >= tasks) {
+				return;
+			}
+			fn(ctx, task);
+		}
+	}
+
+	void workerLoop() {
+		insideWorker = true;
+		size_t seen = 0;
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				wake.wait(guard, [&] { return stopping || generation != seen; });
+				if (stopping) {
+					return;
+				}
+				seen = generation;
+			}
+			work();
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				if (--active == 0) {
+					finished.notify_one();
+				}
+			}
+		}
+	}
+
+public:
+	/* Serializes jobs; a second concurrent caller runs its job inline */
+	std::mutex submit;
+
+	explicit Pool(size_t threads) {
+		for (size_t i = 1; i < threads; i++) {
+			workers.emplace_back([this] { workerLoop(); });
+		}
+	}
+
+	~Pool() {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+	size_t size() const {
+		return workers.size() + 1;
+	}
+
+	void execute(size_t count, void (*body)(void*, size_t), void* context) {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			fn = body;
+			ctx = context;
+			tasks = count;
+			next.store(0, std::memory_order_relaxed);
+			active = workers.size();
+			generation++;
+		}
+		wake.notify_all();
+
+		work();
+
+		std::unique_lock<std::mutex> guard(lock);
+		finished.wait(guard, [&] { return active == 0; });
+	}
+};
+
+std::mutex instanceLock;
+size_t requestedThreads = 0;
+Pool* instance = nullptr;
+
+Pool& workerPool() {
+	std::lock_guard<std::mutex> guard(instanceLock);
+	if (instance == nullptr) {
+		instance = new Pool(requestedThreads > 0 ? requestedThreads : defaultThreads());
+	}
+	return *instance;
+}
+
+}
+
+void setNumThreads(size_t n) {
+	std::lock_guard<std::mutex> guard(instanceLock);
+	requestedThreads = n;
+	delete instance;
+	instance = nullptr;
+}
+
+size_t getNumThreads() {
+	return workerPool().size();
+}
+
+void run(size_t tasks, void (*fn)(void* ctx, size_t task), void* ctx) {
+	if (tasks == 0) {
+		return;
+	}
+
+	Pool* target = (tasks > 1 && !insideWorker) ? &workerPool() : nullptr;
+	if (target == nullptr || target->size() == 1 || !target->submit.try_lock()) {
+		for (size_t i = 0; i < tasks; i++) {
+			fn(ctx, i);
+		}
+		return;
+	}
+
+	target->execute(tasks, fn, ctx);
+	target->submit.unlock();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,391 @@
+/* pool.cpp */
+
+#include "../include/pool.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace pool {
+
+namespace {
+
+constexpr size_t ALIGNMENT = 64;
+
+/* Size classes: 64 bytes, then four evenly spaced classes per power of two */
+constexpr size_t MIN_CLASS_LOG = 6;
+constexpr size_t MAX_CLASS_LOG = 26;
+constexpr size_t NUM_CLASSES = 1 + (MAX_CLASS_LOG - MIN_CLASS_LOG) * 4;
+constexpr size_t MAX_POOLED_BYTES = size_t(1) << MAX_CLASS_LOG;
+
+/* Free blocks a thread keeps per class before handing them to the central lists */
+constexpr size_t THREAD_CACHE_DEPTH = 8;
+
+size_t classIndex(size_t bytes) {
+	if (bytes <= (size_t(1) << MIN_CLASS_LOG)) {
+		return 0;
+	}
+	size_t log = 63 - static_cast<size_t>(__builtin_clzll(bytes - 1));
+	size_t step = size_t(1) << (log - 2);
+	size_t sub = (bytes - 1 - (size_t(1) << log)) / step;
+	return 1 + (log - MIN_CLASS_LOG) * 4 + sub;
+}
+
+size_t classBytes(size_t index) {
+	if (index == 0) {
+		return size_t(1) << MIN_CLASS_LOG;
+	}
+	size_t log = MIN_CLASS_LOG + (index - 1) / 4;
+	size_t sub = (index - 1) % 4;
+	return (size_t(1) << log) + (sub + 1) * ((size_t(1) << log) >> 2);
+}
+
+/* Blocks at least this large start on a huge page boundary */
+constexpr size_t HUGE_PAGE_BYTES = size_t(1) << 21;
+
+bool hugePagesFromEnvironment() {
+	const char* env = std::getenv("CNN_HUGEPAGES");
+	return env == nullptr || std::strcmp(env, "0") != 0;
+}
+
+std::atomic<bool>& hugePagesEnabled() {
+	static std::atomic<bool> enabled{hugePagesFromEnvironment()};
+	return enabled;
+}
+
+/* Depends only on the size, so a block is freed with the alignment it was allocated with */
+size_t alignmentFor(size_t bytes) {
+	return bytes >= HUGE_PAGE_BYTES ? HUGE_PAGE_BYTES : ALIGNMENT;
+}
+
+void* systemAllocate(size_t bytes) {
+	size_t alignment = alignmentFor(bytes);
+	void* ptr = ::operator new(bytes, std::align_val_t(alignment));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	if (alignment == HUGE_PAGE_BYTES && hugePagesEnabled().load(std::memory_order_relaxed)) {
+		madvise(ptr, bytes, MADV_HUGEPAGE);
+	}
+#endif
+	return ptr;
+}
+
+void systemFree(void* ptr, size_t bytes) {
+	::operator delete(ptr, std::align_val_t(alignmentFor(bytes)));
+}
+
+struct Counters {
+	std::atomic<size_t> liveBytes{0};
+	std::atomic<size_t> peakBytes{0};
+	std::atomic<size_t> cachedBytes{0};
+	std::atomic<size_t> requests{0};
+	std::atomic<size_t> hits{0};
+};
+
+Counters& counters() {
+	static Counters instance;
+	return instance;
+}
+
+void recordAcquire(size_t bytes, bool hit) {
+	Counters& c = counters();
+	c.requests.fetch_add(1, std::memory_order_relaxed);
+	if (hit) {
+		c.hits.fetch_add(1, std::memory_order_relaxed);
+	}
+	size_t live = c.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	size_t peak = c.peakBytes.load(std::memory_order_relaxed);
+	while (live > peak && !c.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+	}
+}
+
+void recordRelease(size_t bytes) {
+	counters().liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * Free lists shared by all threads
+ *
+ * Never destroyed, so thread caches can flush into it during shutdown.
+ */
+struct CentralLists {
+	std::mutex lock;
+	std::vector<void*> blocks[NUM_CLASSES];
+};
+
+CentralLists& central() {
+	static CentralLists* instance = new CentralLists();
+	return *instance;
+}
+
+void flushToCentral(size_t index, std::vector<void*>& blocks, size_t keep) {
+	if (blocks.size() <= keep) {
+		return;
+	}
+	CentralLists& lists = central();
+	std::lock_guard<std::mutex> guard(lists.lock);
+	lists.blocks[index].insert(lists.blocks[index].end(), blocks.begin() + keep, blocks.end());
+	blocks.resize(keep);
+}
+
+thread_local bool threadCacheDestroyed = false;
+
+/**
+ * Per-thread free blocks, returned to the central lists on thread exit
+ */
+struct ThreadCache {
+	std::vector<void*> blocks[NUM_CLASSES];
+
+	~ThreadCache() {
+		for (size_t i = 0; i < NUM_CLASSES; i++) {
+			flushToCentral(i, blocks[i], 0);
+		}
+		threadCacheDestroyed = true;
+	}
+};
+
+/**
+ * Get this thread's cache, or nullptr once it has been torn down at exit
+ */
+ThreadCache* threadCache() {
+	if (threadCacheDestroyed) {
+		return nullptr;
+	}
+	static thread_local ThreadCache cache;
+	return &cache;
+}
+
+thread_local StepArena* activeArena = nullptr;
+
+}
+
+void* allocate(size_t bytes) {
+	if (bytes == 0) {
+		return nullptr;
+	}
+
+	if (bytes > MAX_POOLED_BYTES) {
+		recordAcquire(bytes, false);
+		return systemAllocate(bytes);
+	}
+
+	size_t index = classIndex(bytes);
+	size_t size = classBytes(index);
+	ThreadCache* cache = threadCache();
+	if (cache == nullptr) {
+		recordAcquire(size, false);
+		return systemAllocate(size);
+	}
+	std::vector<void*>& local = cache->blocks[index];
+
+	if (local.empty()) {
+		CentralLists& lists = central();
+		std::lock_guard<std::mutex> guard(lists.lock);
+		std::vector<void*>& shared = lists.blocks[index];
+		size_t take = std::min(shared.size(), THREAD_CACHE_DEPTH / 2);
+		local.insert(local.end(), shared.end() - take, shared.end());
+		shared.resize(shared.size() - take);
+	}
+
+	if (!local.empty()) {
+		void* ptr = local.back();
+		local.pop_back();
+		counters().cachedBytes.fetch_sub(size, std::memory_order_relaxed);
+		recordAcquire(size, true);
+		return ptr;
+	}
+
+	recordAcquire(size, false);
+	return systemAllocate(size);
+}
+
+void deallocate(void* ptr, size_t bytes) {
+	if (ptr == nullptr) {
+		return;
+	}
+
+	if (bytes > MAX_POOLED_BYTES) {
+		recordRelease(bytes);
+		systemFree(ptr, bytes);
+		return;
+	}
+
+	size_t index = classIndex(bytes);
+	size_t size = classBytes(index);
+	recordRelease(size);
+	counters().cachedBytes.fetch_add(size, std::memory_order_relaxed);
+
+	ThreadCache* cache = threadCache();
+	if (cache == nullptr) {
+		CentralLists& lists = central();
+		std::lock_guard<std::mutex> guard(lists.lock);
+		lists.blocks[index].push_back(ptr);
+		return;
+	}
+	std::vector<void*>& local = cache->blocks[index];
+	if (local.capacity() < THREAD_CACHE_DEPTH) {
+		local.reserve(THREAD_CACHE_DEPTH);
+	}
+	local.push_back(ptr);
+	if (local.size() == THREAD_CACHE_DEPTH) {
+		flushToCentral(index, local, THREAD_CACHE_DEPTH / 2);
+	}
+}
+
+Block acquire(size_t bytes) {
+	if (activeArena != nullptr && bytes != 0) {
+		return activeArena->allocate(bytes);
+	}
+	return {allocate(bytes), bytes, nullptr};
+}
+
+/**
+ * Arena chunk header, followed by its payload
+ *
+ * refs counts live blocks plus one for the owning arena while the chunk is
+ * current; whoever drops it to zero frees the chunk.
+ */
+struct ArenaChunk {
+	std::atomic<size_t> refs;
+	size_t capacity;
+	size_t used;
+
+	char* payload() {
+		return reinterpret_cast<char*>(this) + ALIGNMENT;
+	}
+};
+
+namespace {
+
+void dropChunkRef(ArenaChunk* chunk) {
+	if (chunk->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		systemFree(chunk, ALIGNMENT + chunk->capacity);
+	}
+}
+
+}
+
+void release(const Block& block) {
+	if (block.ptr == nullptr) {
+		return;
+	}
+	if (block.chunk == nullptr) {
+		deallocate(block.ptr, block.bytes);
+		return;
+	}
+	recordRelease(block.bytes);
+	dropChunkRef(static_cast<ArenaChunk*>(block.chunk));
+}
+
+PoolStats stats() {
+	Counters& c = counters();
+	return {
+		c.liveBytes.load(std::memory_order_relaxed),
+		c.peakBytes.load(std::memory_order_relaxed),
+		c.cachedBytes.load(std::memory_order_relaxed),
+		c.requests.load(std::memory_order_relaxed),
+		c.hits.load(std::memory_order_relaxed)
+	};
+}
+
+void resetStats() {
+	Counters& c = counters();
+	c.requests.store(0, std::memory_order_relaxed);
+	c.hits.store(0, std::memory_order_relaxed);
+	c.peakBytes.store(c.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void setHugePages(bool enabled) {
+	hugePagesEnabled().store(enabled, std::memory_order_relaxed);
+}
+
+void trim() {
+	ThreadCache* cache = threadCache();
+	if (cache != nullptr) {
+		for (size_t i = 0; i < NUM_CLASSES; i++) {
+			flushToCentral(i, cache->blocks[i], 0);
+		}
+	}
+
+	CentralLists& lists = central();
+	std::lock_guard<std::mutex> guard(lists.lock);
+	for (size_t i = 0; i < NUM_CLASSES; i++) {
+		size_t size = classBytes(i);
+		for (void* ptr : lists.blocks[i]) {
+			systemFree(ptr, size);
+			counters().cachedBytes.fetch_sub(size, std::memory_order_relaxed);
+		}
+		lists.blocks[i].clear();
+		lists.blocks[i].shrink_to_fit();
+	}
+}
+
+StepArena::StepArena(size_t chunkBytes)
+	: current(nullptr), chunkBytes(chunkBytes), stepBytes(0), highWater(0) {}
+
+StepArena::~StepArena() {
+	if (current != nullptr) {
+		retireCurrent();
+	}
+}
+
+void StepArena::retireCurrent() {
+	dropChunkRef(current);
+	current = nullptr;
+}
+
+Block StepArena::allocate(size_t bytes) {
+	size_t rounded = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+	bool hit = current != nullptr && current->used + rounded <= current->capacity;
+	if (!hit) {
+		if (current != nullptr) {
+			retireCurrent();
+		}
+		size_t capacity = std::max({chunkBytes, highWater, stepBytes + rounded});
+		void* memory = systemAllocate(ALIGNMENT + capacity);
+		current = new (memory) ArenaChunk();
+		current->refs.store(1, std::memory_order_relaxed);
+		current->capacity = capacity;
+		current->used = 0;
+	}
+
+	void* ptr = current->payload() + current->used;
+	current->used += rounded;
+	current->refs.fetch_add(1, std::memory_order_relaxed);
+	stepBytes += rounded;
+	recordAcquire(bytes, hit);
+	return {ptr, bytes, current};
+}
+
+void StepArena::reset() {
+	highWater = std::max(highWater, stepBytes);
+	stepBytes = 0;
+	if (current == nullptr) {
+		return;
+	}
+
+	/* Only the arena's own reference left: nothing from this step survived */
+	if (current->refs.load(std::memory_order_acquire) == 1 && current->capacity >= highWater) {
+		current->used = 0;
+	} else {
+		retireCurrent();
+	}
+}
+
+StepArena::Scope::Scope(StepArena& arena) : arena(arena), previous(activeArena) {
+	activeArena = &arena;
+}
+
+StepArena::Scope::~Scope() {
+	activeArena = previous;
+	arena.reset();
+}
+
+}
\ No newline at end of file
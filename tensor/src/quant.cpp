@@ -0,0 +1,371 @@
+/* quant.cpp */
+
+#include "../include/quant.hpp"
+#include "../include/parallel.hpp"
+#include "../include/simd.hpp"
+#include "../include/dtype.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define QUANT_X86 1
+#include <immintrin.h>
+#endif
+
+namespace quant {
+
+namespace {
+
+/* Output channels in one packed group: one 512-bit vector of int32 sums */
+constexpr size_t NR = 16;
+
+/* Inputs multiplied into each int32 sum per instruction */
+constexpr size_t KR = 4;
+
+/* Bytes of one packed group for one step of KR inputs */
+constexpr size_t GROUP_BYTES = NR * KR;
+
+/* Activation rows in one register tile */
+constexpr size_t MR = 4;
+
+/* Most packed groups in one register tile */
+constexpr size_t MAX_GROUPS = 4;
+
+/* Products with fewer multiply-adds than this stay on the calling thread */
+constexpr size_t PARALLEL_QUANT_OPS = 128 * 128 * 128;
+
+/**
+ * Compute one R x (G * NR) tile of accumulators over all input steps
+ *
+ * kSteps: Number of KR-input steps
+ * a: First of R activation rows
+ * lda: Activation row stride
+ * panel: First of G packed groups, each kSteps * GROUP_BYTES long
+ * acc: R x (G * NR) output tile
+ */
+using TileFn = void (*)(size_t kSteps, const uint8_t* a, size_t lda, const int8_t* panel, int32_t* acc);
+
+namespace scalar {
+
+template <size_t R, size_t G>
+void tile(size_t kSteps, const uint8_t* a, size_t lda, const int8_t* panel, int32_t* acc) {
+	std::fill(acc, acc + R * G * NR, 0);
+	for (size_t r = 0; r < R; r++) {
+		for (size_t g = 0; g < G; g++) {
+			const int8_t* group = panel + g * kSteps * GROUP_BYTES;
+			int32_t* out = acc + r * G * NR + g * NR;
+			for (size_t k = 0; k < kSteps; k++) {
+				const uint8_t* x = a + r * lda + k * KR;
+				const int8_t* w = group + k * GROUP_BYTES;
+				for (size_t j = 0; j < NR; j++) {
+					for (size_t t = 0; t < KR; t++) {
+						out[j] += static_cast<int32_t>(x[t]) * w[j * KR + t];
+					}
+				}
+			}
+		}
+	}
+}
+
+}
+
+#ifdef QUANT_X86
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace avx2 {
+
+/**
+ * pmaddubsw sums two u8 x s8 products into int16 and saturates on large
+ * codes, so each activation is split into its low 7 bits and its top bit:
+ * neither half can push a pair past 128 * 127 * 2 = 32512.
+ */
+template <size_t R, size_t G>
+void tile(size_t kSteps, const uint8_t* a, size_t lda, const int8_t* panel, int32_t* acc) {
+	const __m256i ones = _mm256_set1_epi16(1);
+	const __m256i low = _mm256_set1_epi8(0x7F);
+	const __m256i top = _mm256_set1_epi8(static_cast<char>(0x80));
+
+	__m256i sum[R][2 * G];
+	#pragma GCC unroll 8
+	for (size_t r = 0; r < R; r++) {
+		#pragma GCC unroll 8
+		for (size_t c = 0; c < 2 * G; c++) {
+			sum[r][c] = _mm256_setzero_si256();
+		}
+	}
+
+	for (size_t k = 0; k < kSteps; k++) {
+		__m256i w[2 * G];
+		#pragma GCC unroll 8
+		for (size_t g = 0; g < G; g++) {
+			const int8_t* p = panel + g * kSteps * GROUP_BYTES + k * GROUP_BYTES;
+			w[2 * g] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			w[2 * g + 1] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+		}
+		#pragma GCC unroll 8
+		for (size_t r = 0; r < R; r++) {
+			int32_t word;
+			std::memcpy(&word, a + r * lda + k * KR, sizeof(word));
+			__m256i x = _mm256_set1_epi32(word);
+			__m256i xLow = _mm256_and_si256(x, low);
+			__m256i xTop = _mm256_and_si256(x, top);
+			#pragma GCC unroll 8
+			for (size_t c = 0; c < 2 * G; c++) {
+				__m256i pLow = _mm256_madd_epi16(_mm256_maddubs_epi16(xLow, w[c]), ones);
+				__m256i pTop = _mm256_madd_epi16(_mm256_maddubs_epi16(xTop, w[c]), ones);
+				sum[r][c] = _mm256_add_epi32(sum[r][c], _mm256_add_epi32(pLow, pTop));
+			}
+		}
+	}
+
+	#pragma GCC unroll 8
+	for (size_t r = 0; r < R; r++) {
+		#pragma GCC unroll 8
+		for (size_t c = 0; c < 2 * G; c++) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + r * G * NR + c * 8), sum[r][c]);
+		}
+	}
+}
+
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw,avx512vnni")
+namespace vnni {
+
+template <size_t R, size_t G>
+void tile(size_t kSteps, const uint8_t* a, size_t lda, const int8_t* panel, int32_t* acc) {
+	__m512i sum[R][G];
+	#pragma GCC unroll 8
+	for (size_t r = 0; r < R; r++) {
+		#pragma GCC unroll 8
+		for (size_t g = 0; g < G; g++) {
+			sum[r][g] = _mm512_setzero_si512();
+		}
+	}
+
+	for (size_t k = 0; k < kSteps; k++) {
+		__m512i w[G];
+		#pragma GCC unroll 8
+		for (size_t g = 0; g < G; g++) {
+			w[g] = _mm512_loadu_si512(panel + g * kSteps * GROUP_BYTES + k * GROUP_BYTES);
+		}
+		#pragma GCC unroll 8
+		for (size_t r = 0; r < R; r++) {
+			int32_t word;
+			std::memcpy(&word, a + r * lda + k * KR, sizeof(word));
+			__m512i x = _mm512_set1_epi32(word);
+			#pragma GCC unroll 8
+			for (size_t g = 0; g < G; g++) {
+				sum[r][g] = _mm512_dpbusd_epi32(sum[r][g], x, w[g]);
+			}
+		}
+	}
+
+	#pragma GCC unroll 8
+	for (size_t r = 0; r < R; r++) {
+		#pragma GCC unroll 8
+		for (size_t g = 0; g < G; g++) {
+			_mm512_storeu_si512(acc + r * G * NR + g * NR, sum[r][g]);
+		}
+	}
+}
+
+}
+#pragma GCC pop_options
+
+#endif
+
+/**
+ * Tile kernels of one instruction set, indexed by [rows - 1][groups - 1]
+ */
+struct TileKernels {
+	size_t groups;
+	TileFn tiles[MR][MAX_GROUPS];
+};
+
+#define TILE_ROW(ns, R) {ns::tile<R, 1>, ns::tile<R, 2>, ns::tile<R, 3>, ns::tile<R, 4>}
+#define TILE_KERNELS(ns, groups) {groups, {TILE_ROW(ns, 1), TILE_ROW(ns, 2), TILE_ROW(ns, 3), TILE_ROW(ns, 4)}}
+
+/* AVX2 has room for one group per tile (8 accumulators), VNNI for four (16) */
+const TileKernels scalarTiles = TILE_KERNELS(scalar, 1);
+#ifdef QUANT_X86
+const TileKernels avx2Tiles = TILE_KERNELS(avx2, 1);
+const TileKernels vnniTiles = TILE_KERNELS(vnni, 4);
+#endif
+
+#undef TILE_KERNELS
+#undef TILE_ROW
+
+const TileKernels& selectTiles() {
+#ifdef QUANT_X86
+	if (hasVnni()) {
+		return vnniTiles;
+	}
+	if (simd::activeIsa() == simd::Isa::AVX2 || simd::activeIsa() == simd::Isa::AVX512) {
+		return avx2Tiles;
+	}
+#endif
+	return scalarTiles;
+}
+
+/**
+ * Run the integer GEMM tile by tile, handing every finished tile to sink
+ *
+ * sink(m0, rows, n0, width, acc, ldAcc) receives the accumulators of rows
+ * m0.. and columns n0.. (width may run past the real output count).
+ * Column groups are spread over the worker pool for large products.
+ */
+template <typename Sink>
+void forEachTile(size_t M, const uint8_t* a, const PackedWeights& weights, const Sink& sink) {
+	const TileKernels& kernels = selectTiles();
+	size_t lda = weights.stride();
+	size_t kSteps = lda / KR;
+	size_t groups = (weights.outputs() + NR - 1) / NR;
+	size_t units = (groups + kernels.groups - 1) / kernels.groups;
+
+	auto unit = [&](size_t u) {
+		size_t g = u * kernels.groups;
+		size_t gb = std::min(kernels.groups, groups - g);
+		const int8_t* panel = weights.codes() + g * kSteps * GROUP_BYTES;
+		int32_t acc[MR * MAX_GROUPS * NR];
+		for (size_t m0 = 0; m0 < M; m0 += MR) {
+			size_t rows = std::min(MR, M - m0);
+			kernels.tiles[rows - 1][gb - 1](kSteps, a + m0 * lda, lda, panel, acc);
+			sink(m0, rows, g * NR, gb * NR, acc, gb * NR);
+		}
+	};
+
+	size_t ops = M * weights.outputs() * lda;
+	size_t threads = (ops >= PARALLEL_QUANT_OPS) ? parallel::getNumThreads() : 1;
+	if (threads <= 1 || units <= 1) {
+		for (size_t u = 0; u < units; u++) {
+			unit(u);
+		}
+	} else {
+		parallel::parallelFor(units, unit);
+	}
+}
+
+}
+
+PackedWeights::PackedWeights() : rows(0), cols(0), paddedCols(0) {}
+
+template <typename T>
+PackedWeights::PackedWeights(const T* weights, size_t rows, size_t cols)
+	: rows(rows), cols(cols), paddedCols((cols + KR - 1) / KR * KR),
+	  data((rows + NR - 1) / NR * paddedCols * NR, 0), scales(rows), sums(rows, 0) {
+
+	size_t kSteps = paddedCols / KR;
+	for (size_t n = 0; n < rows; n++) {
+		const T* row = weights + n * cols;
+		float maxAbs = 0.0f;
+		for (size_t k = 0; k < cols; k++) {
+			maxAbs = std::max(maxAbs, std::abs(static_cast<float>(row[k])));
+		}
+		scales[n] = (maxAbs > 0.0f) ? maxAbs / 127.0f : 1.0f;
+
+		float inverse = 1.0f / scales[n];
+		int8_t* group = data.data() + (n / NR) * kSteps * GROUP_BYTES + (n % NR) * KR;
+		for (size_t k = 0; k < cols; k++) {
+			float code = std::nearbyint(static_cast<float>(row[k]) * inverse);
+			int8_t q = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, code)));
+			group[(k / KR) * GROUP_BYTES + k % KR] = q;
+			sums[n] += q;
+		}
+	}
+}
+
+size_t PackedWeights::memoryBytes() const {
+	return data.size() * sizeof(int8_t) + scales.size() * sizeof(float) + sums.size() * sizeof(int32_t);
+}
+
+template <typename T>
+QuantParams quantize(const T* x, size_t rows, size_t cols, uint8_t* out, size_t stride) {
+	float lo = 0.0f;
+	float hi = 0.0f;
+	for (size_t i = 0; i < rows * cols; i++) {
+		float v = static_cast<float>(x[i]);
+		lo = std::min(lo, v);
+		hi = std::max(hi, v);
+	}
+
+	QuantParams params;
+	params.scale = (hi > lo) ? (hi - lo) / 255.0f : 1.0f;
+	params.zeroPoint = static_cast<int32_t>(std::nearbyint(-lo / params.scale));
+	params.zeroPoint = std::min(255, std::max(0, params.zeroPoint));
+
+	float inverse = 1.0f / params.scale;
+	float zero = static_cast<float>(params.zeroPoint);
+	for (size_t i = 0; i < rows; i++) {
+		const T* row = x + i * cols;
+		uint8_t* codes = out + i * stride;
+		for (size_t k = 0; k < cols; k++) {
+			float code = std::nearbyint(static_cast<float>(row[k]) * inverse) + zero;
+			codes[k] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, code)));
+		}
+		std::fill(codes + cols, codes + stride, static_cast<uint8_t>(params.zeroPoint));
+	}
+	return params;
+}
+
+template <typename T>
+void gemm(size_t M, const uint8_t* a, QuantParams params, const PackedWeights& weights,
+          const T* bias, bool relu, T* out) {
+	size_t N = weights.outputs();
+	const float* scales = weights.channelScales();
+	const int32_t* sums = weights.channelSums();
+
+	/* (a - za) . w = a . w - za * sum(w), then scale, bias and clamp in one pass */
+	forEachTile(M, a, weights, [&](size_t m0, size_t rows, size_t n0, size_t width,
+	                               const int32_t* acc, size_t ldAcc) {
+		size_t end = std::min(N, n0 + width);
+		for (size_t r = 0; r < rows; r++) {
+			T* o = out + (m0 + r) * N;
+			const int32_t* tile = acc + r * ldAcc;
+			for (size_t n = n0; n < end; n++) {
+				int32_t dot = tile[n - n0] - params.zeroPoint * sums[n];
+				float y = params.scale * scales[n] * static_cast<float>(dot);
+				if (bias != nullptr) {
+					y += static_cast<float>(bias[n]);
+				}
+				o[n] = static_cast<T>((relu && y < 0.0f) ? 0.0f : y);
+			}
+		}
+	});
+}
+
+void gemmAccumulate(size_t M, const uint8_t* a, const PackedWeights& weights, int32_t* acc) {
+	size_t N = weights.outputs();
+	forEachTile(M, a, weights, [&](size_t m0, size_t rows, size_t n0, size_t width,
+	                               const int32_t* tile, size_t ldAcc) {
+		size_t end = std::min(N, n0 + width);
+		for (size_t r = 0; r < rows; r++) {
+			std::copy(tile + r * ldAcc, tile + r * ldAcc + (end - n0), acc + (m0 + r) * N + n0);
+		}
+	});
+}
+
+bool hasVnni() {
+#ifdef QUANT_X86
+	static const bool supported = __builtin_cpu_supports("avx512vnni");
+	return supported && simd::activeIsa() == simd::Isa::AVX512;
+#else
+	return false;
+#endif
+}
+
+template PackedWeights::PackedWeights(const double*, size_t, size_t);
+template PackedWeights::PackedWeights(const float*, size_t, size_t);
+template PackedWeights::PackedWeights(const bfloat16*, size_t, size_t);
+template QuantParams quantize<double>(const double*, size_t, size_t, uint8_t*, size_t);
+template QuantParams quantize<float>(const float*, size_t, size_t, uint8_t*, size_t);
+template QuantParams quantize<bfloat16>(const bfloat16*, size_t, size_t, uint8_t*, size_t);
+template void gemm<double>(size_t, const uint8_t*, QuantParams, const PackedWeights&, const double*, bool, double*);
+template void gemm<float>(size_t, const uint8_t*, QuantParams, const PackedWeights&, const float*, bool, float*);
+template void gemm<bfloat16>(size_t, const uint8_t*, QuantParams, const PackedWeights&, const bfloat16*, bool, bfloat16*);
+
+}
\ No newline at end of file
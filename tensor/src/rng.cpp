@@ -0,0 +1,261 @@
+/* rng.cpp */
+
+#include "../include/rng.hpp"
+#include "../include/parallel.hpp"
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+
+namespace rng {
+
+namespace {
+
+constexpr uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85;
+constexpr int PHILOX_ROUNDS = 10;
+
+/* Blocks generated side by side; the fixed trip count lets the compiler vectorize each round */
+constexpr size_t LANES = 16;
+
+/* Blocks handled by one task of a parallel fill */
+constexpr size_t BLOCKS_PER_TASK = 4096;
+
+/* Truncated normal draws are kept within this many standard deviations */
+constexpr double TRUNCATION = 2.0;
+
+constexpr double TWO_PI = 6.283185307179586476925286766559;
+
+void philoxLanes(uint32_t c[4][LANES], uint32_t k0, uint32_t k1) {
+	for (int r = 0; r < PHILOX_ROUNDS; r++) {
+		for (size_t l = 0; l < LANES; l++) {
+			uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c[0][l];
+			uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c[2][l];
+			uint32_t x0 = static_cast<uint32_t>(p1 >> 32) ^ c[1][l] ^ k0;
+			uint32_t x2 = static_cast<uint32_t>(p0 >> 32) ^ c[3][l] ^ k1;
+			c[1][l] = static_cast<uint32_t>(p1);
+			c[3][l] = static_cast<uint32_t>(p0);
+			c[0][l] = x0;
+			c[2][l] = x2;
+		}
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+}
+
+/**
+ * Values produced from one Philox block: four 24-bit or two 53-bit draws
+ */
+template <typename Acc>
+constexpr size_t VALUES_PER_BLOCK = std::is_same<Acc, double>::value ? 2 : 4;
+
+/**
+ * Convert the words of one block to uniforms in [0, 1)
+ */
+template <typename Acc>
+void toUniform(const uint32_t w[4], Acc* u) {
+	if constexpr (std::is_same<Acc, double>::value) {
+		for (size_t k = 0; k < 2; k++) {
+			uint64_t bits = (static_cast<uint64_t>(w[2 * k]) << 32) | w[2 * k + 1];
+			u[k] = static_cast<double>(bits >> 11) * 0x1.0p-53;
+		}
+	} else {
+		for (size_t k = 0; k < 4; k++) {
+			u[k] = static_cast<Acc>(w[k] >> 8) * Acc(0x1.0p-24);
+		}
+	}
+}
+
+/**
+ * Convert the words of one block to standard normals (Box-Muller)
+ */
+template <typename Acc>
+void toNormal(const uint32_t w[4], Acc* z) {
+	constexpr size_t V = VALUES_PER_BLOCK<Acc>;
+	Acc u[V];
+	toUniform<Acc>(w, u);
+	for (size_t k = 0; k < V; k += 2) {
+		Acc radius = std::sqrt(Acc(-2) * std::log(Acc(1) - u[k]));
+		Acc angle = static_cast<Acc>(TWO_PI) * u[k + 1];
+		z[k] = radius * std::cos(angle);
+		z[k + 1] = radius * std::sin(angle);
+	}
+}
+
+/**
+ * Fill out[0..n) from consecutive Philox blocks of one stream
+ *
+ * Block b uses the counter (b, stream, 0) and yields VALUES_PER_BLOCK
+ * values through emit(words, values, b). Large fills split their blocks
+ * over the worker pool; the result does not depend on the split.
+ */
+template <typename T, typename Emit>
+void fillBlocks(T* out, size_t n, uint64_t key, uint32_t stream, const Emit& emit) {
+	using Acc = typename ComputeType<T>::type;
+	constexpr size_t V = VALUES_PER_BLOCK<Acc>;
+
+	uint32_t k0 = static_cast<uint32_t>(key);
+	uint32_t k1 = static_cast<uint32_t>(key >> 32);
+	size_t blocks = (n + V - 1) / V;
+	size_t tasks = (blocks + BLOCKS_PER_TASK - 1) / BLOCKS_PER_TASK;
+
+	auto task = [&](size_t t) {
+		size_t first = t * BLOCKS_PER_TASK;
+		size_t last = std::min(blocks, first + BLOCKS_PER_TASK);
+		for (size_t g = first; g < last; g += LANES) {
+			uint32_t c[4][LANES];
+			for (size_t l = 0; l < LANES; l++) {
+				uint64_t b = g + l;
+				c[0][l] = static_cast<uint32_t>(b);
+				c[1][l] = static_cast<uint32_t>(b >> 32);
+				c[2][l] = stream;
+				c[3][l] = 0;
+			}
+			philoxLanes(c, k0, k1);
+
+			for (size_t l = 0; l < LANES && g + l < last; l++) {
+				size_t b = g + l;
+				uint32_t w[4] = {c[0][l], c[1][l], c[2][l], c[3][l]};
+				Acc values[V];
+				emit(w, values, b);
+				size_t count = std::min(V, n - b * V);
+				for (size_t k = 0; k < count; k++) {
+					out[b * V + k] = static_cast<T>(values[k]);
+				}
+			}
+		}
+	};
+
+	if (tasks > 1) {
+		parallel::parallelFor(tasks, task);
+	} else if (tasks == 1) {
+		task(0);
+	}
+}
+
+}
+
+void philox(uint32_t counter[4], const uint32_t key[2]) {
+	uint32_t c[4][LANES] = {};
+	for (size_t i = 0; i < 4; i++) {
+		c[i][0] = counter[i];
+	}
+	philoxLanes(c, key[0], key[1]);
+	for (size_t i = 0; i < 4; i++) {
+		counter[i] = c[i][0];
+	}
+}
+
+Generator::Generator(uint64_t seed) : key(seed), stream(0) {}
+
+void Generator::seed(uint64_t seed) {
+	key = seed;
+	stream = 0;
+}
+
+template <typename T>
+void Generator::uniform(BasicTensor<T>& tensor, double low, double high) {
+	using Acc = typename ComputeType<T>::type;
+
+	Acc base = static_cast<Acc>(low);
+	Acc range = static_cast<Acc>(high - low);
+	Span<T> data = tensor.getData();
+	fillBlocks(data.data(), data.size(), key, stream++, [&](const uint32_t* w, Acc* values, size_t) {
+		toUniform<Acc>(w, values);
+		for (size_t k = 0; k < VALUES_PER_BLOCK<Acc>; k++) {
+			values[k] = base + range * values[k];
+		}
+	});
+}
+
+template <typename T>
+void Generator::normal(BasicTensor<T>& tensor, double mean, double stddev) {
+	using Acc = typename ComputeType<T>::type;
+
+	Acc mu = static_cast<Acc>(mean);
+	Acc sigma = static_cast<Acc>(stddev);
+	Span<T> data = tensor.getData();
+	fillBlocks(data.data(), data.size(), key, stream++, [&](const uint32_t* w, Acc* values, size_t) {
+		toNormal<Acc>(w, values);
+		for (size_t k = 0; k < VALUES_PER_BLOCK<Acc>; k++) {
+			values[k] = mu + sigma * values[k];
+		}
+	});
+}
+
+template <typename T>
+void Generator::truncatedNormal(BasicTensor<T>& tensor, double mean, double stddev) {
+	using Acc = typename ComputeType<T>::type;
+	constexpr size_t V = VALUES_PER_BLOCK<Acc>;
+
+	Acc mu = static_cast<Acc>(mean);
+	Acc sigma = static_cast<Acc>(stddev);
+	uint32_t fill = stream++;
+	uint32_t keyWords[2] = {static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32)};
+	Span<T> data = tensor.getData();
+
+	/* A rejected value is redrawn from the same block with the last counter word as attempt number */
+	fillBlocks(data.data(), data.size(), key, fill, [&](const uint32_t* w, Acc* values, size_t b) {
+		toNormal<Acc>(w, values);
+		for (size_t k = 0; k < V; k++) {
+			for (uint32_t attempt = 1; std::abs(values[k]) > static_cast<Acc>(TRUNCATION); attempt++) {
+				uint32_t retry[4] = {static_cast<uint32_t>(b), static_cast<uint32_t>(static_cast<uint64_t>(b) >> 32),
+				                     fill, attempt};
+				philox(retry, keyWords);
+				Acc redraw[V];
+				toNormal<Acc>(retry, redraw);
+				values[k] = redraw[k];
+			}
+			values[k] = mu + sigma * values[k];
+		}
+	});
+}
+
+template <typename T>
+void Generator::xavierUniform(BasicTensor<T>& weights, size_t fanIn, size_t fanOut) {
+	double limit = std::sqrt(6.0 / static_cast<double>(fanIn + fanOut));
+	uniform(weights, -limit, limit);
+}
+
+template <typename T>
+void Generator::xavierNormal(BasicTensor<T>& weights, size_t fanIn, size_t fanOut) {
+	normal(weights, 0.0, std::sqrt(2.0 / static_cast<double>(fanIn + fanOut)));
+}
+
+template <typename T>
+void Generator::heUniform(BasicTensor<T>& weights, size_t fanIn) {
+	double limit = std::sqrt(6.0 / static_cast<double>(fanIn));
+	uniform(weights, -limit, limit);
+}
+
+template <typename T>
+void Generator::heNormal(BasicTensor<T>& weights, size_t fanIn) {
+	normal(weights, 0.0, std::sqrt(2.0 / static_cast<double>(fanIn)));
+}
+
+Generator& defaultGenerator() {
+	static Generator instance;
+	return instance;
+}
+
+void manualSeed(uint64_t seed) {
+	defaultGenerator().seed(seed);
+}
+
+#define INSTANTIATE_FILLS(T) \
+	template void Generator::uniform<T>(BasicTensor<T>&, double, double); \
+	template void Generator::normal<T>(BasicTensor<T>&, double, double); \
+	template void Generator::truncatedNormal<T>(BasicTensor<T>&, double, double); \
+	template void Generator::xavierUniform<T>(BasicTensor<T>&, size_t, size_t); \
+	template void Generator::xavierNormal<T>(BasicTensor<T>&, size_t, size_t); \
+	template void Generator::heUniform<T>(BasicTensor<T>&, size_t); \
+	template void Generator::heNormal<T>(BasicTensor<T>&, size_t);
+
+INSTANTIATE_FILLS(double)
+INSTANTIATE_FILLS(float)
+INSTANTIATE_FILLS(bfloat16)
+
+#undef INSTANTIATE_FILLS
+
+}
\ No newline at end of file
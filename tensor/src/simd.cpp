@@ -0,0 +1,617 @@
+/* simd.cpp */
+
+#include "../include/simd.hpp"
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+/* Portable fallback: one element per "vector" */
+namespace scalar {
+
+template <typename T> constexpr size_t WIDTH = 1;
+
+template <typename T> inline T vload(const T* p) { return *p; }
+template <typename T> inline void vstore(T* p, T v) { *p = v; }
+template <typename T> inline T vset1(T v) { return v; }
+template <typename T> inline T vadd(T a, T b) { return a + b; }
+template <typename T> inline T vsub(T a, T b) { return a - b; }
+template <typename T> inline T vmul(T a, T b) { return a * b; }
+template <typename T> inline T vdiv(T a, T b) { return a / b; }
+template <typename T> inline T vmax(T a, T b) { return a > b ? a : b; }
+template <typename T> inline T vmulAdd(T a, T b, T c) { return a * b + c; }
+template <typename T> inline T vselectPositive(T x, T v) { return x > T(0) ? v : T(0); }
+template <typename T> inline T vselectGreater(T a, T b, T x, T y) { return a > b ? x : y; }
+
+template <typename T> constexpr size_t TILE = 1;
+template <typename T> inline void transposeTile(const T* src, size_t, T* dst, size_t) { *dst = *src; }
+
+#include "simd_kernels.inc"
+
+}
+
+#ifdef SIMD_X86
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+namespace sse2 {
+
+template <typename T> constexpr size_t WIDTH = 16 / sizeof(T);
+
+inline __m128d vload(const double* p) { return _mm_loadu_pd(p); }
+inline void vstore(double* p, __m128d v) { _mm_storeu_pd(p, v); }
+inline __m128d vset1(double v) { return _mm_set1_pd(v); }
+inline __m128d vadd(__m128d a, __m128d b) { return _mm_add_pd(a, b); }
+inline __m128d vsub(__m128d a, __m128d b) { return _mm_sub_pd(a, b); }
+inline __m128d vmul(__m128d a, __m128d b) { return _mm_mul_pd(a, b); }
+inline __m128d vdiv(__m128d a, __m128d b) { return _mm_div_pd(a, b); }
+inline __m128d vmax(__m128d a, __m128d b) { return _mm_max_pd(a, b); }
+inline __m128d vmulAdd(__m128d a, __m128d b, __m128d c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+inline __m128d vselectPositive(__m128d x, __m128d v) {
+	return _mm_and_pd(_mm_cmpgt_pd(x, _mm_setzero_pd()), v);
+}
+inline __m128d vselectGreater(__m128d a, __m128d b, __m128d x, __m128d y) {
+	__m128d mask = _mm_cmpgt_pd(a, b);
+	return _mm_or_pd(_mm_and_pd(mask, x), _mm_andnot_pd(mask, y));
+}
+
+inline __m128 vload(const float* p) { return _mm_loadu_ps(p); }
+inline void vstore(float* p, __m128 v) { _mm_storeu_ps(p, v); }
+inline __m128 vset1(float v) { return _mm_set1_ps(v); }
+inline __m128 vadd(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+inline __m128 vsub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+inline __m128 vmul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+inline __m128 vdiv(__m128 a, __m128 b) { return _mm_div_ps(a, b); }
+inline __m128 vmax(__m128 a, __m128 b) { return _mm_max_ps(a, b); }
+inline __m128 vmulAdd(__m128 a, __m128 b, __m128 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline __m128 vselectPositive(__m128 x, __m128 v) {
+	return _mm_and_ps(_mm_cmpgt_ps(x, _mm_setzero_ps()), v);
+}
+inline __m128 vselectGreater(__m128 a, __m128 b, __m128 x, __m128 y) {
+	__m128 mask = _mm_cmpgt_ps(a, b);
+	return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+}
+
+template <typename T> constexpr size_t TILE = WIDTH<T>;
+
+inline void transposeTile(const double* src, size_t ldSrc, double* dst, size_t ldDst) {
+	__m128d r0 = _mm_loadu_pd(src);
+	__m128d r1 = _mm_loadu_pd(src + ldSrc);
+	_mm_storeu_pd(dst, _mm_unpacklo_pd(r0, r1));
+	_mm_storeu_pd(dst + ldDst, _mm_unpackhi_pd(r0, r1));
+}
+
+inline void transposeTile(const float* src, size_t ldSrc, float* dst, size_t ldDst) {
+	__m128 r0 = _mm_loadu_ps(src);
+	__m128 r1 = _mm_loadu_ps(src + ldSrc);
+	__m128 r2 = _mm_loadu_ps(src + 2 * ldSrc);
+	__m128 r3 = _mm_loadu_ps(src + 3 * ldSrc);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	_mm_storeu_ps(dst, r0);
+	_mm_storeu_ps(dst + ldDst, r1);
+	_mm_storeu_ps(dst + 2 * ldDst, r2);
+	_mm_storeu_ps(dst + 3 * ldDst, r3);
+}
+
+#include "simd_kernels.inc"
+
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace avx2 {
+
+template <typename T> constexpr size_t WIDTH = 32 / sizeof(T);
+
+inline __m256d vload(const double* p) { return _mm256_loadu_pd(p); }
+inline void vstore(double* p, __m256d v) { _mm256_storeu_pd(p, v); }
+inline __m256d vset1(double v) { return _mm256_set1_pd(v); }
+inline __m256d vadd(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+inline __m256d vsub(__m256d a, __m256d b) { return _mm256_sub_pd(a, b); }
+inline __m256d vmul(__m256d a, __m256d b) { return _mm256_mul_pd(a, b); }
+inline __m256d vdiv(__m256d a, __m256d b) { return _mm256_div_pd(a, b); }
+inline __m256d vmax(__m256d a, __m256d b) { return _mm256_max_pd(a, b); }
+inline __m256d vmulAdd(__m256d a, __m256d b, __m256d c) { return _mm256_fmadd_pd(a, b, c); }
+inline __m256d vselectPositive(__m256d x, __m256d v) {
+	return _mm256_and_pd(_mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ), v);
+}
+inline __m256d vselectGreater(__m256d a, __m256d b, __m256d x, __m256d y) {
+	return _mm256_blendv_pd(y, x, _mm256_cmp_pd(a, b, _CMP_GT_OQ));
+}
+
+inline __m256 vload(const float* p) { return _mm256_loadu_ps(p); }
+inline void vstore(float* p, __m256 v) { _mm256_storeu_ps(p, v); }
+inline __m256 vset1(float v) { return _mm256_set1_ps(v); }
+inline __m256 vadd(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+inline __m256 vsub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+inline __m256 vmul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+inline __m256 vdiv(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+inline __m256 vmax(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+inline __m256 vmulAdd(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+inline __m256 vselectPositive(__m256 x, __m256 v) {
+	return _mm256_and_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ), v);
+}
+inline __m256 vselectGreater(__m256 a, __m256 b, __m256 x, __m256 y) {
+	return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_GT_OQ));
+}
+
+template <typename T> constexpr size_t TILE = WIDTH<T>;
+
+inline void transposeTile(const double* src, size_t ldSrc, double* dst, size_t ldDst) {
+	__m256d r0 = _mm256_loadu_pd(src);
+	__m256d r1 = _mm256_loadu_pd(src + ldSrc);
+	__m256d r2 = _mm256_loadu_pd(src + 2 * ldSrc);
+	__m256d r3 = _mm256_loadu_pd(src + 3 * ldSrc);
+	__m256d t0 = _mm256_unpacklo_pd(r0, r1);
+	__m256d t1 = _mm256_unpackhi_pd(r0, r1);
+	__m256d t2 = _mm256_unpacklo_pd(r2, r3);
+	__m256d t3 = _mm256_unpackhi_pd(r2, r3);
+	_mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+	_mm256_storeu_pd(dst + ldDst, _mm256_permute2f128_pd(t1, t3, 0x20));
+	_mm256_storeu_pd(dst + 2 * ldDst, _mm256_permute2f128_pd(t0, t2, 0x31));
+	_mm256_storeu_pd(dst + 3 * ldDst, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+inline void transposeTile(const float* src, size_t ldSrc, float* dst, size_t ldDst) {
+	__m256 r[8];
+	for (size_t i = 0; i < 8; i++) {
+		r[i] = _mm256_loadu_ps(src + i * ldSrc);
+	}
+	__m256 t[8];
+	for (size_t i = 0; i < 8; i += 2) {
+		t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+		t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+	}
+	__m256 s[8];
+	for (size_t i = 0; i < 8; i += 4) {
+		s[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+		s[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+		s[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+		s[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+	}
+	for (size_t i = 0; i < 4; i++) {
+		_mm256_storeu_ps(dst + i * ldDst, _mm256_permute2f128_ps(s[i], s[i + 4], 0x20));
+		_mm256_storeu_ps(dst + (i + 4) * ldDst, _mm256_permute2f128_ps(s[i], s[i + 4], 0x31));
+	}
+}
+
+#include "simd_kernels.inc"
+
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace avx512 {
+
+template <typename T> constexpr size_t WIDTH = 64 / sizeof(T);
+
+inline __m512d vload(const double* p) { return _mm512_loadu_pd(p); }
+inline void vstore(double* p, __m512d v) { _mm512_storeu_pd(p, v); }
+inline __m512d vset1(double v) { return _mm512_set1_pd(v); }
+inline __m512d vadd(__m512d a, __m512d b) { return _mm512_add_pd(a, b); }
+inline __m512d vsub(__m512d a, __m512d b) { return _mm512_sub_pd(a, b); }
+inline __m512d vmul(__m512d a, __m512d b) { return _mm512_mul_pd(a, b); }
+inline __m512d vdiv(__m512d a, __m512d b) { return _mm512_div_pd(a, b); }
+inline __m512d vmax(__m512d a, __m512d b) { return _mm512_maskz_max_pd(0xFF, a, b); }
+inline __m512d vmulAdd(__m512d a, __m512d b, __m512d c) { return _mm512_fmadd_pd(a, b, c); }
+inline __m512d vselectPositive(__m512d x, __m512d v) {
+	return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_GT_OQ), v);
+}
+inline __m512d vselectGreater(__m512d a, __m512d b, __m512d x, __m512d y) {
+	return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), y, x);
+}
+
+inline __m512 vload(const float* p) { return _mm512_loadu_ps(p); }
+inline void vstore(float* p, __m512 v) { _mm512_storeu_ps(p, v); }
+inline __m512 vset1(float v) { return _mm512_set1_ps(v); }
+inline __m512 vadd(__m512 a, __m512 b) { return _mm512_add_ps(a, b); }
+inline __m512 vsub(__m512 a, __m512 b) { return _mm512_sub_ps(a, b); }
+inline __m512 vmul(__m512 a, __m512 b) { return _mm512_mul_ps(a, b); }
+inline __m512 vdiv(__m512 a, __m512 b) { return _mm512_div_ps(a, b); }
+inline __m512 vmax(__m512 a, __m512 b) { return _mm512_maskz_max_ps(0xFFFF, a, b); }
+inline __m512 vmulAdd(__m512 a, __m512 b, __m512 c) { return _mm512_fmadd_ps(a, b, c); }
+inline __m512 vselectPositive(__m512 x, __m512 v) {
+	return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GT_OQ), v);
+}
+inline __m512 vselectGreater(__m512 a, __m512 b, __m512 x, __m512 y) {
+	return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), y, x);
+}
+
+/* 256-bit tiles: the shuffle network gains little from wider registers */
+template <typename T> constexpr size_t TILE = avx2::TILE<T>;
+using avx2::transposeTile;
+
+#include "simd_kernels.inc"
+
+}
+#pragma GCC pop_options
+
+#endif
+
+namespace {
+
+/**
+ * Entry points of one instruction set's kernels for element type T
+ */
+template <typename T>
+struct KernelTable {
+	void (*add)(const T*, const T*, T*, size_t);
+	void (*sub)(const T*, const T*, T*, size_t);
+	void (*mul)(const T*, const T*, T*, size_t);
+	void (*div)(const T*, const T*, T*, size_t);
+	void (*scale)(const T*, T, T*, size_t);
+	void (*fill)(T*, T, size_t);
+	void (*maximum)(const T*, const T*, T*, size_t);
+	void (*maxUpdate)(const T*, T, T*, T*, size_t);
+	void (*axpy)(T, const T*, T*, size_t);
+	void (*axpby)(T, const T*, T, T*, size_t);
+	void (*relu)(const T*, T*, size_t);
+	void (*reluBackward)(const T*, const T*, T*, size_t);
+	void (*sigmoidBackward)(const T*, const T*, T*, size_t);
+	void (*tanhBackward)(const T*, const T*, T*, size_t);
+	void (*transpose)(const T*, size_t, size_t, size_t, T*, size_t);
+	T (*reduceSum)(const T*, size_t);
+	T (*reduceMax)(const T*, size_t);
+};
+
+#define KERNEL_TABLE(ns, T) { \
+	ns::add<T>, ns::sub<T>, ns::mul<T>, ns::div<T>, ns::scale<T>, ns::fill<T>, ns::maximum<T>, ns::maxUpdate<T>, \
+	ns::axpy<T>, ns::axpby<T>, ns::relu<T>, ns::reluBackward<T>, ns::sigmoidBackward<T>, ns::tanhBackward<T>, \
+	ns::transpose<T>, ns::reduceSum<T>, ns::reduceMax<T> \
+}
+
+/**
+ * Kernel tables for every native element type of one instruction set
+ */
+struct IsaKernels {
+	KernelTable<double> f64;
+	KernelTable<float> f32;
+};
+
+const IsaKernels scalarKernels = {KERNEL_TABLE(scalar, double), KERNEL_TABLE(scalar, float)};
+#ifdef SIMD_X86
+const IsaKernels sse2Kernels = {KERNEL_TABLE(sse2, double), KERNEL_TABLE(sse2, float)};
+const IsaKernels avx2Kernels = {KERNEL_TABLE(avx2, double), KERNEL_TABLE(avx2, float)};
+const IsaKernels avx512Kernels = {KERNEL_TABLE(avx512, double), KERNEL_TABLE(avx512, float)};
+#endif
+
+#undef KERNEL_TABLE
+
+const IsaKernels* kernelsFor(Isa isa) {
+	switch (isa) {
+#ifdef SIMD_X86
+		case Isa::AVX512:
+			return &avx512Kernels;
+		case Isa::AVX2:
+			return &avx2Kernels;
+		case Isa::SSE2:
+			return &sse2Kernels;
+#endif
+		default:
+			return &scalarKernels;
+	}
+}
+
+struct Dispatch {
+	Isa isa;
+	const IsaKernels* kernels;
+};
+
+Dispatch& dispatch() {
+	static Dispatch current = {detectIsa(), kernelsFor(detectIsa())};
+	return current;
+}
+
+template <typename T> const KernelTable<T>& kernels();
+template <> const KernelTable<double>& kernels<double>() { return dispatch().kernels->f64; }
+template <> const KernelTable<float>& kernels<float>() { return dispatch().kernels->f32; }
+
+/* bfloat16 arrays are processed through float buffers of this many elements */
+constexpr size_t BF16_CHUNK = 256;
+
+void widen(const bfloat16* src, float* dst, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		dst[i] = static_cast<float>(src[i]);
+	}
+}
+
+void narrow(const float* src, bfloat16* dst, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		dst[i] = bfloat16(src[i]);
+	}
+}
+
+/**
+ * Run a one-input float kernel over bfloat16 data chunk by chunk
+ *
+ * kernel: Callable taking (in, out, count) float pointers
+ */
+template <typename Kernel>
+void unaryThroughFloat(const bfloat16* x, bfloat16* out, size_t n, Kernel kernel) {
+	float buffer[BF16_CHUNK];
+	for (size_t i = 0; i < n; i += BF16_CHUNK) {
+		size_t m = std::min(BF16_CHUNK, n - i);
+		widen(x + i, buffer, m);
+		kernel(buffer, buffer, m);
+		narrow(buffer, out + i, m);
+	}
+}
+
+/**
+ * Run a two-input float kernel over bfloat16 data chunk by chunk
+ *
+ * kernel: Callable taking (a, b, out, count) float pointers
+ */
+template <typename Kernel>
+void binaryThroughFloat(const bfloat16* a, const bfloat16* b, bfloat16* out, size_t n, Kernel kernel) {
+	float bufferA[BF16_CHUNK];
+	float bufferB[BF16_CHUNK];
+	for (size_t i = 0; i < n; i += BF16_CHUNK) {
+		size_t m = std::min(BF16_CHUNK, n - i);
+		widen(a + i, bufferA, m);
+		widen(b + i, bufferB, m);
+		kernel(bufferA, bufferB, bufferA, m);
+		narrow(bufferA, out + i, m);
+	}
+}
+
+template <typename T>
+constexpr bool isBFloat16 = std::is_same<T, bfloat16>::value;
+
+}
+
+Isa detectIsa() {
+#ifdef SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		return Isa::AVX512;
+	}
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		return Isa::AVX2;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		return Isa::SSE2;
+	}
+#endif
+	return Isa::Scalar;
+}
+
+Isa activeIsa() {
+	return dispatch().isa;
+}
+
+bool setIsa(Isa isa) {
+	if (static_cast<int>(isa) > static_cast<int>(detectIsa())) {
+		return false;
+	}
+	dispatch() = {isa, kernelsFor(isa)};
+	return true;
+}
+
+const char* isaName(Isa isa) {
+	switch (isa) {
+		case Isa::SSE2:
+			return "sse2";
+		case Isa::AVX2:
+			return "avx2";
+		case Isa::AVX512:
+			return "avx512";
+		default:
+			return "scalar";
+	}
+}
+
+template <typename T>
+void add(const T* a, const T* b, T* out, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		binaryThroughFloat(a, b, out, n, kernels<float>().add);
+	} else {
+		kernels<T>().add(a, b, out, n);
+	}
+}
+
+template <typename T>
+void sub(const T* a, const T* b, T* out, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		binaryThroughFloat(a, b, out, n, kernels<float>().sub);
+	} else {
+		kernels<T>().sub(a, b, out, n);
+	}
+}
+
+template <typename T>
+void mul(const T* a, const T* b, T* out, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		binaryThroughFloat(a, b, out, n, kernels<float>().mul);
+	} else {
+		kernels<T>().mul(a, b, out, n);
+	}
+}
+
+template <typename T>
+void div(const T* a, const T* b, T* out, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		binaryThroughFloat(a, b, out, n, kernels<float>().div);
+	} else {
+		kernels<T>().div(a, b, out, n);
+	}
+}
+
+template <typename T>
+void scale(const T* a, T scalar, T* out, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		float s = scalar;
+		unaryThroughFloat(a, out, n, [s](const float* x, float* y, size_t m) {
+			kernels<float>().scale(x, s, y, m);
+		});
+	} else {
+		kernels<T>().scale(a, scalar, out, n);
+	}
+}
+
+template <typename T>
+void fill(T* out, T value, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		std::fill(out, out + n, value);
+	} else {
+		kernels<T>().fill(out, value, n);
+	}
+}
+
+template <typename T>
+void maximum(const T* a, const T* b, T* out, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		binaryThroughFloat(a, b, out, n, kernels<float>().maximum);
+	} else {
+		kernels<T>().maximum(a, b, out, n);
+	}
+}
+
+template <typename T>
+void maxUpdate(const T* x, T tag, T* best, T* index, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		for (size_t i = 0; i < n; i++) {
+			if (static_cast<float>(x[i]) > static_cast<float>(best[i])) {
+				best[i] = x[i];
+				index[i] = tag;
+			}
+		}
+	} else {
+		kernels<T>().maxUpdate(x, tag, best, index, n);
+	}
+}
+
+template <typename T>
+void axpy(T alpha, const T* x, T* y, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		float a = alpha;
+		binaryThroughFloat(y, x, y, n, [a](const float* fy, const float* fx, float* out, size_t m) {
+			std::copy(fy, fy + m, out);
+			kernels<float>().axpy(a, fx, out, m);
+		});
+	} else {
+		kernels<T>().axpy(alpha, x, y, n);
+	}
+}
+
+template <typename T>
+void axpby(T alpha, const T* x, T beta, T* y, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		float a = alpha;
+		float b = beta;
+		binaryThroughFloat(y, x, y, n, [a, b](const float* fy, const float* fx, float* out, size_t m) {
+			std::copy(fy, fy + m, out);
+			kernels<float>().axpby(a, fx, b, out, m);
+		});
+	} else {
+		kernels<T>().axpby(alpha, x, beta, y, n);
+	}
+}
+
+template <typename T>
+void relu(const T* x, T* out, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		unaryThroughFloat(x, out, n, kernels<float>().relu);
+	} else {
+		kernels<T>().relu(x, out, n);
+	}
+}
+
+template <typename T>
+void reluBackward(const T* x, const T* grad, T* out, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		binaryThroughFloat(x, grad, out, n, kernels<float>().reluBackward);
+	} else {
+		kernels<T>().reluBackward(x, grad, out, n);
+	}
+}
+
+template <typename T>
+void sigmoidBackward(const T* s, const T* grad, T* out, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		binaryThroughFloat(s, grad, out, n, kernels<float>().sigmoidBackward);
+	} else {
+		kernels<T>().sigmoidBackward(s, grad, out, n);
+	}
+}
+
+template <typename T>
+void tanhBackward(const T* t, const T* grad, T* out, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		binaryThroughFloat(t, grad, out, n, kernels<float>().tanhBackward);
+	} else {
+		kernels<T>().tanhBackward(t, grad, out, n);
+	}
+}
+
+template <typename T>
+void transpose(const T* src, size_t rows, size_t cols, size_t ldSrc, T* dst, size_t ldDst) {
+	if constexpr (isBFloat16<T>) {
+		scalar::transpose(src, rows, cols, ldSrc, dst, ldDst);
+	} else {
+		kernels<T>().transpose(src, rows, cols, ldSrc, dst, ldDst);
+	}
+}
+
+template <typename T>
+typename ComputeType<T>::type reduceSum(const T* x, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		float buffer[BF16_CHUNK];
+		float total = 0.0f;
+		for (size_t i = 0; i < n; i += BF16_CHUNK) {
+			size_t m = std::min(BF16_CHUNK, n - i);
+			widen(x + i, buffer, m);
+			total += kernels<float>().reduceSum(buffer, m);
+		}
+		return total;
+	} else {
+		return kernels<T>().reduceSum(x, n);
+	}
+}
+
+template <typename T>
+T reduceMax(const T* x, size_t n) {
+	if constexpr (isBFloat16<T>) {
+		float best = static_cast<float>(x[0]);
+		for (size_t i = 1; i < n; i++) {
+			best = std::max(best, static_cast<float>(x[i]));
+		}
+		return bfloat16(best);
+	} else {
+		return kernels<T>().reduceMax(x, n);
+	}
+}
+
+#define INSTANTIATE_KERNELS(T) \
+	template void add<T>(const T*, const T*, T*, size_t); \
+	template void sub<T>(const T*, const T*, T*, size_t); \
+	template void mul<T>(const T*, const T*, T*, size_t); \
+	template void div<T>(const T*, const T*, T*, size_t); \
+	template void scale<T>(const T*, T, T*, size_t); \
+	template void fill<T>(T*, T, size_t); \
+	template void maximum<T>(const T*, const T*, T*, size_t); \
+	template void maxUpdate<T>(const T*, T, T*, T*, size_t); \
+	template void axpy<T>(T, const T*, T*, size_t); \
+	template void axpby<T>(T, const T*, T, T*, size_t); \
+	template void relu<T>(const T*, T*, size_t); \
+	template void reluBackward<T>(const T*, const T*, T*, size_t); \
+	template void sigmoidBackward<T>(const T*, const T*, T*, size_t); \
+	template void tanhBackward<T>(const T*, const T*, T*, size_t); \
+	template void transpose<T>(const T*, size_t, size_t, size_t, T*, size_t); \
+	template typename ComputeType<T>::type reduceSum<T>(const T*, size_t); \
+	template T reduceMax<T>(const T*, size_t);
+
+INSTANTIATE_KERNELS(double)
+INSTANTIATE_KERNELS(float)
+INSTANTIATE_KERNELS(bfloat16)
+
+#undef INSTANTIATE_KERNELS
+
+}
\ No newline at end of file
@@ -0,0 +1,276 @@
+/* sparse.cpp */
+
+#include "../include/sparse.hpp"
+#include "../include/parallel.hpp"
+#include "../include/simd.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+/* Products with fewer multiply-adds than this stay on the calling thread */
+constexpr size_t PARALLEL_SPARSE_FLOPS = size_t(1) << 16;
+
+/* Marks a column that no entry touches */
+constexpr size_t UNTOUCHED = static_cast<size_t>(-1);
+
+/**
+ * Run body(first, last) over row ranges, in parallel for large products
+ */
+template <typename Body>
+void forEachRowRange(size_t rows, size_t work, const Body& body) {
+	size_t threads = (work >= PARALLEL_SPARSE_FLOPS) ? parallel::getNumThreads() : 1;
+	if (threads <= 1 || rows <= 1) {
+		body(0, rows);
+		return;
+	}
+
+	size_t tasks = std::min(rows, threads * 4);
+	parallel::parallelFor(tasks, [&](size_t t) {
+		body(t * rows / tasks, (t + 1) * rows / tasks);
+	});
+}
+
+void checkMatrix(const Shape& shape, size_t rows, size_t cols) {
+	if (shape.size() != 2 || shape[0] != rows || shape[1] != cols) {
+		throw TensorDismatchError();
+	}
+}
+
+}
+
+template <typename T>
+BasicSparseTensor<T>::BasicSparseTensor(size_t rows, size_t cols)
+	: numRows(rows), numCols(cols), rowPtr(rows + 1, 0) {}
+
+template <typename T>
+BasicSparseTensor<T>::BasicSparseTensor(size_t rows, size_t cols, std::vector<size_t> rowPtr,
+                                        std::vector<size_t> colIndex, std::vector<T> values)
+	: numRows(rows), numCols(cols), rowPtr(std::move(rowPtr)),
+	  colIndex(std::move(colIndex)), values(std::move(values)) {
+
+	if (this->rowPtr.size() != rows + 1 || this->rowPtr[0] != 0 ||
+	    this->rowPtr[rows] != this->colIndex.size() || this->colIndex.size() != this->values.size()) {
+		throw TensorDismatchError();
+	}
+	for (size_t i = 0; i < rows; i++) {
+		if (this->rowPtr[i] > this->rowPtr[i + 1]) {
+			throw TensorDismatchError();
+		}
+		for (size_t p = this->rowPtr[i]; p < this->rowPtr[i + 1]; p++) {
+			if (this->colIndex[p] >= cols) {
+				throw IndexOutOfBoundsError();
+			}
+			if (p > this->rowPtr[i] && this->colIndex[p] <= this->colIndex[p - 1]) {
+				throw TensorDismatchError();
+			}
+		}
+	}
+}
+
+template <typename T>
+BasicSparseTensor<T> BasicSparseTensor<T>::fromCoo(size_t rows, size_t cols, const std::vector<size_t>& rowIndex,
+                                                   const std::vector<size_t>& colIndex, const std::vector<T>& values) {
+	size_t n = values.size();
+	if (rowIndex.size() != n || colIndex.size() != n) {
+		throw TensorDismatchError();
+	}
+
+	/* Counting sort by row, then sort and merge the columns of each row */
+	std::vector<size_t> start(rows + 1, 0);
+	for (size_t e = 0; e < n; e++) {
+		if (rowIndex[e] >= rows || colIndex[e] >= cols) {
+			throw IndexOutOfBoundsError();
+		}
+		start[rowIndex[e] + 1]++;
+	}
+	for (size_t i = 0; i < rows; i++) {
+		start[i + 1] += start[i];
+	}
+
+	std::vector<std::pair<size_t, T>> entries(n);
+	std::vector<size_t> next(start.begin(), start.end() - 1);
+	for (size_t e = 0; e < n; e++) {
+		entries[next[rowIndex[e]]++] = {colIndex[e], values[e]};
+	}
+
+	BasicSparseTensor result(rows, cols);
+	result.colIndex.reserve(n);
+	result.values.reserve(n);
+	for (size_t i = 0; i < rows; i++) {
+		std::sort(entries.begin() + start[i], entries.begin() + start[i + 1],
+		          [](const std::pair<size_t, T>& a, const std::pair<size_t, T>& b) { return a.first < b.first; });
+		size_t rowStart = result.colIndex.size();
+		for (size_t p = start[i]; p < start[i + 1]; p++) {
+			if (result.colIndex.size() > rowStart && result.colIndex.back() == entries[p].first) {
+				result.values.back() = static_cast<T>(result.values.back() + entries[p].second);
+			} else {
+				result.colIndex.push_back(entries[p].first);
+				result.values.push_back(entries[p].second);
+			}
+		}
+		result.rowPtr[i + 1] = result.colIndex.size();
+	}
+	return result;
+}
+
+template <typename T>
+BasicSparseTensor<T> BasicSparseTensor<T>::fromDense(const BasicTensor<T>& dense) {
+	if (dense.ndim() != 2) {
+		throw TensorDismatchError();
+	}
+
+	size_t rows = dense.getShape()[0];
+	size_t cols = dense.getShape()[1];
+	Span<const T> denseValues = dense.getData();
+	const T* data = denseValues.data();
+	BasicSparseTensor result(rows, cols);
+	for (size_t i = 0; i < rows; i++) {
+		for (size_t j = 0; j < cols; j++) {
+			if (data[i * cols + j] != T(0)) {
+				result.colIndex.push_back(j);
+				result.values.push_back(data[i * cols + j]);
+			}
+		}
+		result.rowPtr[i + 1] = result.colIndex.size();
+	}
+	return result;
+}
+
+template <typename T>
+BasicTensor<T> BasicSparseTensor<T>::toDense() const {
+	BasicTensor<T> result({numRows, numCols});
+	T* data = result.getData().data();
+	for (size_t i = 0; i < numRows; i++) {
+		for (size_t p = rowPtr[i]; p < rowPtr[i + 1]; p++) {
+			data[i * numCols + colIndex[p]] = values[p];
+		}
+	}
+	return result;
+}
+
+template <typename T>
+void BasicSparseTensor<T>::matmul(BasicTensor<T>& out, const BasicSparseTensor& a, const BasicTensor<T>& b,
+                                  T alpha, T beta, bool transB) {
+	if (b.ndim() != 2) {
+		throw TensorDismatchError();
+	}
+	size_t n = transB ? b.getShape()[0] : b.getShape()[1];
+	checkMatrix(b.getShape(), transB ? n : a.numCols, transB ? a.numCols : n);
+	checkMatrix(out.getShape(), a.numRows, n);
+
+	Span<const T> bValues = b.getData();
+	const T* B = bValues.data();
+	T* O = out.getData().data();
+	const size_t* cols = a.colIndex.data();
+	const T* vals = a.values.data();
+	using Acc = typename ComputeType<T>::type;
+
+	forEachRowRange(a.numRows, a.nnz() * n, [&](size_t first, size_t last) {
+		if (transB) {
+			/* Row j of b stays in cache while every row of a gathers from it */
+			for (size_t j = 0; j < n; j++) {
+				const T* row = B + j * a.numCols;
+				for (size_t i = first; i < last; i++) {
+					Acc sum = Acc(0);
+					for (size_t p = a.rowPtr[i]; p < a.rowPtr[i + 1]; p++) {
+						sum += static_cast<Acc>(vals[p]) * static_cast<Acc>(row[cols[p]]);
+					}
+					T* o = O + i * n + j;
+					Acc scaled = static_cast<Acc>(alpha) * sum;
+					*o = static_cast<T>((beta == T(0)) ? scaled : scaled + static_cast<Acc>(beta) * static_cast<Acc>(*o));
+				}
+			}
+			return;
+		}
+
+		for (size_t i = first; i < last; i++) {
+			T* o = O + i * n;
+			if (beta == T(0)) {
+				simd::fill(o, T(0), n);
+			} else if (beta != T(1)) {
+				simd::scale(o, beta, o, n);
+			}
+			for (size_t p = a.rowPtr[i]; p < a.rowPtr[i + 1]; p++) {
+				simd::axpy(static_cast<T>(static_cast<Acc>(alpha) * static_cast<Acc>(vals[p])), B + cols[p] * n, o, n);
+			}
+		}
+	});
+}
+
+template <typename T>
+void BasicSparseTensor<T>::transposeMatmul(BasicTensor<T>& out, const BasicTensor<T>& dense, const BasicSparseTensor& a) {
+	if (dense.ndim() != 2 || dense.getShape()[0] != a.numRows) {
+		throw TensorDismatchError();
+	}
+	size_t m = dense.getShape()[1];
+	checkMatrix(out.getShape(), m, a.numCols);
+
+	/* Give every touched column a slot in a compact buffer */
+	std::vector<size_t> slot(a.numCols, UNTOUCHED);
+	std::vector<size_t> touched;
+	for (size_t p = 0; p < a.nnz(); p++) {
+		size_t k = a.colIndex[p];
+		if (slot[k] == UNTOUCHED) {
+			slot[k] = touched.size();
+			touched.push_back(k);
+		}
+	}
+
+	/* Accumulate column k of the result as a contiguous run of m values */
+	Span<const T> denseValues = dense.getData();
+	const T* D = denseValues.data();
+	std::vector<T> columns(touched.size() * m, T(0));
+	for (size_t i = 0; i < a.numRows; i++) {
+		for (size_t p = a.rowPtr[i]; p < a.rowPtr[i + 1]; p++) {
+			simd::axpy(a.values[p], D + i * m, columns.data() + slot[a.colIndex[p]] * m, m);
+		}
+	}
+
+	T* O = out.getData().data();
+	simd::fill(O, T(0), out.size());
+	for (size_t t = 0; t < touched.size(); t++) {
+		const T* column = columns.data() + t * m;
+		for (size_t c = 0; c < m; c++) {
+			O[c * a.numCols + touched[t]] = column[c];
+		}
+	}
+}
+
+template <typename T>
+void BasicSparseTensor<T>::sampledMatmul(BasicTensor<T>& out, const BasicSparseTensor& a,
+                                         const BasicTensor<T>& x, const BasicTensor<T>& y) {
+	if (x.ndim() != 2) {
+		throw TensorDismatchError();
+	}
+	size_t m = x.getShape()[1];
+	checkMatrix(x.getShape(), a.numRows, m);
+	checkMatrix(y.getShape(), m, a.numCols);
+	checkMatrix(out.getShape(), a.numRows, a.numCols);
+
+	Span<const T> xValues = x.getData();
+	const T* X = xValues.data();
+	Span<const T> yValues = y.getData();
+	const T* Y = yValues.data();
+	T* O = out.getData().data();
+	simd::fill(O, T(0), out.size());
+	using Acc = typename ComputeType<T>::type;
+
+	/* Row c of y stays in cache while every entry of a gathers from it */
+	forEachRowRange(a.numRows, a.nnz() * m, [&](size_t first, size_t last) {
+		for (size_t c = 0; c < m; c++) {
+			const T* row = Y + c * a.numCols;
+			for (size_t i = first; i < last; i++) {
+				Acc xc = static_cast<Acc>(X[i * m + c]);
+				T* o = O + i * a.numCols;
+				for (size_t p = a.rowPtr[i]; p < a.rowPtr[i + 1]; p++) {
+					o[a.colIndex[p]] = static_cast<T>(static_cast<Acc>(o[a.colIndex[p]]) + xc * static_cast<Acc>(row[a.colIndex[p]]));
+				}
+			}
+		}
+	});
+}
+
+template class BasicSparseTensor<double>;
+template class BasicSparseTensor<float>;
+template class BasicSparseTensor<bfloat16>;
\ No newline at end of file
@@ -1,207 +1,1107 @@
 /* tensor.cpp */
 
 #include "../include/tensor.hpp"
+#include "../include/expr.hpp"
+#include "../include/gemm.hpp"
+#include "../include/parallel.hpp"
+#include "../include/rng.hpp"
+#include "../include/simd.hpp"
 #include <cstdio>
-#include <cstdlib>
-#include <ctime>
 #include <stdexcept>
 #include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-size_t Tensor::computeIndex(const std::vector<size_t>& indices) const {
+namespace {
+
+/* Storage blocks start on a line of this size; padded() rounds rows up to it */
+constexpr size_t CACHE_LINE_BYTES = 64;
+
+Shape rowMajorStrides(const Shape& shape) {
+	Shape strides(shape.size(), 0);
+	size_t stride = 1;
+	for (size_t i = shape.size(); i-- > 0;) {
+		strides[i] = stride;
+		stride *= shape[i];
+	}
+	return strides;
+}
+
+/**
+ * Copy a strided view into a dense row-major buffer
+ *
+ * The innermost dimension is copied as a run when it has unit stride, and
+ * trailing dimensions that are a transposed matrix go through the blocked
+ * transpose kernel.
+ */
+template <typename T>
+void gatherStrided(const T* src, const Shape& shape, const Shape& strides,
+                   size_t dim, T*& dst) {
+	if (dim + 2 == shape.size() && strides[dim] == 1 && strides[dim + 1] != 1) {
+		size_t rows = shape[dim];
+		size_t cols = shape[dim + 1];
+		simd::transpose(src, cols, rows, strides[dim + 1], dst, cols);
+		dst += rows * cols;
+		return;
+	}
+	if (dim + 1 >= shape.size()) {
+		size_t n = shape.empty() ? 1 : shape[dim];
+		size_t stride = shape.empty() ? 1 : strides[dim];
+		if (stride == 1) {
+			dst = std::copy(src, src + n, dst);
+		} else {
+			for (size_t i = 0; i < n; i++) {
+				*dst++ = src[i * stride];
+			}
+		}
+		return;
+	}
+	for (size_t i = 0; i < shape[dim]; i++) {
+		gatherStrided(src + i * strides[dim], shape, strides, dim + 1, dst);
+	}
+}
+
+/**
+ * Copy a dense row-major buffer into a strided view
+ */
+template <typename T>
+void scatterStrided(const T*& src, const Shape& shape, const Shape& strides,
+                    size_t dim, T* dst) {
+	if (dim + 1 >= shape.size()) {
+		size_t n = shape.empty() ? 1 : shape[dim];
+		size_t stride = shape.empty() ? 1 : strides[dim];
+		for (size_t i = 0; i < n; i++) {
+			dst[i * stride] = *src++;
+		}
+		return;
+	}
+	for (size_t i = 0; i < shape[dim]; i++) {
+		scatterStrided(src, shape, strides, dim + 1, dst + i * strides[dim]);
+	}
+}
+
+/**
+ * Assign a value to every element of a strided view
+ */
+template <typename T>
+void fillStrided(T* dst, const Shape& shape, const Shape& strides,
+                 size_t dim, T value) {
+	if (dim + 1 >= shape.size()) {
+		size_t n = shape.empty() ? 1 : shape[dim];
+		size_t stride = shape.empty() ? 1 : strides[dim];
+		for (size_t i = 0; i < n; i++) {
+			dst[i * stride] = value;
+		}
+		return;
+	}
+	for (size_t i = 0; i < shape[dim]; i++) {
+		fillStrided(dst + i * strides[dim], shape, strides, dim + 1, value);
+	}
+}
+
+/**
+ * Walk broadcast operands whose dimensions have been coalesced
+ *
+ * The innermost run goes to the vector kernel when all three operands are
+ * contiguous there, which covers both equal shapes and a row vector
+ * broadcast over a batch. Runs against a broadcast scalar and other
+ * strides use Op::apply in ComputeType<T>.
+ */
+template <typename T, typename Op, typename Kernel>
+void broadcastLoop(const size_t* dims, const size_t* sa, const size_t* sb, const size_t* so,
+                   size_t rank, const T* a, const T* b, T* out, Kernel kernel) {
+	using Acc = typename ComputeType<T>::type;
+
+	if (rank > 1) {
+		for (size_t i = 0; i < dims[0]; i++) {
+			broadcastLoop<T, Op>(dims + 1, sa + 1, sb + 1, so + 1, rank - 1,
+			                     a + i * sa[0], b + i * sb[0], out + i * so[0], kernel);
+		}
+		return;
+	}
+
+	size_t n = dims[0];
+	if (so[0] == 1 && sa[0] == 1 && sb[0] == 1) {
+		kernel(a, b, out, n);
+	} else if (so[0] == 1 && sa[0] == 1 && sb[0] == 0) {
+		Acc bv = static_cast<Acc>(*b);
+		for (size_t i = 0; i < n; i++) {
+			out[i] = static_cast<T>(Op::apply(static_cast<Acc>(a[i]), bv));
+		}
+	} else if (so[0] == 1 && sa[0] == 0 && sb[0] == 1) {
+		Acc av = static_cast<Acc>(*a);
+		for (size_t i = 0; i < n; i++) {
+			out[i] = static_cast<T>(Op::apply(av, static_cast<Acc>(b[i])));
+		}
+	} else {
+		for (size_t i = 0; i < n; i++) {
+			out[i * so[0]] = static_cast<T>(Op::apply(static_cast<Acc>(a[i * sa[0]]),
+			                                          static_cast<Acc>(b[i * sb[0]])));
+		}
+	}
+}
+
+/**
+ * Drop the last count dimensions
+ */
+Shape leadingDims(const Shape& shape, size_t count) {
+	Shape result(shape.size() - count, 0);
+	std::copy(shape.begin(), shape.end() - count, result.begin());
+	return result;
+}
+
+/* Reductions over fewer elements than this stay on the calling thread */
+constexpr size_t PARALLEL_REDUCE_ELEMENTS = size_t(1) << 16;
+
+/* Columns handled by one task of a reduction over a non-innermost axis */
+constexpr size_t REDUCE_COLUMN_CHUNK = 512;
+
+/* Rows added one after another before partial sums are combined pairwise */
+constexpr size_t REDUCE_ROW_BLOCK = 16;
+
+/**
+ * A reduction seen as outer x n x inner: n is the reduced axis, inner the
+ * contiguous run of elements that follows it
+ */
+struct ReduceGrid {
+	size_t outer;
+	size_t n;
+	size_t inner;
+};
+
+ReduceGrid reduceGrid(const Shape& shape, size_t axis) {
+	if (axis >= shape.size()) {
+		throw IndexOutOfBoundsError();
+	}
+	ReduceGrid grid = {1, shape[axis], 1};
+	for (size_t d = 0; d < axis; d++) {
+		grid.outer *= shape[d];
+	}
+	for (size_t d = axis + 1; d < shape.size(); d++) {
+		grid.inner *= shape[d];
+	}
+	return grid;
+}
+
+Shape reducedShape(const Shape& shape, size_t axis, bool keepDims) {
+	if (axis >= shape.size()) {
+		throw IndexOutOfBoundsError();
+	}
+	if (keepDims) {
+		Shape result = shape;
+		result[axis] = 1;
+		return result;
+	}
+	if (shape.size() == 1) {
+		return Shape{1};
+	}
+	Shape result(shape.size() - 1, 0);
+	for (size_t d = 0, r = 0; d < shape.size(); d++) {
+		if (d != axis) {
+			result[r++] = shape[d];
+		}
+	}
+	return result;
+}
+
+/**
+ * Run body(o, first, count) for every outer index and column chunk
+ *
+ * Large reductions spread the (outer, chunk) pairs over the worker pool.
+ * Every output element is computed by the same sequence of operations
+ * whatever the thread count, so results do not depend on it.
+ */
+template <typename Body>
+void forEachReduction(const ReduceGrid& grid, const Body& body) {
+	size_t chunk = (grid.inner == 1) ? 1 : REDUCE_COLUMN_CHUNK;
+	size_t chunks = (grid.inner + chunk - 1) / chunk;
+	size_t units = grid.outer * chunks;
+	auto unit = [&](size_t u) {
+		size_t first = (u % chunks) * chunk;
+		body(u / chunks, first, std::min(chunk, grid.inner - first));
+	};
+
+	size_t threads = (grid.outer * grid.n * grid.inner >= PARALLEL_REDUCE_ELEMENTS)
+	                 ? parallel::getNumThreads() : 1;
+	if (threads <= 1 || units <= 1) {
+		for (size_t u = 0; u < units; u++) {
+			unit(u);
+		}
+		return;
+	}
+
+	size_t tasks = std::min(units, threads * 4);
+	parallel::parallelFor(tasks, [&](size_t t) {
+		for (size_t u = t * units / tasks; u < (t + 1) * units / tasks; u++) {
+			unit(u);
+		}
+	});
+}
+
+template <typename Acc>
+Acc* reduceBuffer(size_t size) {
+	static thread_local std::vector<Acc> buffer;
+	if (buffer.size() < size) {
+		buffer.resize(size);
+	}
+	return buffer.data();
+}
+
+/**
+ * out = row (first) or out += row, widening to the accumulator type
+ */
+template <typename T, typename Acc>
+void accumulateRow(Acc* out, const T* row, size_t n, bool first) {
+	if constexpr (std::is_same<T, Acc>::value) {
+		if (first) {
+			std::copy(row, row + n, out);
+		} else {
+			simd::add(out, row, out, n);
+		}
+	} else {
+		for (size_t j = 0; j < n; j++) {
+			out[j] = first ? static_cast<Acc>(row[j]) : out[j] + static_cast<Acc>(row[j]);
+		}
+	}
+}
+
+/**
+ * Column sums of rows x n values, combining halves pairwise
+ *
+ * scratch: Room for n values per halving of rows below REDUCE_ROW_BLOCK
+ */
+template <typename T, typename Acc>
+void sumRowsPairwise(const T* src, size_t rows, size_t rowStride, size_t n, Acc* out, Acc* scratch) {
+	if (rows <= REDUCE_ROW_BLOCK) {
+		for (size_t r = 0; r < rows; r++) {
+			accumulateRow(out, src + r * rowStride, n, r == 0);
+		}
+		return;
+	}
+	size_t half = rows / 2;
+	sumRowsPairwise(src, half, rowStride, n, out, scratch);
+	sumRowsPairwise(src + half * rowStride, rows - half, rowStride, n, scratch, scratch + n);
+	simd::add(out, scratch, out, n);
+}
+
+/**
+ * dst = scale * sum along the grid's axis
+ */
+template <typename T>
+void sumAxis(const T* src, const ReduceGrid& grid, T* dst, typename ComputeType<T>::type scale) {
+	using Acc = typename ComputeType<T>::type;
+
+	if (grid.n == 0) {
+		std::fill(dst, dst + grid.outer * grid.inner, T(0));
+		return;
+	}
+
+	size_t levels = 1;
+	for (size_t rows = grid.n; rows > REDUCE_ROW_BLOCK; rows = (rows + 1) / 2) {
+		levels++;
+	}
+
+	forEachReduction(grid, [&](size_t o, size_t first, size_t count) {
+		const T* base = src + o * grid.n * grid.inner + first;
+		T* out = dst + o * grid.inner + first;
+		if (grid.inner == 1) {
+			*out = static_cast<T>(simd::reduceSum(base, grid.n) * scale);
+			return;
+		}
+		Acc* sums = reduceBuffer<Acc>(count * (levels + 1));
+		sumRowsPairwise(base, grid.n, grid.inner, count, sums, sums + count);
+		for (size_t j = 0; j < count; j++) {
+			out[j] = static_cast<T>(sums[j] * scale);
+		}
+	});
+}
+
+/**
+ * dst = maximum along the grid's axis (n must be at least 1)
+ */
+template <typename T>
+void maxAxis(const T* src, const ReduceGrid& grid, T* dst) {
+	forEachReduction(grid, [&](size_t o, size_t first, size_t count) {
+		const T* base = src + o * grid.n * grid.inner + first;
+		T* out = dst + o * grid.inner + first;
+		if (grid.inner == 1) {
+			*out = simd::reduceMax(base, grid.n);
+			return;
+		}
+		std::copy(base, base + count, out);
+		for (size_t r = 1; r < grid.n; r++) {
+			simd::maximum(out, base + r * grid.inner, out, count);
+		}
+	});
+}
+
+/**
+ * Index of the first occurrence of the maximum of x[0..n)
+ */
+template <typename T>
+size_t argmaxRun(const T* x, size_t n) {
+	T best = simd::reduceMax(x, n);
+	for (size_t i = 0; i < n; i++) {
+		if (!(x[i] < best)) {
+			return i;
+		}
+	}
+	return 0;
+}
+
+}
+
+template <typename T>
+size_t BasicTensor<T>::computeIndex(const Shape& indices) const {
 	if (indices.size() != shape.size()) {
 		throw TensorDismatchError();
 	}
 
-	size_t index = 0;
-	size_t stride = 1;
-
-	for (int i = shape.size() - 1; i >= 0; i--) {
+	size_t index = offset;
+	for (size_t i = 0; i < shape.size(); i++) {
 		if (indices[i] >= shape[i]) {
 			throw IndexOutOfBoundsError();
 		}
-		index += indices[i] * stride;
-		stride *= shape[i];
+		index += indices[i] * strides[i];
 	}
 
 	return index;
 }
 
-Tensor::Tensor(const std::vector<size_t>& shape) : shape(shape) {
-	size_t totalSize = 1;
-	for (size_t dim : shape) {
-		totalSize *= dim;
+template <typename T>
+void BasicTensor<T>::materialize() {
+	if (isContiguous()) {
+		return;
 	}
-	data.resize(totalSize, 0.0);
+
+	auto compact = makeStorage<T>(size());
+	T* dst = compact->data();
+	gatherStrided(storage->data() + offset, shape, strides, 0, dst);
+
+	storage = std::move(compact);
+	strides = rowMajorStrides(shape);
+	offset = 0;
 }
 
-Tensor::Tensor(const std::vector<size_t>& shape, const std::vector<double>& values)
-	: shape(shape), data(values) {
-	size_t totalSize = 1;
-	for (size_t dim : shape) {
-		totalSize *= dim;
-	}
-	if (values.size() != totalSize) {
+template <typename T>
+BasicTensor<T>::BasicTensor(const Shape& shape)
+	: shape(shape), strides(rowMajorStrides(shape)), offset(0),
+	  storage(makeStorage<T>(shape.numel())) {}
+
+template <typename T>
+BasicTensor<T>::BasicTensor(const Shape& shape, const std::vector<T>& values)
+	: BasicTensor(shape) {
+	if (values.size() != size()) {
 		throw TensorDismatchError();
 	}
+	std::copy(values.begin(), values.end(), storage->data());
+}
+
+template <typename T>
+BasicTensor<T>::BasicTensor(const Shape& shape, T fillValue) : BasicTensor(shape) {
+	fill(fillValue);
 }
 
-Tensor::Tensor(const std::vector<size_t>& shape, double fillValue) : shape(shape) {
-	size_t totalSize = 1;
-	for (size_t dim : shape) {
-		totalSize *= dim;
+template <typename T>
+BasicTensor<T>::BasicTensor(const Shape& shape, const Shape& strides,
+                            size_t offset, std::shared_ptr<Storage<T>> storage)
+	: shape(shape), strides(strides), offset(offset), storage(std::move(storage)) {}
+
+template <typename T>
+BasicTensor<T>::BasicTensor(const BasicTensor& other) : BasicTensor(other.shape) {
+	T* dst = storage->data();
+	gatherStrided(other.storage->data() + other.offset, other.shape, other.strides, 0, dst);
+}
+
+template <typename T>
+BasicTensor<T>& BasicTensor<T>::operator=(const BasicTensor& other) {
+	if (this == &other) {
+		return *this;
+	}
+
+	/* Reuse our buffer when nobody else can observe the overwrite */
+	if (shape == other.shape && isContiguous() && storage.use_count() == 1 && storage->writable()) {
+		T* dst = storage->data() + offset;
+		gatherStrided(other.storage->data() + other.offset, other.shape, other.strides, 0, dst);
+	} else {
+		*this = BasicTensor(other);
 	}
-	data.resize(totalSize, fillValue);
+	return *this;
 }
 
-const std::vector<size_t>& Tensor::getShape() const {
+template <typename T>
+const Shape& BasicTensor<T>::getShape() const {
 	return shape;
 }
 
-size_t Tensor::ndim() const {
+template <typename T>
+const Shape& BasicTensor<T>::getStrides() const {
+	return strides;
+}
+
+template <typename T>
+bool BasicTensor<T>::isContiguous() const {
+	size_t expected = 1;
+	for (size_t i = shape.size(); i-- > 0;) {
+		if (shape[i] != 1 && strides[i] != expected) {
+			return false;
+		}
+		expected *= shape[i];
+	}
+	return true;
+}
+
+template <typename T>
+size_t BasicTensor<T>::ndim() const {
 	return shape.size();
 }
 
-size_t Tensor::size() const {
-	return data.size();
+template <typename T>
+size_t BasicTensor<T>::size() const {
+	return shape.numel();
 }
 
-double Tensor::get(const std::vector<size_t>& indices) const {
-	return data[computeIndex(indices)];
+template <typename T>
+T BasicTensor<T>::get(const Shape& indices) const {
+	return storage->data()[computeIndex(indices)];
 }
 
-double& Tensor::at(const std::vector<size_t>& indices) {
-	return data[computeIndex(indices)];
+template <typename T>
+T& BasicTensor<T>::at(const Shape& indices) {
+	requireWritable();
+	return storage->data()[computeIndex(indices)];
 }
 
-const std::vector<double>& Tensor::getData() const {
-	return data;
+template <typename T>
+Span<const T> BasicTensor<T>::getData() const {
+	if (isContiguous()) {
+		return Span<const T>(storage->data() + offset, size());
+	}
+
+	auto compact = makeStorage<T>(size());
+	T* dst = compact->data();
+	gatherStrided(storage->data() + offset, shape, strides, 0, dst);
+	const T* data = compact->data();
+	return Span<const T>(data, size(), std::move(compact));
 }
 
-std::vector<double>& Tensor::getData() {
-	return data;
+template <typename T>
+Span<T> BasicTensor<T>::getData() {
+	materialize();
+	requireWritable();
+	return Span<T>(storage->data() + offset, size());
 }
 
-Tensor Tensor::zeros(const std::vector<size_t>& shape) {
-	return Tensor(shape, 0.0);
+template <typename T>
+BasicTensor<T> BasicTensor<T>::zeros(const Shape& shape) {
+	return BasicTensor(shape, T(0));
 }
 
-Tensor Tensor::ones(const std::vector<size_t>& shape) {
-	return Tensor(shape, 1.0);
+template <typename T>
+BasicTensor<T> BasicTensor<T>::ones(const Shape& shape) {
+	return BasicTensor(shape, T(1));
 }
 
-Tensor Tensor::random(const std::vector<size_t>& shape) {
-	Tensor result(shape);
-	std::srand(static_cast<unsigned int>(std::time(nullptr)));
-	for (size_t i = 0; i < result.data.size(); i++) {
-		result.data[i] = static_cast<double>(std::rand()) / RAND_MAX;
-	}
+template <typename T>
+BasicTensor<T> BasicTensor<T>::random(const Shape& shape) {
+	BasicTensor result(shape);
+	rng::defaultGenerator().uniform(result);
 	return result;
 }
 
-Tensor Tensor::reshape(const std::vector<size_t>& newShape) const {
-	size_t newSize = 1;
-	for (size_t dim : newShape) {
-		newSize *= dim;
+template <typename T>
+BasicTensor<T> BasicTensor<T>::padded(const Shape& shape) {
+	if (shape.empty()) {
+		return BasicTensor(shape);
+	}
+
+	constexpr size_t lineElements = CACHE_LINE_BYTES / sizeof(T);
+	Shape strides(shape.size(), 0);
+	size_t stride = (shape.back() + lineElements - 1) / lineElements * lineElements;
+	strides[shape.size() - 1] = 1;
+	for (size_t i = shape.size() - 1; i-- > 0;) {
+		strides[i] = stride;
+		stride *= shape[i];
 	}
+	return BasicTensor(shape, strides, 0, makeStorage<T>(stride));
+}
 
-	if (newSize != data.size()) {
+template <typename T>
+BasicTensor<T> BasicTensor<T>::mapFile(const std::string& path, size_t offset, const Shape& shape,
+                                       DType dtype, MapMode mode) {
+	if (dtype != DTypeOf<T>::value) {
 		throw TensorDismatchError();
 	}
+	if (offset % alignof(T) != 0) {
+		throw TensorFileError();
+	}
 
-	return Tensor(newShape, data);
+	auto mapping = MappedFile::open(path, offset, shape.numel() * sizeof(T), mode);
+	auto storage = std::make_shared<Storage<T>>(std::move(mapping));
+	return BasicTensor(shape, rowMajorStrides(shape), 0, std::move(storage));
 }
 
-Tensor Tensor::flatten() const {
-	return Tensor({data.size()}, data);
+template <typename T>
+BasicTensor<T> BasicTensor<T>::reshape(const Shape& newShape) const {
+	if (newShape.numel() != size()) {
+		throw TensorDismatchError();
+	}
+
+	/* A non-contiguous view is reshaped from a compact copy and left untouched */
+	if (!isContiguous()) {
+		return contiguous().reshape(newShape);
+	}
+	return BasicTensor(newShape, rowMajorStrides(newShape), offset, storage);
 }
 
-Tensor Tensor::operator+(const Tensor& other) const {
-	if (shape != other.shape) {
+template <typename T>
+BasicTensor<T> BasicTensor<T>::flatten() const {
+	return reshape({size()});
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::slice(size_t begin, size_t end) const {
+	if (shape.empty()) {
 		throw TensorDismatchError();
 	}
+	if (begin > end || end > shape[0]) {
+		throw IndexOutOfBoundsError();
+	}
 
-	Tensor result(shape);
-	for (size_t i = 0; i < data.size(); i++) {
-		result.data[i] = data[i] + other.data[i];
+	Shape newShape = shape;
+	newShape[0] = end - begin;
+	return BasicTensor(newShape, strides, offset + begin * strides[0], storage);
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::contiguous() const {
+	if (isContiguous()) {
+		return BasicTensor(shape, strides, offset, storage);
 	}
+	return BasicTensor(*this);
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::operator+(const BasicTensor& other) const {
+	BasicTensor result(broadcastShape(shape, other.shape));
+	add(result, *this, other);
+	return result;
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::operator-(const BasicTensor& other) const {
+	BasicTensor result(broadcastShape(shape, other.shape));
+	sub(result, *this, other);
 	return result;
 }
 
-Tensor Tensor::operator-(const Tensor& other) const {
-	if (shape != other.shape) {
+template <typename T>
+BasicTensor<T> BasicTensor<T>::operator/(const BasicTensor& other) const {
+	BasicTensor result(broadcastShape(shape, other.shape));
+	divide(result, *this, other);
+	return result;
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::operator*(T scalar) const {
+	BasicTensor result(shape);
+	scale(result, *this, scalar);
+	return result;
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::hadamard(const BasicTensor& other) const {
+	BasicTensor result(broadcastShape(shape, other.shape));
+	hadamard(result, *this, other);
+	return result;
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::matmul(const BasicTensor& other) const {
+	if (shape.size() != 2 || other.shape.size() != 2) {
 		throw TensorDismatchError();
 	}
 
-	Tensor result(shape);
-	for (size_t i = 0; i < data.size(); i++) {
-		result.data[i] = data[i] - other.data[i];
+	size_t rows1 = shape[0];
+	size_t cols1 = shape[1];
+	size_t rows2 = other.shape[0];
+	size_t cols2 = other.shape[1];
+
+	if (cols1 != rows2) {
+		throw TensorDismatchError();
 	}
+
+	BasicTensor result({rows1, cols2});
+	matmul(result, *this, other);
 	return result;
 }
 
-Tensor Tensor::operator*(double scalar) const {
-	Tensor result(shape);
-	for (size_t i = 0; i < data.size(); i++) {
-		result.data[i] = data[i] * scalar;
+template <typename T>
+BasicTensor<T> BasicTensor<T>::bmm(const BasicTensor& other) const {
+	if (shape.size() < 2 || other.shape.size() < 2) {
+		throw TensorDismatchError();
 	}
+
+	Shape batch = broadcastShape(leadingDims(shape, 2), leadingDims(other.shape, 2));
+	Shape outShape(batch.size() + 2, 0);
+	std::copy(batch.begin(), batch.end(), outShape.begin());
+	outShape[batch.size()] = shape[shape.size() - 2];
+	outShape[batch.size() + 1] = other.shape.back();
+
+	BasicTensor result(outShape);
+	bmm(result, *this, other);
 	return result;
 }
 
-Tensor Tensor::hadamard(const Tensor& other) const {
-	if (shape != other.shape) {
+template <typename T>
+template <typename Kernel>
+void BasicTensor<T>::binaryOp(BasicTensor& out, const BasicTensor& a, const BasicTensor& b, Kernel kernel) {
+	if (a.shape != b.shape || out.shape != a.shape) {
+		throw TensorDismatchError();
+	}
+	out.requireWritable();
+
+	if (out.isContiguous()) {
+		kernel(a.getData().data(), b.getData().data(), out.storage->data() + out.offset, out.size());
+		return;
+	}
+
+	/* Strided destination: compute densely, then scatter without touching out's layout */
+	BasicTensor ac = a.contiguous();
+	BasicTensor bc = b.contiguous();
+	BasicTensor dense(out.shape);
+	kernel(ac.storage->data() + ac.offset, bc.storage->data() + bc.offset, dense.storage->data(), dense.size());
+	const T* src = dense.storage->data();
+	scatterStrided(src, out.shape, out.strides, 0, out.storage->data() + out.offset);
+}
+
+template <typename T>
+template <typename Op, typename Kernel>
+void BasicTensor<T>::broadcastOp(BasicTensor& out, const BasicTensor& a, const BasicTensor& b, Kernel kernel) {
+	if (a.shape == b.shape) {
+		binaryOp(out, a, b, kernel);
+		return;
+	}
+
+	if (out.shape != broadcastShape(a.shape, b.shape)) {
 		throw TensorDismatchError();
 	}
+	out.requireWritable();
+
+	/* Right-align the operands against out; broadcast and missing dimensions get stride 0 */
+	size_t n = out.shape.size();
+	Shape dims(n, 0), sa(n, 0), sb(n, 0), so(n, 0);
+	size_t rank = 0;
+	for (size_t d = 0; d < n; d++) {
+		size_t size = out.shape[d];
+		if (size == 1) {
+			continue;
+		}
+		size_t da = d + a.shape.size() - n;
+		size_t db = d + b.shape.size() - n;
+		size_t strideA = (d + a.shape.size() >= n && a.shape[da] != 1) ? a.strides[da] : 0;
+		size_t strideB = (d + b.shape.size() >= n && b.shape[db] != 1) ? b.strides[db] : 0;
+		size_t strideOut = out.strides[d];
+
+		/* Fold into the previous dimension when it steps over this one exactly */
+		if (rank > 0 && sa[rank - 1] == strideA * size && sb[rank - 1] == strideB * size &&
+		    so[rank - 1] == strideOut * size) {
+			dims[rank - 1] *= size;
+			sa[rank - 1] = strideA;
+			sb[rank - 1] = strideB;
+			so[rank - 1] = strideOut;
+			continue;
+		}
+		dims[rank] = size;
+		sa[rank] = strideA;
+		sb[rank] = strideB;
+		so[rank] = strideOut;
+		rank++;
+	}
 
-	Tensor result(shape);
-	for (size_t i = 0; i < data.size(); i++) {
-		result.data[i] = data[i] * other.data[i];
+	if (rank == 0) {
+		dims = Shape{1};
+		sa = sb = so = Shape{1};
+		rank = 1;
+	}
+
+	broadcastLoop<T, Op>(dims.data(), sa.data(), sb.data(), so.data(), rank,
+	                     a.storage->data() + a.offset, b.storage->data() + b.offset,
+	                     out.storage->data() + out.offset, kernel);
+}
+
+template <typename T>
+Shape BasicTensor<T>::broadcastShape(const Shape& a, const Shape& b) {
+	size_t n = std::max(a.size(), b.size());
+	Shape result(n, 1);
+	for (size_t d = 0; d < n; d++) {
+		size_t da = (d + a.size() >= n) ? a[d + a.size() - n] : 1;
+		size_t db = (d + b.size() >= n) ? b[d + b.size() - n] : 1;
+		if (da != db && da != 1 && db != 1) {
+			throw TensorDismatchError();
+		}
+		result[d] = (da == 1) ? db : da;
 	}
 	return result;
 }
 
-Tensor Tensor::matmul(const Tensor& other) const {
-	if (shape.size() != 2 || other.shape.size() != 2) {
+template <typename T>
+void BasicTensor<T>::add(BasicTensor& out, const BasicTensor& a, const BasicTensor& b) {
+	broadcastOp<expr::Add>(out, a, b, simd::add<T>);
+}
+
+template <typename T>
+void BasicTensor<T>::sub(BasicTensor& out, const BasicTensor& a, const BasicTensor& b) {
+	broadcastOp<expr::Sub>(out, a, b, simd::sub<T>);
+}
+
+template <typename T>
+void BasicTensor<T>::hadamard(BasicTensor& out, const BasicTensor& a, const BasicTensor& b) {
+	broadcastOp<expr::Mul>(out, a, b, simd::mul<T>);
+}
+
+template <typename T>
+void BasicTensor<T>::divide(BasicTensor& out, const BasicTensor& a, const BasicTensor& b) {
+	broadcastOp<expr::Div>(out, a, b, simd::div<T>);
+}
+
+template <typename T>
+void BasicTensor<T>::scale(BasicTensor& out, const BasicTensor& a, T scalar) {
+	binaryOp(out, a, a, [scalar](const T* x, const T*, T* y, size_t n) {
+		simd::scale(x, scalar, y, n);
+	});
+}
+
+template <typename T>
+void BasicTensor<T>::matmul(BasicTensor& out, const BasicTensor& a, const BasicTensor& b,
+                            T alpha, T beta, bool transA, bool transB) {
+	if (a.shape.size() != 2 || b.shape.size() != 2 || out.shape.size() != 2) {
 		throw TensorDismatchError();
 	}
 
-	size_t rows1 = shape[0];
-	size_t cols1 = shape[1];
-	size_t rows2 = other.shape[0];
-	size_t cols2 = other.shape[1];
+	size_t M = a.shape[transA ? 1 : 0];
+	size_t K = a.shape[transA ? 0 : 1];
+	size_t N = b.shape[transB ? 0 : 1];
 
-	if (cols1 != rows2) {
+	if (b.shape[transB ? 1 : 0] != K || out.shape[0] != M || out.shape[1] != N) {
 		throw TensorDismatchError();
 	}
+	out.requireWritable();
+
+	/* gemm takes arbitrary strides, so transposed and sliced operands need no copy */
+	gemm<T>(M, N, K,
+	        alpha, a.storage->data() + a.offset, a.strides[transA ? 1 : 0], a.strides[transA ? 0 : 1],
+	        b.storage->data() + b.offset, b.strides[transB ? 1 : 0], b.strides[transB ? 0 : 1],
+	        beta, out.storage->data() + out.offset, out.strides[0], out.strides[1]);
+}
+
+template <typename T>
+void BasicTensor<T>::bmm(BasicTensor& out, const BasicTensor& a, const BasicTensor& b,
+                         T alpha, T beta, bool transA, bool transB) {
+	size_t ra = a.shape.size();
+	size_t rb = b.shape.size();
+	size_t ro = out.shape.size();
+	if (ra < 2 || rb < 2 || ro < 2) {
+		throw TensorDismatchError();
+	}
+
+	size_t M = a.shape[ra - (transA ? 1 : 2)];
+	size_t K = a.shape[ra - (transA ? 2 : 1)];
+	size_t N = b.shape[rb - (transB ? 2 : 1)];
+	Shape batch = broadcastShape(leadingDims(a.shape, 2), leadingDims(b.shape, 2));
 
-	Tensor result({rows1, cols2});
-	for (size_t i = 0; i < rows1; i++) {
-		for (size_t j = 0; j < cols2; j++) {
-			double sum = 0.0;
-			for (size_t k = 0; k < cols1; k++) {
-				sum += get({i, k}) * other.get({k, j});
+	if (b.shape[rb - (transB ? 1 : 2)] != K || ro != batch.size() + 2 ||
+	    out.shape[ro - 2] != M || out.shape[ro - 1] != N) {
+		throw TensorDismatchError();
+	}
+	for (size_t d = 0; d < batch.size(); d++) {
+		if (out.shape[d] != batch[d]) {
+			throw TensorDismatchError();
+		}
+	}
+	out.requireWritable();
+
+	/* Base pointer of every product; broadcast batch dimensions contribute no offset */
+	size_t count = batch.numel();
+	std::vector<const T*> ptrA(count);
+	std::vector<const T*> ptrB(count);
+	std::vector<T*> ptrC(count);
+	Shape index(batch.size(), 0);
+	for (size_t i = 0; i < count; i++) {
+		size_t offA = a.offset;
+		size_t offB = b.offset;
+		size_t offC = out.offset;
+		for (size_t d = 0; d < batch.size(); d++) {
+			size_t da = d + (ra - 2) - batch.size();
+			size_t db = d + (rb - 2) - batch.size();
+			if (d + ra - 2 >= batch.size() && a.shape[da] != 1) {
+				offA += index[d] * a.strides[da];
+			}
+			if (d + rb - 2 >= batch.size() && b.shape[db] != 1) {
+				offB += index[d] * b.strides[db];
+			}
+			offC += index[d] * out.strides[d];
+		}
+		ptrA[i] = a.storage->data() + offA;
+		ptrB[i] = b.storage->data() + offB;
+		ptrC[i] = out.storage->data() + offC;
+
+		for (size_t d = batch.size(); d-- > 0;) {
+			if (++index[d] < batch[d]) {
+				break;
 			}
-			result.at({i, j}) = sum;
+			index[d] = 0;
 		}
 	}
-	return result;
+
+	size_t rsA = a.strides[ra - (transA ? 1 : 2)];
+	size_t csA = a.strides[ra - (transA ? 2 : 1)];
+	size_t rsB = b.strides[rb - (transB ? 1 : 2)];
+	size_t csB = b.strides[rb - (transB ? 2 : 1)];
+	gemmBatched<T>(count, M, N, K, alpha, ptrA.data(), rsA, csA, ptrB.data(), rsB, csB,
+	               beta, ptrC.data(), out.strides[ro - 2], out.strides[ro - 1]);
+}
+
+template <typename T>
+BasicTensor<T>& BasicTensor<T>::add_(const BasicTensor& other) {
+	add(*this, *this, other);
+	return *this;
+}
+
+template <typename T>
+BasicTensor<T>& BasicTensor<T>::sub_(const BasicTensor& other) {
+	sub(*this, *this, other);
+	return *this;
+}
+
+template <typename T>
+BasicTensor<T>& BasicTensor<T>::mul_(const BasicTensor& other) {
+	hadamard(*this, *this, other);
+	return *this;
 }
 
-Tensor Tensor::transpose() const {
+template <typename T>
+BasicTensor<T>& BasicTensor<T>::div_(const BasicTensor& other) {
+	divide(*this, *this, other);
+	return *this;
+}
+
+template <typename T>
+BasicTensor<T>& BasicTensor<T>::scale_(T scalar) {
+	scale(*this, *this, scalar);
+	return *this;
+}
+
+template <typename T>
+BasicTensor<T>& BasicTensor<T>::axpy_(T alpha, const BasicTensor& x) {
+	return scaleAdd_(T(1), alpha, x);
+}
+
+template <typename T>
+BasicTensor<T>& BasicTensor<T>::scaleAdd_(T alpha, T beta, const BasicTensor& x) {
+	binaryOp(*this, *this, x, [alpha, beta](const T* y, const T* xv, T* out, size_t n) {
+		if (out != y) {
+			std::copy(y, y + n, out);
+		}
+		simd::axpby(beta, xv, alpha, out, n);
+	});
+	return *this;
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::transpose() const {
 	if (shape.size() != 2) {
 		throw TensorDismatchError();
 	}
 
-	Tensor result({shape[1], shape[0]});
-	for (size_t i = 0; i < shape[0]; i++) {
-		for (size_t j = 0; j < shape[1]; j++) {
-			result.at({j, i}) = get({i, j});
-		}
+	return BasicTensor({shape[1], shape[0]}, {strides[1], strides[0]}, offset, storage);
+}
+
+template <typename T>
+void BasicTensor<T>::fill(T value) {
+	requireWritable();
+	if (isContiguous()) {
+		simd::fill(storage->data() + offset, value, size());
+	} else {
+		fillStrided(storage->data() + offset, shape, strides, 0, value);
+	}
+}
+
+template <typename T>
+T BasicTensor<T>::sum() const {
+	using Acc = typename ComputeType<T>::type;
+
+	BasicTensor flat = contiguous();
+	const T* src = flat.storage->data() + flat.offset;
+	size_t n = size();
+
+	/* Fixed-size blocks summed independently, then their partial sums pairwise */
+	size_t blocks = (n + PARALLEL_REDUCE_ELEMENTS - 1) / PARALLEL_REDUCE_ELEMENTS;
+	if (blocks <= 1) {
+		return static_cast<T>(simd::reduceSum(src, n));
+	}
+	std::vector<Acc> partial(blocks);
+	parallel::parallelFor(blocks, [&](size_t b) {
+		size_t first = b * PARALLEL_REDUCE_ELEMENTS;
+		partial[b] = simd::reduceSum(src + first, std::min(PARALLEL_REDUCE_ELEMENTS, n - first));
+	});
+	return static_cast<T>(simd::reduceSum(partial.data(), blocks));
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::sum(size_t axis, bool keepDims) const {
+	BasicTensor result(reducedShape(shape, axis, keepDims));
+	sum(result, *this, axis);
+	return result;
+}
+
+template <typename T>
+void BasicTensor<T>::sum(BasicTensor& out, const BasicTensor& a, size_t axis) {
+	ReduceGrid grid = reduceGrid(a.shape, axis);
+	if (out.shape != reducedShape(a.shape, axis, false) && out.shape != reducedShape(a.shape, axis, true)) {
+		throw TensorDismatchError();
+	}
+	out.requireWritable();
+
+	BasicTensor src = a.contiguous();
+	if (out.isContiguous()) {
+		sumAxis(src.storage->data() + src.offset, grid, out.storage->data() + out.offset,
+		        typename ComputeType<T>::type(1));
+		return;
+	}
+
+	BasicTensor dense(out.shape);
+	sumAxis(src.storage->data() + src.offset, grid, dense.storage->data(),
+	        typename ComputeType<T>::type(1));
+	const T* values = dense.storage->data();
+	scatterStrided(values, out.shape, out.strides, 0, out.storage->data() + out.offset);
+}
+
+template <typename T>
+T BasicTensor<T>::mean() const {
+	using Acc = typename ComputeType<T>::type;
+	return static_cast<T>(static_cast<Acc>(sum()) / static_cast<Acc>(size()));
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::mean(size_t axis, bool keepDims) const {
+	using Acc = typename ComputeType<T>::type;
+
+	ReduceGrid grid = reduceGrid(shape, axis);
+	BasicTensor src = contiguous();
+	BasicTensor result(reducedShape(shape, axis, keepDims));
+	sumAxis(src.storage->data() + src.offset, grid, result.storage->data(),
+	        Acc(1) / static_cast<Acc>(grid.n));
+	return result;
+}
+
+template <typename T>
+T BasicTensor<T>::max() const {
+	if (size() == 0) {
+		throw TensorDismatchError();
 	}
+
+	BasicTensor flat = contiguous();
+	T result;
+	maxAxis(flat.storage->data() + flat.offset, ReduceGrid{1, size(), 1}, &result);
+	return result;
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::max(size_t axis, bool keepDims) const {
+	ReduceGrid grid = reduceGrid(shape, axis);
+	if (grid.n == 0) {
+		throw TensorDismatchError();
+	}
+
+	BasicTensor src = contiguous();
+	BasicTensor result(reducedShape(shape, axis, keepDims));
+	maxAxis(src.storage->data() + src.offset, grid, result.storage->data());
 	return result;
 }
 
-void Tensor::fill(double value) {
-	for (size_t i = 0; i < data.size(); i++) {
-		data[i] = value;
+template <typename T>
+size_t BasicTensor<T>::argmax() const {
+	if (size() == 0) {
+		throw TensorDismatchError();
 	}
-}
\ No newline at end of file
+
+	BasicTensor flat = contiguous();
+	return argmaxRun(flat.storage->data() + flat.offset, size());
+}
+
+template <typename T>
+std::vector<size_t> BasicTensor<T>::argmax(size_t axis) const {
+	ReduceGrid grid = reduceGrid(shape, axis);
+	if (grid.n == 0) {
+		throw TensorDismatchError();
+	}
+
+	BasicTensor c = contiguous();
+	const T* src = c.storage->data() + c.offset;
+	std::vector<size_t> result(grid.outer * grid.inner);
+
+	forEachReduction(grid, [&](size_t o, size_t first, size_t count) {
+		const T* base = src + o * grid.n * grid.inner + first;
+		size_t* out = result.data() + o * grid.inner + first;
+		if (grid.inner == 1) {
+			*out = argmaxRun(base, grid.n);
+			return;
+		}
+		T* best = reduceBuffer<T>(count);
+		std::copy(base, base + count, best);
+		std::fill(out, out + count, size_t(0));
+		for (size_t r = 1; r < grid.n; r++) {
+			const T* row = base + r * grid.inner;
+			for (size_t j = 0; j < count; j++) {
+				if (row[j] > best[j]) {
+					best[j] = row[j];
+					out[j] = r;
+				}
+			}
+		}
+	});
+	return result;
+}
+
+template <typename T>
+BasicTensor<T> BasicTensor<T>::logsumexp(size_t axis, bool keepDims) const {
+	using Acc = typename ComputeType<T>::type;
+
+	ReduceGrid grid = reduceGrid(shape, axis);
+	if (grid.n == 0) {
+		throw TensorDismatchError();
+	}
+
+	BasicTensor c = contiguous();
+	const T* src = c.storage->data() + c.offset;
+	BasicTensor result(reducedShape(shape, axis, keepDims));
+	T* dst = result.storage->data();
+	maxAxis(src, grid, dst);
+
+	/* dst holds the maxima; shift by them so exp never overflows */
+	forEachReduction(grid, [&](size_t o, size_t first, size_t count) {
+		const T* base = src + o * grid.n * grid.inner + first;
+		T* out = dst + o * grid.inner + first;
+		Acc* sums = reduceBuffer<Acc>(count);
+		std::fill(sums, sums + count, Acc(0));
+		for (size_t r = 0; r < grid.n; r++) {
+			const T* row = base + r * grid.inner;
+			for (size_t j = 0; j < count; j++) {
+				sums[j] += std::exp(static_cast<Acc>(row[j]) - static_cast<Acc>(out[j]));
+			}
+		}
+		for (size_t j = 0; j < count; j++) {
+			Acc m = static_cast<Acc>(out[j]);
+			if (m != -std::numeric_limits<Acc>::infinity()) {
+				out[j] = static_cast<T>(m + std::log(sums[j]));
+			}
+		}
+	});
+	return result;
+}
+
+template class BasicTensor<double>;
+template class BasicTensor<float>;
+template class BasicTensor<bfloat16>;
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "conv2d.hpp"
+#include <chrono>
+#include <cstdio>
+
+/**
+ * Time forward + backward of one layer on one algorithm
+ *
+ * Output: Best wall time of several repetitions in milliseconds
+ */
+double timeLayer(Conv2DF& conv, ConvAlgorithm algorithm, const TensorF& input, const TensorF& gradOutput) {
+	conv.setAlgorithm(algorithm);
+	conv.forward(input);
+	conv.backward(gradOutput);
+	double best = 1e30;
+	for (int trial = 0; trial < 5; trial++) {
+		auto start = std::chrono::steady_clock::now();
+		conv.forward(input);
+		conv.backward(gradOutput);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+int main(void) {
+	/* MNIST-shaped layers, batch of 64: {inC, outC, kernel, padding, size} */
+	const size_t batch = 64;
+	const size_t layers[][5] = {
+		{1, 8, 3, 1, 28},
+		{1, 8, 5, 2, 28},
+		{4, 8, 3, 1, 28},
+		{8, 16, 3, 1, 14},
+		{16, 32, 3, 1, 7},
+		{8, 16, 5, 2, 14},
+		{16, 32, 3, 1, 14},
+		{32, 32, 3, 1, 14},
+		{32, 64, 3, 1, 7},
+	};
+	const char* names[] = {"auto", "im2col", "direct", "wino2x2", "wino4x4"};
+
+	std::printf("Conv2D forward + backward, float, batch %zu, milliseconds\n", batch);
+	std::printf("%-22s %10s %10s %10s %10s %12s %8s\n", "layer", "im2col", "direct", "wino2x2", "wino4x4",
+	            "columns(KB)", "auto");
+	for (const auto& l : layers) {
+		Conv2DF conv(l[0], l[1], l[2], 1, l[3]);
+		TensorF input = TensorF::random({batch, l[0], l[4], l[4]});
+		size_t out = conv.outputSize(l[4]);
+		TensorF gradOutput = TensorF::random({batch, l[1], out, out});
+
+		double im2col = timeLayer(conv, ConvAlgorithm::Im2col, input, gradOutput);
+		double direct = timeLayer(conv, ConvAlgorithm::Direct, input, gradOutput);
+		double wino2 = timeLayer(conv, ConvAlgorithm::Winograd2x2, input, gradOutput);
+		double wino4 = timeLayer(conv, ConvAlgorithm::Winograd4x4, input, gradOutput);
+		conv.setAlgorithm(ConvAlgorithm::Auto);
+		size_t columnBytes = batch * l[0] * l[2] * l[2] * out * out * sizeof(float);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "%zux%zu %zu->%zu k%zu p%zu", l[4], l[4], l[0], l[1], l[2], l[3]);
+		std::printf("%-22s %10.2f %10.2f %10.2f %10.2f %12zu %8s\n", name, im2col, direct, wino2, wino4,
+		            columnBytes / 1024, names[static_cast<int>(conv.selectedAlgorithm())]);
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "gemm.hpp"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+/**
+ * Time one square product on the current backend
+ *
+ * n: Matrix size
+ * Output: Best wall time of several repetitions in microseconds
+ */
+template <typename T>
+double timeGemm(size_t n) {
+	std::vector<T> a(n * n, T(0.5)), b(n * n, T(0.25)), c(n * n, T(0));
+	size_t repeats = std::max<size_t>(3, (size_t(1) << 24) / (n * n * n));
+	double best = 1e30;
+	for (int trial = 0; trial < 3; trial++) {
+		auto start = std::chrono::steady_clock::now();
+		for (size_t r = 0; r < repeats; r++) {
+			gemm<T>(n, n, n, T(1), a.data(), n, 1, b.data(), n, 1, T(0), c.data(), n, 1);
+		}
+		std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count() / repeats);
+	}
+	return best;
+}
+
+/**
+ * Compare the built-in kernel with CBLAS and report where CBLAS starts winning
+ */
+template <typename T>
+void benchmark(const char* name) {
+	const size_t sizes[] = {4, 8, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+
+	std::printf("%s GEMM (n x n x n), microseconds per call\n", name);
+	std::printf("%6s %12s %12s\n", "n", "builtin", "blas");
+	size_t crossover = 0;
+	for (size_t n : sizes) {
+		setGemmBackend(GemmBackend::Builtin);
+		double builtin = timeGemm<T>(n);
+		if (!hasBlas()) {
+			std::printf("%6zu %12.2f %12s\n", n, builtin, "-");
+			continue;
+		}
+		setGemmBackend(GemmBackend::Blas);
+		double blas = timeGemm<T>(n);
+		std::printf("%6zu %12.2f %12.2f\n", n, builtin, blas);
+		if (blas < builtin) {
+			crossover = (crossover == 0) ? n : crossover;
+		} else {
+			crossover = 0;
+		}
+	}
+	setGemmBackend(GemmBackend::Auto);
+
+	if (!hasBlas()) {
+		std::printf("Built without CBLAS (make BLAS=openblas bench to compare).\n\n");
+	} else if (crossover == 0) {
+		std::printf("CBLAS never overtakes the built-in kernel.\n\n");
+	} else {
+		std::printf("CBLAS wins from n = %zu; setBlasThreshold(%zu) sends those products to it.\n\n",
+		            crossover, crossover * crossover * crossover);
+	}
+}
+
+int main(void) {
+	benchmark<float>("float");
+	benchmark<double>("double");
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "static_dense.hpp"
+#include <chrono>
+#include <cstdio>
+
+/**
+ * Time fn over many calls
+ *
+ * Output: Mean wall time per call in microseconds
+ */
+template <typename Fn>
+double timeCalls(size_t calls, const Fn& fn) {
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < calls; i++) {
+		fn();
+	}
+	std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / calls;
+}
+
+int main(void) {
+	/* Single-sample inference through a 784 -> 128 -> 10 MLP */
+	const size_t calls = 5000;
+	StaticDenseF<784, 128> fixed1;
+	StaticDenseF<128, 10> fixed2;
+	DenseF dynamic1(784, 128);
+	DenseF dynamic2(128, 10);
+	*dynamic1.getWeights()[0] = *fixed1.getWeights()[0];
+	*dynamic2.getWeights()[0] = *fixed2.getWeights()[0];
+
+	StaticTensor<float, 784> sample;
+	for (size_t i = 0; i < sample.size(); i++) {
+		sample(i) = static_cast<float>(i % 7) * 0.1f;
+	}
+	StaticTensor<float, 128> hidden;
+	StaticTensor<float, 10> output;
+	TensorF input = sample.toTensor();
+
+	float sink = 0.0f;
+	double dense = timeCalls(calls, [&]() {
+		sink += dynamic2.forward(dynamic1.forward(input)).getData()[0];
+	});
+	double forward = timeCalls(calls, [&]() {
+		sink += fixed2.forward(fixed1.forward(input)).getData()[0];
+	});
+	double infer = timeCalls(calls, [&]() {
+		fixed1.infer(sample, hidden);
+		fixed2.infer(hidden, output);
+		sink += output(0);
+	});
+
+	std::printf("784-128-10 MLP, one float sample, microseconds per call\n");
+	std::printf("%-24s %10.2f\n", "Dense::forward", dense);
+	std::printf("%-24s %10.2f\n", "StaticDense::forward", forward);
+	std::printf("%-24s %10.2f\n", "StaticDense::infer", infer);
+	std::printf("(checksum %g)\n", sink);
+	return 0;
+}
\ No newline at end of file
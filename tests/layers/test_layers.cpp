@@ -1,5 +1,10 @@
 #include "dense.hpp"
 #include "activation.hpp"
+#include "quantized.hpp"
+#include "static_dense.hpp"
+#include "conv2d.hpp"
+#include "pool2d.hpp"
+#include <memory>
 #include <cassert>
 #include <cstdio>
 #include <cmath>
@@ -60,6 +65,385 @@ void testDenseBackward() {
 	std::printf("Dense backward passed.\n");
 }
 
+void testDenseSparse() {
+	Dense sparseLayer(6, 4);
+	Dense denseLayer(6, 4);
+	*denseLayer.getWeights()[0] = *sparseLayer.getWeights()[0];
+	*denseLayer.getWeights()[1] = Tensor({4}, 0.25);
+	*sparseLayer.getWeights()[1] = Tensor({4}, 0.25);
+
+	Tensor input({3, 6});
+	input.at({0, 1}) = 2.0;
+	input.at({0, 4}) = -1.0;
+	input.at({2, 1}) = 0.5;
+	SparseTensor sparse = SparseTensor::fromCoo(3, 6, {2, 0, 0}, {1, 4, 1}, {0.5, -1.0, 2.0});
+	assert(sparse.nnz() == 3);
+
+	Tensor expected = denseLayer.forward(input);
+	Tensor output = sparseLayer.forward(sparse);
+	for (size_t i = 0; i < expected.size(); i++) {
+		assert(std::abs(output.getData()[i] - expected.getData()[i]) < 1e-12);
+	}
+
+	Tensor gradOutput = Tensor::random({3, 4});
+	Tensor expectedInput = denseLayer.backward(gradOutput);
+	Tensor gradInput = sparseLayer.backward(gradOutput);
+	for (size_t i = 0; i < 4; i++) {
+		for (size_t j = 0; j < 6; j++) {
+			double w = denseLayer.getGradients()[0]->get({i, j});
+			assert(std::abs(sparseLayer.getGradients()[0]->get({i, j}) - w) < 1e-12);
+		}
+		double b = denseLayer.getGradients()[1]->get({i});
+		assert(std::abs(sparseLayer.getGradients()[1]->get({i}) - b) < 1e-12);
+	}
+	assert(std::abs(gradInput.get({0, 4}) - expectedInput.get({0, 4})) < 1e-12);
+	assert(std::abs(gradInput.get({2, 1}) - expectedInput.get({2, 1})) < 1e-12);
+	assert(gradInput.get({1, 0}) == 0.0);
+
+	std::printf("Dense sparse input passed.\n");
+}
+
+void testStaticDense() {
+	/* 37 inputs leave a remainder after the vector-wide partial sums */
+	StaticDense<37, 5> fixed;
+	Dense dynamic(37, 5);
+	*dynamic.getWeights()[0] = *fixed.getWeights()[0];
+	*fixed.getWeights()[1] = Tensor({5}, 0.5);
+	*dynamic.getWeights()[1] = Tensor({5}, 0.5);
+
+	StaticTensor<double, 37> sample;
+	for (size_t i = 0; i < sample.size(); i++) {
+		sample(i) = std::sin(0.3 * i);
+	}
+	Tensor input = sample.toTensor();
+	using Sample = StaticTensor<double, 37>;
+	assert(Sample::fromTensor(input)(36) == sample(36));
+
+	Tensor expected = dynamic.forward(input);
+	StaticTensor<double, 5> inferred = fixed.infer(sample);
+	std::unique_ptr<Layer> layer = std::make_unique<StaticDense<37, 5>>(fixed);
+	Tensor output = layer->forward(input);
+	for (size_t i = 0; i < 5; i++) {
+		assert(std::abs(inferred(i) - expected.get({i})) < 1e-12);
+		assert(output.get({i}) == inferred(i));
+	}
+
+	/* Backward and batches go through the shared Dense code */
+	Tensor gradOutput = Tensor::random({5});
+	Tensor gradInput = layer->backward(gradOutput);
+	Tensor expectedInput = dynamic.backward(gradOutput);
+	for (size_t i = 0; i < 37; i++) {
+		assert(std::abs(gradInput.get({i}) - expectedInput.get({i})) < 1e-12);
+	}
+	assert((layer->forward(Tensor::random({3, 37})).getShape() == Shape{3, 5}));
+
+	bool threw = false;
+	try { layer->forward(Tensor::random({36})); }
+	catch (const LayerDimensionError&) { threw = true; }
+	assert(threw);
+	threw = false;
+	try { StaticDense<36, 5> wrong(Tensor({5, 37}), Tensor({5})); }
+	catch (const LayerDimensionError&) { threw = true; }
+	assert(threw);
+
+	std::printf("Static dense passed.\n");
+}
+
+/**
+ * Naive convolution used as the reference for both Conv2D paths
+ */
+Tensor referenceConv(const Tensor& x, const Tensor& w, const Tensor& b,
+                     size_t stride, size_t padding, size_t dilation, size_t outH, size_t outW) {
+	const Shape& xs = x.getShape();
+	const Shape& ws = w.getShape();
+	Tensor y({xs[0], ws[0], outH, outW});
+	for (size_t n = 0; n < xs[0]; n++) {
+		for (size_t o = 0; o < ws[0]; o++) {
+			for (size_t i = 0; i < outH; i++) {
+				for (size_t j = 0; j < outW; j++) {
+					double sum = b.get({o});
+					for (size_t c = 0; c < xs[1]; c++) {
+						for (size_t kh = 0; kh < ws[2]; kh++) {
+							for (size_t kw = 0; kw < ws[3]; kw++) {
+								long ih = long(i * stride + kh * dilation) - long(padding);
+								long iw = long(j * stride + kw * dilation) - long(padding);
+								if (ih >= 0 && iw >= 0 && ih < long(xs[2]) && iw < long(xs[3])) {
+									sum += w.get({o, c, kh, kw}) * x.get({n, c, size_t(ih), size_t(iw)});
+								}
+							}
+						}
+					}
+					y.at({n, o, i, j}) = sum;
+				}
+			}
+		}
+	}
+	return y;
+}
+
+void testConv2D() {
+	/* {inC, outC, kernel, stride, padding, dilation, H, W} */
+	const size_t configs[][8] = {
+		{1, 4, 3, 1, 1, 1, 9, 8},
+		{2, 3, 5, 1, 2, 1, 7, 7},
+		{3, 5, 3, 2, 1, 1, 8, 9},
+		{6, 2, 3, 1, 0, 2, 9, 10},
+		{2, 3, 1, 2, 0, 1, 5, 6},
+		{8, 6, 3, 1, 1, 1, 11, 10},
+		{5, 4, 3, 1, 0, 1, 9, 12},
+	};
+	for (const auto& cfg : configs) {
+		Conv2D conv(cfg[0], cfg[1], cfg[2], cfg[3], cfg[4], cfg[5]);
+		*conv.getWeights()[1] = Tensor::random({cfg[1]});
+		Tensor input = Tensor::random({2, cfg[0], cfg[6], cfg[7]}) - Tensor({2, cfg[0], cfg[6], cfg[7]}, 0.5);
+		size_t outH = conv.outputSize(cfg[6]);
+		size_t outW = conv.outputSize(cfg[7]);
+		Tensor expected = referenceConv(input, *conv.getWeights()[0], *conv.getWeights()[1],
+		                                cfg[3], cfg[4], cfg[5], outH, outW);
+		Tensor gradOutput = Tensor::random(expected.getShape());
+
+		/* Every path must agree on the output and on every gradient (Winograd within rounding) */
+		std::vector<Tensor> gradInputs;
+		std::vector<Tensor> gradWeights;
+		const ConvAlgorithm algorithms[4] = {ConvAlgorithm::Im2col, ConvAlgorithm::Direct,
+		                                     ConvAlgorithm::Winograd2x2, ConvAlgorithm::Winograd4x4};
+		for (size_t a = 0; a < 4; a++) {
+			double tol = (a >= 2) ? 1e-10 : 1e-12;
+			conv.setAlgorithm(algorithms[a]);
+			Tensor output = conv.forward(input);
+			assert((output.getShape() == expected.getShape()));
+			for (size_t i = 0; i < output.size(); i++) {
+				assert(std::abs(output.getData()[i] - expected.getData()[i]) < tol);
+			}
+			gradInputs.push_back(conv.backward(gradOutput));
+			gradWeights.push_back(*conv.getGradients()[0]);
+
+			/* A second backward after the same forward must see the same cached state */
+			Tensor againInput = conv.backward(gradOutput);
+			const Tensor& againWeight = *conv.getGradients()[0];
+			for (size_t i = 0; i < againInput.size(); i++) {
+				assert(std::abs(againInput.getData()[i] - gradInputs[a].getData()[i]) < 1e-12);
+			}
+			for (size_t i = 0; i < againWeight.size(); i++) {
+				assert(std::abs(againWeight.getData()[i] - gradWeights[a].getData()[i]) < 1e-12);
+			}
+		}
+		for (size_t a = 1; a < 4; a++) {
+			double tol = (a >= 2) ? 1e-10 : 1e-12;
+			for (size_t i = 0; i < gradInputs[0].size(); i++) {
+				assert(std::abs(gradInputs[0].getData()[i] - gradInputs[a].getData()[i]) < tol);
+			}
+			for (size_t i = 0; i < gradWeights[0].size(); i++) {
+				assert(std::abs(gradWeights[0].getData()[i] - gradWeights[a].getData()[i]) < tol);
+			}
+		}
+
+		/* dL/dx and dL/dW of L = sum(gradOutput * y) by central differences (through the
+		   last path, so a Winograd layer must notice every weight change) */
+		const double eps = 1e-6;
+		for (size_t i = 0; i < input.size(); i += 7) {
+			Tensor plus = input;
+			Tensor minus = input;
+			plus.getData()[i] += eps;
+			minus.getData()[i] -= eps;
+			Tensor yp = conv.forward(plus);
+			Tensor ym = conv.forward(minus);
+			double numeric = 0.0;
+			for (size_t k = 0; k < yp.size(); k++) {
+				numeric += gradOutput.getData()[k] * (yp.getData()[k] - ym.getData()[k]) / (2 * eps);
+			}
+			assert(std::abs(numeric - gradInputs[0].getData()[i]) < 1e-6);
+		}
+		Tensor& weights = *conv.getWeights()[0];
+		for (size_t i = 0; i < weights.size(); i += 5) {
+			double saved = weights.getData()[i];
+			weights.getData()[i] = saved + eps;
+			Tensor yp = conv.forward(input);
+			weights.getData()[i] = saved - eps;
+			Tensor ym = conv.forward(input);
+			weights.getData()[i] = saved;
+			double numeric = 0.0;
+			for (size_t k = 0; k < yp.size(); k++) {
+				numeric += gradOutput.getData()[k] * (yp.getData()[k] - ym.getData()[k]) / (2 * eps);
+			}
+			assert(std::abs(numeric - gradWeights[0].getData()[i]) < 1e-6);
+		}
+	}
+
+	Conv2D mnist(1, 8, 3, 1, 1);
+	Conv2D deep(16, 8, 3, 1, 1);
+	assert(mnist.selectedAlgorithm() == ConvAlgorithm::Direct);
+	assert(deep.selectedAlgorithm() == ConvAlgorithm::Winograd4x4);
+	assert(Conv2D(16, 8, 3, 2, 1).selectedAlgorithm() == ConvAlgorithm::Im2col);
+	assert(Conv2D(16, 8, 5, 1, 2).selectedAlgorithm() == ConvAlgorithm::Im2col);
+
+	/* Single precision Winograd stays close to the double reference */
+	Conv2DF single(16, 8, 3, 1, 1);
+	TensorF x = TensorF::random({3, 16, 13, 13});
+	TensorF y = single.forward(x);
+	Tensor expected = referenceConv(x.cast<double>(), single.getWeights()[0]->cast<double>(),
+	                                single.getWeights()[1]->cast<double>(), 1, 1, 1, 13, 13);
+	for (size_t i = 0; i < y.size(); i++) {
+		assert(std::abs(y.getData()[i] - expected.getData()[i]) < 1e-4);
+	}
+
+	bool threw = false;
+	try { mnist.forward(Tensor::random({1, 2, 8, 8})); }
+	catch (const LayerDimensionError&) { threw = true; }
+	assert(threw);
+
+	std::printf("Conv2D (im2col, direct and Winograd) passed.\n");
+}
+
+/**
+ * Naive pooling used as the reference for MaxPool2D and AvgPool2D
+ *
+ * Fills the window maxima (or averages) and routes gradOutput back to the
+ * first maximum of each window (or evenly over the window).
+ */
+void referencePool(const Tensor& x, const Tensor& gradOutput, size_t k, size_t s, size_t p, bool max,
+                   Tensor& y, Tensor& gradInput) {
+	const Shape& shape = x.getShape();
+	size_t H = shape[2], W = shape[3];
+	size_t OH = y.getShape()[2], OW = y.getShape()[3];
+	gradInput.fill(0.0);
+	for (size_t plane = 0; plane < shape[0] * shape[1]; plane++) {
+		const double* in = x.getData().data() + plane * H * W;
+		double* dx = gradInput.getData().data() + plane * H * W;
+		for (size_t oh = 0; oh < OH; oh++) {
+			for (size_t ow = 0; ow < OW; ow++) {
+				double best = -INFINITY;
+				double sum = 0.0;
+				size_t at = 0;
+				for (size_t kh = 0; kh < k; kh++) {
+					for (size_t kw = 0; kw < k; kw++) {
+						long i = static_cast<long>(oh * s + kh) - static_cast<long>(p);
+						long j = static_cast<long>(ow * s + kw) - static_cast<long>(p);
+						if (i < 0 || j < 0 || i >= static_cast<long>(H) || j >= static_cast<long>(W)) {
+							continue;
+						}
+						double v = in[i * W + j];
+						sum += v;
+						if (v > best) {
+							best = v;
+							at = i * W + j;
+						}
+					}
+				}
+				size_t o = plane * OH * OW + oh * OW + ow;
+				double g = gradOutput.getData()[o];
+				y.getData()[o] = max ? best : sum / (k * k);
+				if (max) {
+					dx[at] += g;
+					continue;
+				}
+				for (size_t kh = 0; kh < k; kh++) {
+					for (size_t kw = 0; kw < k; kw++) {
+						long i = static_cast<long>(oh * s + kh) - static_cast<long>(p);
+						long j = static_cast<long>(ow * s + kw) - static_cast<long>(p);
+						if (i >= 0 && j >= 0 && i < static_cast<long>(H) && j < static_cast<long>(W)) {
+							dx[i * W + j] += g / (k * k);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+void testPool2D() {
+	/* {channels, kernel, stride, padding, H, W} */
+	const size_t configs[][6] = {
+		{3, 2, 2, 0, 8, 8},
+		{2, 3, 2, 1, 9, 7},
+		{2, 3, 1, 1, 6, 5},
+		{1, 2, 3, 0, 7, 7},
+		{2, 3, 3, 2, 10, 11},
+		{1, 17, 1, 0, 19, 18},
+	};
+	for (const auto& cfg : configs) {
+		Tensor input = Tensor::random({2, cfg[0], cfg[4], cfg[5]});
+		MaxPool2D maxPool(cfg[1], cfg[2], cfg[3]);
+		AvgPool2D avgPool(cfg[1], cfg[2], cfg[3]);
+		size_t outH = maxPool.outputSize(cfg[4]);
+		size_t outW = maxPool.outputSize(cfg[5]);
+		Tensor gradOutput = Tensor::random({2, cfg[0], outH, outW});
+
+		for (bool max : {true, false}) {
+			BasicPool2D<double>& pool = max ? static_cast<BasicPool2D<double>&>(maxPool) : avgPool;
+			Tensor expected({2, cfg[0], outH, outW});
+			Tensor expectedGrad(input.getShape());
+			referencePool(input, gradOutput, cfg[1], cfg[2], cfg[3], max, expected, expectedGrad);
+
+			Tensor output = pool.forward(input);
+			assert((output.getShape() == expected.getShape()));
+			for (size_t i = 0; i < output.size(); i++) {
+				assert(std::abs(output.getData()[i] - expected.getData()[i]) < 1e-12);
+			}
+			Tensor gradInput = pool.backward(gradOutput);
+			assert((gradInput.getShape() == input.getShape()));
+			for (size_t i = 0; i < gradInput.size(); i++) {
+				assert(std::abs(gradInput.getData()[i] - expectedGrad.getData()[i]) < 1e-12);
+			}
+		}
+
+		/* One index byte per output instead of an input copy, four past 16 x 16 windows */
+		size_t outputs = 2 * cfg[0] * outH * outW;
+		assert(maxPool.cacheBytes() == outputs * (cfg[1] * cfg[1] <= 256 ? 1 : 4));
+	}
+
+	/* Ties go to the first position of the window */
+	MaxPool2D flat(2);
+	Tensor ones({1, 1, 2, 2}, 1.0);
+	flat.forward(ones);
+	Tensor routed = flat.backward(Tensor({1, 1, 1, 1}, 3.0));
+	assert(routed.getData()[0] == 3.0 && routed.getData()[1] == 0.0 && routed.getData()[3] == 0.0);
+
+	MaxPool2DF single(2);
+	TensorF halved = single.forward(TensorF::random({4, 8, 28, 28}));
+	assert((halved.getShape() == Shape{4, 8, 14, 14}));
+
+	bool threw = false;
+	try { MaxPool2D bad(2, 2, 2); }
+	catch (const LayerDimensionError&) { threw = true; }
+	assert(threw);
+
+	threw = false;
+	try { flat.forward(Tensor::random({2, 4, 4})); }
+	catch (const LayerDimensionError&) { threw = true; }
+	assert(threw);
+
+	std::printf("MaxPool2D and AvgPool2D passed.\n");
+}
+
+void testQuantizedDense() {
+	Dense dense(64, 32);
+	Tensor input = Tensor::random({5, 64}) - Tensor({5, 64}, 0.3);
+
+	Tensor expected = dense.forward(input);
+	QuantizedDense quantized(dense);
+	QuantizedDense fused(dense, true);
+	Tensor output = quantized.forward(input);
+	Tensor clamped = fused.forward(input);
+	assert(output.getShape() == expected.getShape());
+	for (size_t i = 0; i < expected.size(); i++) {
+		double e = expected.getData()[i];
+		assert(std::abs(output.getData()[i] - e) < 0.05);
+		assert(clamped.getData()[i] == std::max(0.0, output.getData()[i]));
+	}
+
+	Tensor single = quantized.forward(Tensor({64}, 0.5));
+	assert(single.ndim() == 1 && single.getShape()[0] == 32);
+	assert(quantized.memoryBytes() * 4 < 64 * 32 * sizeof(double));
+
+	bool threw = false;
+	try { quantized.backward(output); }
+	catch (const InferenceOnlyError&) { threw = true; }
+	assert(threw);
+
+	std::printf("Quantized dense passed.\n");
+}
+
 void testReLU() {
 	Activation relu(ActivationType::ReLU);
 
@@ -141,6 +525,11 @@ void testLayerInterface() {
 int main(void) {
 	testDenseForward();
 	testDenseBackward();
+	testDenseSparse();
+	testStaticDense();
+	testConv2D();
+	testPool2D();
+	testQuantizedDense();
 	testReLU();
 	testSigmoid();
 	testSoftmax();
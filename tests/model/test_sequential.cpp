@@ -1,6 +1,11 @@
 #include "sequential.hpp"
 #include "dense.hpp"
 #include "activation.hpp"
+#include "quantized.hpp"
+#include "mse.hpp"
+#include "sgd.hpp"
+#include "mixed.hpp"
+#include "pool.hpp"
 #include <cassert>
 #include <cstdio>
 #include <memory>
@@ -172,6 +177,187 @@ void testMLPExample() {
 	std::printf("MLP example passed.\n");
 }
 
+void testFloat32Training() {
+	SequentialF model;
+
+	model.addLayer(std::make_shared<DenseF>(2, 8));
+	model.addLayer(std::make_shared<ActivationF>(ActivationType::Tanh));
+	model.addLayer(std::make_shared<DenseF>(8, 1));
+
+	MSEF loss;
+	SGDF optimizer(0.1);
+
+	/* Inputs are prepared in double and converted once at the edge */
+	Tensor X({4, 2}, {0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 1.0, 1.0});
+	Tensor y({4, 1}, {0.0, 1.0, 1.0, 0.0});
+	TensorF Xf = X.cast<float>();
+	TensorF yf = y.cast<float>();
+	assert(Xf.dtype() == DType::Float32);
+
+	float firstLoss = 0.0f;
+	float lastLoss = 0.0f;
+	pool::StepArena arena;
+	for (int epoch = 0; epoch < 2000; epoch++) {
+		/* After a few warm-up steps every tensor buffer should be reused */
+		if (epoch == 10) {
+			pool::resetStats();
+		}
+		pool::StepArena::Scope step(arena);
+
+		TensorF predictions = model.forward(Xf);
+		TensorF lossValue = loss.forward(predictions, yf);
+		model.backward(loss.backward(predictions, yf));
+
+		std::vector<TensorF*> params = model.getParameters();
+		std::vector<TensorF*> grads = model.getGradients();
+		optimizer.step(params, grads);
+		optimizer.zeroGrad(grads);
+
+		if (epoch == 0) {
+			firstLoss = lossValue.get({0});
+		}
+		lastLoss = lossValue.get({0});
+	}
+
+	assert(lastLoss < firstLoss);
+	assert(lastLoss < 0.05f);
+	assert(pool::stats().systemAllocations() == 0);
+
+	Tensor output = model.forward(Xf).cast<double>();
+	assert(output.getShape()[0] == 4);
+	std::printf("Float32 training passed.\n");
+}
+
+void testMixedPrecisionTraining() {
+	SequentialBF16 model;
+
+	model.addLayer(std::make_shared<DenseBF16>(2, 8));
+	model.addLayer(std::make_shared<ActivationBF16>(ActivationType::Tanh));
+	model.addLayer(std::make_shared<DenseBF16>(8, 1));
+
+	MSEBF16 loss;
+	SGDF optimizer(0.1);
+	MixedPrecisionBF16 mixed(model.getParameters(), model.getGradients(), optimizer, 1024.0f, 50);
+
+	Tensor X({4, 2}, {0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 1.0, 1.0});
+	Tensor y({4, 1}, {0.0, 1.0, 1.0, 0.0});
+	TensorBF16 Xb = X.cast<bfloat16>();
+	TensorBF16 yb = y.cast<bfloat16>();
+
+	float firstLoss = 0.0f;
+	float lastLoss = 0.0f;
+	for (int epoch = 0; epoch < 2000; epoch++) {
+		TensorBF16 predictions = model.forward(Xb);
+		TensorBF16 lossValue = loss.forward(predictions, yb);
+		model.backward(mixed.scaleLoss(loss.backward(predictions, yb)));
+		mixed.step();
+		mixed.zeroGrad();
+
+		if (epoch == 0) {
+			firstLoss = lossValue.get({0});
+		}
+		lastLoss = lossValue.get({0});
+	}
+
+	/* Updates far below bfloat16 resolution still accumulate in the float32 masters */
+	assert(lastLoss < firstLoss);
+	assert(lastLoss < 0.05f);
+	assert(mixed.lossScale() > 1024.0f);
+	const TensorF& master = mixed.getMasters()[0];
+	TensorBF16* param = model.getParameters()[0];
+	assert(param->get({0, 0}) == bfloat16(master.get({0, 0})));
+	std::printf("Mixed-precision training passed.\n");
+}
+
+void testCheckpoint() {
+	const char* path = "/tmp/cnn_test_checkpoint.bin";
+	Sequential model;
+	model.addLayer(std::make_shared<Dense>(5, 7));
+	model.addLayer(std::make_shared<Activation>(ActivationType::Tanh));
+	model.addLayer(std::make_shared<Dense>(7, 3));
+	model.addLayer(std::make_shared<Activation>(ActivationType::Softmax));
+	model.save(path);
+
+	Tensor input = Tensor::random({4, 5});
+	Tensor expected = model.forward(input);
+
+	Sequential loaded = Sequential::load(path);
+	Sequential mapped = Sequential::load(path, CheckpointLoad::Map, false);
+	assert(loaded.numLayers() == 4 && mapped.numLayers() == 4);
+	Tensor fromRead = loaded.forward(input);
+	Tensor fromMap = mapped.forward(input);
+	for (size_t i = 0; i < expected.size(); i++) {
+		assert(fromRead.getData()[i] == expected.getData()[i]);
+		assert(fromMap.getData()[i] == expected.getData()[i]);
+	}
+
+	/* Training a mapped model leaves the checkpoint untouched */
+	Tensor target({4, 3}, 0.5);
+	MSE loss;
+	SGD optimizer(0.1);
+	mapped.backward(loss.backward(fromMap, target));
+	std::vector<Tensor*> params = mapped.getParameters();
+	std::vector<Tensor*> grads = mapped.getGradients();
+	optimizer.step(params, grads);
+	Sequential reloaded = Sequential::load(path, CheckpointLoad::Map, true);
+	assert(reloaded.forward(input).getData()[0] == expected.getData()[0]);
+
+	bool threw = false;
+	try { SequentialF::load(path); }
+	catch (const CheckpointError&) { threw = true; }
+	assert(threw);
+
+	/* A flipped bit in the last parameter blob (64-byte aligned) is caught by its checksum */
+	std::FILE* file = std::fopen(path, "r+b");
+	std::fseek(file, -64, SEEK_END);
+	int byte = std::fgetc(file);
+	std::fseek(file, -64, SEEK_END);
+	std::fputc(byte ^ 1, file);
+	std::fclose(file);
+	threw = false;
+	try { Sequential::load(path); }
+	catch (const CheckpointError&) { threw = true; }
+	assert(threw);
+	std::remove(path);
+
+	std::printf("Checkpoint save/load passed.\n");
+}
+
+void testQuantize() {
+	Sequential model;
+	model.addLayer(std::make_shared<Dense>(64, 32));
+	model.addLayer(std::make_shared<Activation>(ActivationType::ReLU));
+	model.addLayer(std::make_shared<Dense>(32, 4));
+	model.addLayer(std::make_shared<Activation>(ActivationType::Sigmoid));
+
+	Sequential quantized = model.quantize();
+	assert(quantized.numLayers() == 3);
+	assert(!quantized.isTraining());
+
+	size_t floatBytes = 0;
+	for (Tensor* param : model.getParameters()) {
+		floatBytes += param->size() * sizeof(double);
+	}
+	size_t int8Bytes = 0;
+	for (size_t i = 0; i < quantized.numLayers(); i++) {
+		auto layer = std::dynamic_pointer_cast<QuantizedDense>(quantized.getLayer(i));
+		if (layer) {
+			int8Bytes += layer->memoryBytes();
+		}
+	}
+	assert(std::dynamic_pointer_cast<QuantizedDense>(quantized.getLayer(0))->fusesRelu());
+	assert(int8Bytes * 4 < floatBytes);
+
+	Tensor input = Tensor::random({8, 64});
+	Tensor expected = model.forward(input);
+	Tensor output = quantized.forward(input);
+	for (size_t i = 0; i < expected.size(); i++) {
+		assert(std::abs(output.getData()[i] - expected.getData()[i]) < 0.02);
+	}
+
+	std::printf("Quantized model passed.\n");
+}
+
 int main(void) {
 	testSequentialCreation();
 	testAddLayers();
@@ -182,6 +368,10 @@ int main(void) {
 	testTrainEvalMode();
 	testBatchedForward();
 	testMLPExample();
+	testFloat32Training();
+	testMixedPrecisionTraining();
+	testCheckpoint();
+	testQuantize();
 
 	std::printf("\nAll model tests passed successfully.\n");
 	return 0;
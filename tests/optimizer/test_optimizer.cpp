@@ -1,5 +1,6 @@
 #include "sgd.hpp"
 #include "optimizer.hpp"
+#include "mixed.hpp"
 #include <cassert>
 #include <cstdio>
 #include <cmath>
@@ -156,6 +157,39 @@ void testParameterGradientSizeMismatch() {
 	std::printf("Parameter-gradient size mismatch detection passed.\n");
 }
 
+void testMixedPrecisionOverflow() {
+	SGDF optimizer(0.5);
+
+	TensorBF16 param({3}, bfloat16(1.0f));
+	TensorBF16 grad({3}, bfloat16(0.0f));
+	std::vector<TensorBF16*> parameters = {&param};
+	std::vector<TensorBF16*> gradients = {&grad};
+	MixedPrecisionBF16 mixed(parameters, gradients, optimizer, 8.0f, 2);
+
+	/* A scaled gradient of 8 * 0.25 unscales to 0.25 */
+	grad.fill(bfloat16(2.0f));
+	assert(mixed.step());
+	assert(static_cast<float>(param.get({0})) == 0.875f);
+	assert(mixed.getMasters()[0].get({0}) == 0.875f);
+	assert(mixed.lossScale() == 8.0f);
+
+	/* An infinite gradient skips the step, halves the scale and clears the gradients */
+	grad.at({1}) = bfloat16(INFINITY);
+	assert(!mixed.step());
+	assert(mixed.lossScale() == 4.0f);
+	assert(mixed.skipped() == 1);
+	assert(static_cast<float>(param.get({0})) == 0.875f);
+	assert(static_cast<float>(grad.get({1})) == 0.0f);
+
+	/* growthInterval clean steps double the scale again */
+	grad.fill(bfloat16(0.0f));
+	assert(mixed.step());
+	assert(mixed.step());
+	assert(mixed.lossScale() == 8.0f);
+
+	std::printf("Mixed-precision overflow skip passed.\n");
+}
+
 int main(void) {
 	testSGDCreation();
 	testSGDSetLearningRate();
@@ -164,6 +198,7 @@ int main(void) {
 	testZeroGrad();
 	testOptimizerSizeMismatch();
 	testParameterGradientSizeMismatch();
+	testMixedPrecisionOverflow();
 
 	std::printf("\nAll optimizer tests passed!\n");
 	return 0;
@@ -1,6 +1,18 @@
 #include "../../tensor/include/tensor.hpp"
+#include "../../tensor/include/gemm.hpp"
+#include "../../tensor/include/simd.hpp"
+#include "../../tensor/include/expr.hpp"
+#include "../../tensor/include/pool.hpp"
+#include "../../tensor/include/parallel.hpp"
+#include "../../tensor/include/rng.hpp"
+#include "../../tensor/include/mapped.hpp"
+#include "../../tensor/include/sparse.hpp"
+#include "../../tensor/include/quant.hpp"
 #include <cassert>
 #include <cstdio>
+#include <cmath>
+#include <cstdint>
+#include <string>
 
 int main(void) {
 	// Test 2D tensor creation
@@ -98,6 +110,733 @@ int main(void) {
 	assert(H.size() == 6);
 	std::printf("Tensor H (flattened) created successfully.\n");
 
+	// Test views share storage and copies do not
+	Tensor V({4, 3});
+	for (size_t i = 0; i < V.size(); i++) {
+		V.getData()[i] = static_cast<double>(i);
+	}
+	Tensor Vr = V.reshape({2, 6});
+	Vr.at({1, 0}) = 100.0;
+	assert(V.get({2, 0}) == 100.0);
+	Tensor Vt = V.transpose();
+	assert(!Vt.isContiguous());
+	assert(Vt.getShape()[0] == 3 && Vt.getShape()[1] == 4);
+	assert(Vt.get({2, 1}) == V.get({1, 2}));
+	Tensor Vs = V.slice(1, 3);
+	assert(Vs.isContiguous());
+	assert(Vs.getShape()[0] == 2 && Vs.getData()[0] == 3.0);
+	Vs.fill(-1.0);
+	assert(V.get({1, 0}) == -1.0 && V.get({2, 2}) == -1.0 && V.get({3, 0}) == 9.0);
+	Tensor Vc = Vt;
+	assert(Vc.isContiguous());
+	Vc.at({0, 0}) = 42.0;
+	assert(V.get({0, 0}) == 0.0);
+	Tensor VtV = Vt.matmul(V);
+	Tensor VtVRef = Vt.contiguous().matmul(V);
+	for (size_t i = 0; i < VtV.size(); i++) {
+		assert(VtV.getData()[i] == VtVRef.getData()[i]);
+	}
+	Tensor VtFlat = Vt.flatten();
+	assert(VtFlat.get({1}) == V.get({1, 0}));
+	const Tensor& VtConst = Vt;
+	Span<const double> VtValues = VtConst.getData();
+	assert(VtValues[1] == V.get({1, 0}) && VtValues[4] == V.get({0, 1}));
+	assert(!Vt.isContiguous());
+	Vt.at({0, 1}) = 7.0;
+	assert(V.get({1, 0}) == 7.0 && VtValues[1] != 7.0);
+	std::printf("Strided views share storage correctly.\n");
+
+	// Test variadic element access on views and higher ranks
+	assert(Vt.get(2, 1) == Vt.get({2, 1}));
+	Vt.at(0, 3) = 7.5;
+	assert(V.get(3, 0) == 7.5);
+	Tensor T4({2, 3, 4, 5});
+	T4.at(1, 2, 3, 4) = 3.0;
+	assert(T4.get({1, 2, 3, 4}) == 3.0);
+	assert(T4.getData()[T4.size() - 1] == 3.0);
+	bool outOfBoundsThrown = false;
+	try {
+		T4.at(1, 3, 0, 0) = 1.0;
+	} catch (const IndexOutOfBoundsError&) {
+		outOfBoundsThrown = true;
+	}
+	assert(outOfBoundsThrown);
+	Tensor T8 = Tensor::ones({1, 2, 1, 2, 1, 2, 1, 2});
+	assert(T8.ndim() == 8 && T8.size() == 16);
+	assert(T8.reshape({16}).get(15) == 1.0);
+	Shape spilled = T8.getShape();
+	assert(spilled == T8.getShape() && spilled.numel() == 16);
+	std::printf("Variadic element access is correct.\n");
+
+	// Test blocked matmul against a naive reference (sizes cross all tile edges)
+	size_t M = 131, K = 263, N = 77;
+	Tensor P({M, K});
+	Tensor Q({K, N});
+	for (size_t i = 0; i < P.size(); i++) {
+		P.getData()[i] = static_cast<double>((i * 7) % 13) - 6.0;
+	}
+	for (size_t i = 0; i < Q.size(); i++) {
+		Q.getData()[i] = static_cast<double>((i * 5) % 11) - 5.0;
+	}
+
+	Tensor R = P.matmul(Q);
+	assert(R.getShape()[0] == M);
+	assert(R.getShape()[1] == N);
+	for (size_t i = 0; i < M; i++) {
+		for (size_t j = 0; j < N; j++) {
+			double expected = 0.0;
+			for (size_t k = 0; k < K; k++) {
+				expected += P.get({i, k}) * Q.get({k, j});
+			}
+			assert(std::abs(R.get({i, j}) - expected) < 1e-9);
+		}
+	}
+	std::printf("Tensor R (blocked matmul) values are correct.\n");
+
+	// Test the threaded GEMM path gives the same result for every thread count
+	Tensor Pbig = Tensor::random({300, 260});
+	Tensor Qbig = Tensor::random({260, 170});
+	parallel::setNumThreads(1);
+	Tensor Rserial = Pbig.matmul(Qbig);
+	for (size_t threads : {2, 3, 8}) {
+		parallel::setNumThreads(threads);
+		assert(parallel::getNumThreads() == threads);
+		Tensor Rthreaded = Pbig.matmul(Qbig);
+		for (size_t i = 0; i < Rserial.size(); i++) {
+			assert(Rthreaded.getData()[i] == Rserial.getData()[i]);
+		}
+	}
+	parallel::setNumThreads(0);
+	std::printf("Threaded matmul matches single-threaded.\n");
+
+	// Test float32 tensors against the double path
+	TensorF Pf = P.cast<float>();
+	TensorF Qf = Q.cast<float>();
+	assert(Pf.dtype() == DType::Float32);
+	TensorF Rf = Pf.matmul(Qf);
+	for (size_t i = 0; i < M; i++) {
+		for (size_t j = 0; j < N; j++) {
+			assert(std::abs(Rf.get({i, j}) - R.get({i, j})) < 1e-3 * (1.0 + std::abs(R.get({i, j}))));
+		}
+	}
+	TensorF sumF = Pf + Pf * 2.0f;
+	for (size_t i = 0; i < Pf.size(); i++) {
+		assert(sumF.getData()[i] == 3.0f * Pf.getData()[i]);
+	}
+	std::printf("Float32 tensor ops match double.\n");
+
+	// Test bfloat16 storage: rounding, round-trips and widened arithmetic
+	assert(static_cast<float>(bfloat16(1.0f)) == 1.0f);
+	assert(static_cast<float>(bfloat16(-2.5f)) == -2.5f);
+	assert(static_cast<float>(bfloat16(1.0f + 1.0f / 512.0f)) == 1.0f);
+	assert(static_cast<float>(bfloat16(1.0f + 3.0f / 512.0f)) == 1.0f + 1.0f / 128.0f);
+	assert(static_cast<float>(bfloat16(1.0f + 1.0f / 256.0f)) == 1.0f);
+	assert(static_cast<float>(bfloat16(1.0f + 3.0f / 256.0f)) == 1.0f + 2.0f / 128.0f);
+	TensorBF16 Pb = P.cast<bfloat16>();
+	assert(Pb.dtype() == DType::BFloat16);
+	assert(sizeof(Pb.getData()[0]) == 2);
+	Tensor Pback = Pb.cast<double>();
+	for (size_t i = 0; i < P.size(); i++) {
+		assert(Pback.getData()[i] == P.getData()[i]);
+	}
+	TensorBF16 Rb = Pb.matmul(Q.cast<bfloat16>());
+	for (size_t i = 0; i < M; i++) {
+		for (size_t j = 0; j < N; j++) {
+			double expected = R.get({i, j});
+			assert(std::abs(static_cast<float>(Rb.get({i, j})) - expected) <= 1e-2 * (1.0 + std::abs(expected)));
+		}
+	}
+	std::printf("BFloat16 tensors round-trip and multiply correctly.\n");
+
+	// Test strided gemm: C = 2 * P^T-view * P + 0.5 * C without materializing P^T
+	Tensor S = Tensor::ones({K, K});
+	gemm(K, K, M, 2.0, P.getData().data(), 1, K, P.getData().data(), K, 1,
+	     0.5, S.getData().data(), K, 1);
+	for (size_t i = 0; i < K; i += 17) {
+		for (size_t j = 0; j < K; j += 13) {
+			double expected = 0.5;
+			for (size_t m = 0; m < M; m++) {
+				expected += 2.0 * P.get({m, i}) * P.get({m, j});
+			}
+			assert(std::abs(S.get({i, j}) - expected) < 1e-9);
+		}
+	}
+	std::printf("Strided gemm with alpha/beta is correct.\n");
+
+	// Test backend dispatch: every stride pattern gives the same product on either backend
+	if (!hasBlas()) {
+		assert(!setGemmBackend(GemmBackend::Blas));
+		assert(gemmBackend() == GemmBackend::Auto);
+	}
+	{
+		const size_t strides[][6] = {
+			{K, 1, M, 1, M, 1},   /* row-major */
+			{1, M, 1, K, M, 1},   /* A^T, B^T views */
+			{K, 1, M, 1, 1, M},   /* column-major C */
+			{K, 1, 0, 1, M, 1},   /* broadcast row of B: not expressible in CBLAS */
+		};
+		std::vector<double> a(M * K), b(K * M);
+		for (size_t i = 0; i < a.size(); i++) {
+			a[i] = P.getData()[i];
+			b[i] = P.getData()[a.size() - 1 - i];
+		}
+		for (const auto& st : strides) {
+			std::vector<double> builtin(M * M, 1.0), dispatched(M * M, 1.0);
+			setGemmBackend(GemmBackend::Builtin);
+			gemm<double>(M, M, K, 1.5, a.data(), st[0], st[1], b.data(), st[2], st[3], 0.5, builtin.data(), st[4], st[5]);
+			setGemmBackend(hasBlas() ? GemmBackend::Blas : GemmBackend::Auto);
+			gemm<double>(M, M, K, 1.5, a.data(), st[0], st[1], b.data(), st[2], st[3], 0.5, dispatched.data(), st[4], st[5]);
+			for (size_t i = 0; i < builtin.size(); i++) {
+				assert(std::abs(builtin[i] - dispatched[i]) < 1e-9 * (1.0 + std::abs(builtin[i])));
+			}
+		}
+		setGemmBackend(GemmBackend::Auto);
+	}
+	std::printf("Gemm backends agree (%s).\n", hasBlas() ? "cblas" : "built-in only");
+
+	// Test in-place and output-parameter ops
+	Tensor X1({2, 3}, {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+	Tensor X2({2, 3}, {0.5, 0.5, 0.5, 2.0, 2.0, 2.0});
+	Tensor Y = X1;
+	Y.add_(X2).mul_(X2).sub_(X1).scale_(2.0);
+	Y.axpy_(-1.0, X2);
+	for (size_t i = 0; i < Y.size(); i++) {
+		double x1 = X1.getData()[i];
+		double x2 = X2.getData()[i];
+		assert(std::abs(Y.getData()[i] - (((x1 + x2) * x2 - x1) * 2.0 - x2)) < 1e-12);
+	}
+	Tensor Xt({3, 2});
+	Tensor XtView = Xt.transpose();
+	Tensor::add(XtView, X1, X2);
+	assert(Xt.get({2, 1}) == X1.get({1, 2}) + X2.get({1, 2}));
+	Tensor Gram({3, 3}, 1.0);
+	Tensor::matmul(Gram, X1, X2, 2.0, 1.0, true, false);
+	Tensor GramRef = X1.transpose().matmul(X2);
+	for (size_t i = 0; i < 3; i++) {
+		for (size_t j = 0; j < 3; j++) {
+			assert(Gram.get({i, j}) == 2.0 * GramRef.get({i, j}) + 1.0);
+		}
+	}
+	std::printf("In-place and output-parameter ops are correct.\n");
+
+	// Test broadcasting against row, column and scalar operands
+	Tensor rowVec({3}, {10.0, 20.0, 30.0});
+	Tensor colVec({2, 1}, {2.0, 4.0});
+	Tensor rowSum = X1 + rowVec;
+	Tensor colQuot = X1 / colVec;
+	Tensor outer = colVec.hadamard(rowVec);
+	Tensor scalarDiff = Tensor({1}, {1.0}) - X1;
+	assert(outer.getShape() == Shape({2, 3}));
+	for (size_t i = 0; i < 2; i++) {
+		for (size_t j = 0; j < 3; j++) {
+			assert(rowSum.get(i, j) == X1.get(i, j) + rowVec.get(j));
+			assert(colQuot.get(i, j) == X1.get(i, j) / colVec.get(i, 0));
+			assert(outer.get(i, j) == colVec.get(i, 0) * rowVec.get(j));
+			assert(scalarDiff.get(i, j) == 1.0 - X1.get(i, j));
+		}
+	}
+	Tensor rowDiff = X1.transpose() - Tensor({2}, {1.0, 2.0});
+	assert(rowDiff.get(2, 1) == X1.get(1, 2) - 2.0);
+	Tensor channels = Tensor::ones({2, 3, 2, 2});
+	channels.mul_(Tensor({3, 1, 1}, {1.0, 2.0, 3.0}));
+	assert(channels.get(1, 2, 1, 0) == 3.0 && channels.get(0, 1, 0, 1) == 2.0);
+	bool broadcastThrown = false;
+	try {
+		Tensor bad = X1 + Tensor({2});
+	} catch (const TensorDismatchError&) {
+		broadcastThrown = true;
+	}
+	assert(broadcastThrown);
+	std::printf("Broadcasting ops are correct.\n");
+
+	// Test axis reductions against direct loops
+	Tensor Cube = Tensor::random({3, 40, 5});
+	for (size_t axis = 0; axis < 3; axis++) {
+		Tensor sums = Cube.sum(axis);
+		Tensor means = Cube.mean(axis, true);
+		Tensor maxima = Cube.max(axis);
+		Tensor lse = Cube.logsumexp(axis);
+		std::vector<size_t> best = Cube.argmax(axis);
+		assert(means.ndim() == 3 && means.getShape()[axis] == 1);
+		size_t len = Cube.getShape()[axis];
+		for (size_t r = 0; r < sums.size(); r++) {
+			size_t inner = 1;
+			for (size_t d = axis + 1; d < 3; d++) {
+				inner *= Cube.getShape()[d];
+			}
+			const double* base = Cube.getData().data() + (r / inner) * len * inner + r % inner;
+			double s = 0.0;
+			double m = base[0];
+			size_t mi = 0;
+			for (size_t k = 0; k < len; k++) {
+				s += base[k * inner];
+				if (base[k * inner] > m) {
+					m = base[k * inner];
+					mi = k;
+				}
+			}
+			double e = 0.0;
+			for (size_t k = 0; k < len; k++) {
+				e += std::exp(base[k * inner] - m);
+			}
+			assert(std::abs(sums.getData()[r] - s) < 1e-12);
+			assert(std::abs(means.getData()[r] - s / len) < 1e-12);
+			assert(maxima.getData()[r] == m && best[r] == mi);
+			assert(std::abs(lse.getData()[r] - (m + std::log(e))) < 1e-12);
+		}
+	}
+	assert(std::abs(Cube.sum() - Cube.sum(0).sum(0).sum(0).get(0)) < 1e-10);
+	assert(Cube.max() == Cube.getData()[Cube.argmax()]);
+
+	TensorF ones({1 << 20}, 0.1f);
+	double naive = 0.0;
+	float naiveF = 0.0f;
+	for (size_t i = 0; i < ones.size(); i++) {
+		naive += 0.1f;
+		naiveF += 0.1f;
+	}
+	assert(std::abs(ones.sum() - naive) < std::abs(naiveF - naive) / 100);
+
+	Tensor Tall = Tensor::random({2000, 300});
+	parallel::setNumThreads(1);
+	Tensor colSerial = Tall.sum(0);
+	std::vector<size_t> rowBestSerial = Tall.argmax(1);
+	parallel::setNumThreads(4);
+	Tensor colThreaded = Tall.sum(0);
+	assert(Tall.argmax(1) == rowBestSerial);
+	for (size_t j = 0; j < colSerial.size(); j++) {
+		assert(colThreaded.getData()[j] == colSerial.getData()[j]);
+	}
+	parallel::setNumThreads(0);
+	std::printf("Axis reductions are correct.\n");
+
+	// Test batched matmul with a broadcast batch dimension and strided operands
+	Tensor Ab = Tensor::random({2, 3, 4, 5});
+	Tensor Bb = Tensor::random({3, 6, 5});
+	Tensor Bt({3, 5, 6});
+	for (size_t g = 0; g < 3; g++) {
+		for (size_t i = 0; i < 5; i++) {
+			for (size_t j = 0; j < 6; j++) {
+				Bt.at(g, i, j) = Bb.get(g, j, i);
+			}
+		}
+	}
+	Tensor Cb = Ab.bmm(Bt);
+	Tensor CbT({2, 3, 4, 6});
+	Tensor::bmm(CbT, Ab, Bb, 1.0, 0.0, false, true);
+	assert(Cb.getShape() == Shape({2, 3, 4, 6}));
+	for (size_t n = 0; n < 2; n++) {
+		for (size_t g = 0; g < 3; g++) {
+			for (size_t i = 0; i < 4; i++) {
+				for (size_t j = 0; j < 6; j++) {
+					double ref = 0.0;
+					for (size_t k = 0; k < 5; k++) {
+						ref += Ab.get(n, g, i, k) * Bt.get(g, k, j);
+					}
+					assert(std::abs(Cb.get(n, g, i, j) - ref) < 1e-12);
+					assert(std::abs(CbT.get(n, g, i, j) - ref) < 1e-12);
+				}
+			}
+		}
+	}
+	Tensor shared = Tensor::random({5, 2});
+	Tensor perSample = Ab.bmm(shared);
+	assert(perSample.getShape() == Shape({2, 3, 4, 2}));
+	Tensor sliceRef = Ab.slice(1, 2).reshape({3 * 4, 5}).matmul(shared);
+	for (size_t i = 0; i < sliceRef.size(); i++) {
+		assert(std::abs(perSample.getData()[12 * 2 + i] - sliceRef.getData()[i]) < 1e-12);
+	}
+	Tensor manyA = Tensor::random({64, 8, 8});
+	Tensor manyB = Tensor::random({64, 8, 8});
+	parallel::setNumThreads(1);
+	Tensor manySerial = manyA.bmm(manyB);
+	parallel::setNumThreads(3);
+	Tensor manyThreaded = manyA.bmm(manyB);
+	parallel::setNumThreads(0);
+	for (size_t i = 0; i < manySerial.size(); i++) {
+		assert(manyThreaded.getData()[i] == manySerial.getData()[i]);
+	}
+	std::printf("Batched matmul is correct.\n");
+
+	// Test the counter-based generator: known answers, reproducibility and distributions
+	uint32_t philoxCounter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+	uint32_t philoxKey[2] = {0xa4093822, 0x299f31d0};
+	rng::philox(philoxCounter, philoxKey);
+	assert(philoxCounter[0] == 0xd16cfe09 && philoxCounter[1] == 0x94fdcceb);
+	assert(philoxCounter[2] == 0x5001e420 && philoxCounter[3] == 0x24126ea1);
+
+	rng::Generator genA(1234);
+	rng::Generator genB(1234);
+	Tensor drawA({1000});
+	Tensor drawB({1000});
+	genA.uniform(drawA, -1.0, 1.0);
+	genB.uniform(drawB, -1.0, 1.0);
+	for (size_t i = 0; i < drawA.size(); i++) {
+		assert(drawA.getData()[i] == drawB.getData()[i]);
+		assert(drawA.getData()[i] >= -1.0 && drawA.getData()[i] < 1.0);
+	}
+	genA.uniform(drawA, -1.0, 1.0);
+	assert(drawA.getData()[0] != drawB.getData()[0]);
+
+	TensorF gauss({1 << 18});
+	rng::Generator(7).normal(gauss, 1.0, 2.0);
+	assert(std::abs(gauss.mean() - 1.0f) < 0.02f);
+	TensorF centered = gauss - TensorF({1}, 1.0f);
+	assert(std::abs(centered.hadamard(centered).mean() - 4.0f) < 0.05f);
+
+	Tensor clipped({4097});
+	rng::Generator(9).truncatedNormal(clipped, 0.0, 0.5);
+	assert(clipped.max() <= 1.0 && (clipped * -1.0).max() <= 1.0);
+
+	Tensor fanned({512, 300});
+	parallel::setNumThreads(1);
+	rng::Generator(11).heNormal(fanned, 300);
+	Tensor fannedSerial = fanned;
+	parallel::setNumThreads(4);
+	rng::Generator(11).heNormal(fanned, 300);
+	parallel::setNumThreads(0);
+	for (size_t i = 0; i < fanned.size(); i++) {
+		assert(fanned.getData()[i] == fannedSerial.getData()[i]);
+	}
+	std::printf("Random number generation is reproducible and correct.\n");
+
+	// Test lazy expressions against the eager operators
+	Tensor fused = lazy(X1) - lazy(X2) * 0.1 + 2.0 * lazy(X1).hadamard(lazy(X2));
+	Tensor eager = X1 - X2 * 0.1 + X1.hadamard(X2) * 2.0;
+	for (size_t i = 0; i < fused.size(); i++) {
+		assert(std::abs(fused.getData()[i] - eager.getData()[i]) < 1e-12);
+	}
+	double sq = (lazy(X1) - lazy(X2)).hadamard(lazy(X1) - lazy(X2)).sum();
+	Tensor diffX = X1 - X2;
+	double sqRef = 0.0;
+	for (size_t i = 0; i < diffX.size(); i++) {
+		sqRef += diffX.getData()[i] * diffX.getData()[i];
+	}
+	assert(std::abs(sq - sqRef) < 1e-12);
+	Tensor P1 = X1;
+	P1 = lazy(P1) - lazy(X2) * 0.5;
+	assert(P1.get({1, 2}) == 6.0 - 1.0);
+	bool mismatchThrown = false;
+	try {
+		Tensor bad = lazy(X1) + lazy(Gram);
+	} catch (const TensorDismatchError&) {
+		mismatchThrown = true;
+	}
+	assert(mismatchThrown);
+	std::printf("Lazy expressions match eager ops.\n");
+
+	// Test that a repeated step is served entirely from the pool
+	for (int step = 0; step < 3; step++) {
+		if (step == 1) {
+			pool::resetStats();
+		}
+		Tensor a({100, 100}, 1.0);
+		Tensor b = a + a;
+		Tensor c = b.matmul(a);
+	}
+	pool::PoolStats ps = pool::stats();
+	assert(ps.requests > 0);
+	assert(ps.systemAllocations() == 0);
+	assert(ps.hitRate() == 1.0);
+	assert(ps.peakBytes >= ps.liveBytes + 3 * 100 * 100 * sizeof(double));
+
+	// Test the step arena rewinds without clobbering tensors that outlive a step
+	pool::StepArena arena(1 << 16);
+	Tensor kept({1});
+	for (int step = 0; step < 4; step++) {
+		if (step == 2) {
+			pool::resetStats();
+		}
+		pool::StepArena::Scope scope(arena);
+		Tensor t({256}, 2.0);
+		Tensor u = t * 3.0;
+		assert(arena.usedBytes() >= 2 * 256 * sizeof(double));
+		if (step == 0) {
+			kept = u;
+		}
+	}
+	assert(arena.usedBytes() == 0);
+	assert(pool::stats().systemAllocations() == 0);
+	for (size_t i = 0; i < kept.size(); i++) {
+		assert(kept.getData()[i] == 6.0);
+	}
+	std::printf("Tensor pool and step arena reuse memory.\n");
+
+	// Test cache-line aligned, huge-page aligned and row-padded buffers
+	Tensor lineAligned({3, 5});
+	Tensor hugeBuffer({1 << 19});
+	assert(reinterpret_cast<uintptr_t>(lineAligned.getData().data()) % 64 == 0);
+	assert(reinterpret_cast<uintptr_t>(hugeBuffer.getData().data()) % (size_t(1) << 21) == 0);
+	Tensor Pad = Tensor::padded({7, 13});
+	assert(Pad.getStrides()[0] == 16 && !Pad.isContiguous());
+	Tensor PadSrc = Tensor::random({7, 13});
+	Tensor::add(Pad, Pad, PadSrc);
+	Tensor PadRhs = Tensor::random({13, 4});
+	Tensor PadProd = Pad.matmul(PadRhs);
+	Tensor PadRef = PadSrc.matmul(PadRhs);
+	for (size_t i = 0; i < PadRef.size(); i++) {
+		assert(std::abs(PadProd.getData()[i] - PadRef.getData()[i]) < 1e-12);
+	}
+	assert(!Pad.isContiguous() && Pad.get(6, 12) == PadSrc.get(6, 12));
+	std::printf("Aligned and padded buffers are correct.\n");
+
+	// Test element-wise kernels on every instruction set this CPU supports
+	simd::Isa bestIsa = simd::detectIsa();
+	for (int level = 0; level <= static_cast<int>(bestIsa); level++) {
+		simd::Isa isa = static_cast<simd::Isa>(level);
+		assert(simd::setIsa(isa));
+
+		size_t n = 37;
+		Tensor U({n});
+		Tensor V({n});
+		for (size_t i = 0; i < n; i++) {
+			U.at({i}) = static_cast<double>(i) - 18.0;
+			V.at({i}) = 0.5 * static_cast<double>(i % 5) + 1.0;
+		}
+
+		Tensor sumUV = U + V;
+		Tensor diffUV = U - V;
+		Tensor prodUV = U.hadamard(V);
+		Tensor scaledU = U * -3.0;
+		for (size_t i = 0; i < n; i++) {
+			double u = U.get({i});
+			double v = V.get({i});
+			assert(sumUV.get({i}) == u + v);
+			assert(diffUV.get({i}) == u - v);
+			assert(prodUV.get({i}) == u * v);
+			assert(scaledU.get({i}) == u * -3.0);
+		}
+
+		double relu[37];
+		double reluGrad[37];
+		simd::relu(U.getData().data(), relu, n);
+		simd::reluBackward(U.getData().data(), V.getData().data(), reluGrad, n);
+		simd::axpy(2.0, V.getData().data(), U.getData().data(), n);
+		for (size_t i = 0; i < n; i++) {
+			double u = static_cast<double>(i) - 18.0;
+			assert(relu[i] == (u > 0.0 ? u : 0.0));
+			assert(reluGrad[i] == (u > 0.0 ? V.get({i}) : 0.0));
+			assert(std::abs(U.get({i}) - (u + 2.0 * V.get({i}))) < 1e-12);
+		}
+
+		Tensor W = V * 3.0;
+		W.scaleAdd_(0.5, -2.0, V);
+		for (size_t i = 0; i < n; i++) {
+			assert(std::abs(W.get({i}) - (1.5 * V.get({i}) - 2.0 * V.get({i}))) < 1e-12);
+		}
+
+		U.fill(4.25);
+		for (size_t i = 0; i < n; i++) {
+			assert(U.get({i}) == 4.25);
+		}
+
+		Tensor Big = Tensor::random({n, 45});
+		TensorF BigF({n, 45});
+		for (size_t i = 0; i < BigF.size(); i++) {
+			BigF.getData()[i] = static_cast<float>(i);
+		}
+		Tensor BigT = Big.transpose().contiguous();
+		TensorF BigFT = BigF.transpose().contiguous();
+		assert(BigT.isContiguous() && BigFT.isContiguous());
+		for (size_t i = 0; i < 45; i++) {
+			for (size_t j = 0; j < n; j++) {
+				assert(BigT.get(i, j) == Big.get(j, i));
+				assert(BigFT.get(i, j) == BigF.get(j, i));
+			}
+		}
+
+		float best[37];
+		float origin[37];
+		float candidate[37];
+		for (size_t i = 0; i < n; i++) {
+			best[i] = static_cast<float>(i % 3);
+			origin[i] = -1.0f;
+			candidate[i] = static_cast<float>(i % 4);
+		}
+		simd::maxUpdate(candidate, 7.0f, best, origin, n);
+		for (size_t i = 0; i < n; i++) {
+			bool greater = (i % 4) > (i % 3);
+			assert(best[i] == static_cast<float>(greater ? i % 4 : i % 3));
+			assert(origin[i] == (greater ? 7.0f : -1.0f));
+		}
+		std::printf("Element-wise kernels (%s) are correct.\n", simd::isaName(isa));
+	}
+	simd::setIsa(bestIsa);
+
+	/* Test memory-mapped tensors */
+	{
+		std::string path = "/tmp/cnn_test_mapped.bin";
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		assert(file != nullptr);
+		const char header[24] = "mapped tensor header";
+		std::fwrite(header, 1, sizeof(header), file);
+		for (size_t i = 0; i < 6; i++) {
+			double value = static_cast<double>(i) * 1.5;
+			std::fwrite(&value, sizeof(double), 1, file);
+		}
+		std::fclose(file);
+
+		Tensor M = Tensor::mapFile(path, sizeof(header), {2, 3}, DType::Float64);
+		assert(M.isContiguous());
+		assert(M.get({1, 2}) == 7.5);
+		Tensor MT = M.transpose().contiguous();
+		assert(MT.get({2, 1}) == 7.5);
+
+		/* Assigning to a read-only mapping gives it a fresh buffer */
+		Tensor R = Tensor::mapFile(path, sizeof(header), {2, 3}, DType::Float64);
+		R = Tensor::ones({2, 3});
+		assert(R.get({1, 2}) == 1.0);
+		assert(M.get({1, 2}) == 7.5);
+
+		/* Writing a read-only mapping in place throws instead of faulting */
+		const Tensor& MConst = M;
+		assert(MConst.getData()[5] == 7.5);
+		size_t refused = 0;
+		try { M.at({0, 0}) = 1.0; } catch (const TensorFileError&) { refused++; }
+		try { M.at(0, 0) = 1.0; } catch (const TensorFileError&) { refused++; }
+		try { M.getData(); } catch (const ReadOnlyTensorError&) { refused++; }
+		try { M.fill(0.0); } catch (const ReadOnlyTensorError&) { refused++; }
+		try { M.add_(Tensor::ones({2, 3})); } catch (const ReadOnlyTensorError&) { refused++; }
+		try { M.scale_(2.0); } catch (const ReadOnlyTensorError&) { refused++; }
+		try { Tensor::matmul(M, Tensor::ones({2, 2}), Tensor::ones({2, 3})); } catch (const ReadOnlyTensorError&) { refused++; }
+		assert(refused == 7);
+		assert(M.get({1, 2}) == 7.5);
+		assert(M.transpose().getData()[5] == 7.5);
+
+		Tensor C = Tensor::mapFile(path, sizeof(header), {2, 3}, DType::Float64, MapMode::CopyOnWrite);
+		C.at({1, 2}) = -1.0;
+		C.mul_(Tensor({2, 3}, 2.0));
+		assert(C.get({1, 2}) == -2.0);
+		Tensor Reopened = Tensor::mapFile(path, sizeof(header), {2, 3}, DType::Float64);
+		assert(Reopened.get({1, 2}) == 7.5);
+
+		bool threw = false;
+		try { Tensor::mapFile(path, sizeof(header), {4, 3}, DType::Float64); }
+		catch (const TensorFileError&) { threw = true; }
+		assert(threw);
+		threw = false;
+		try { Tensor::mapFile(path, 3, {2}, DType::Float64); }
+		catch (const TensorFileError&) { threw = true; }
+		assert(threw);
+		threw = false;
+		try { Tensor::mapFile("/tmp/cnn_test_missing.bin", 0, {1}, DType::Float64); }
+		catch (const TensorFileError&) { threw = true; }
+		assert(threw);
+		threw = false;
+		try { Tensor::mapFile(path, sizeof(header), {2, 3}, DType::Float32); }
+		catch (const TensorDismatchError&) { threw = true; }
+		assert(threw);
+		std::remove(path.c_str());
+		std::printf("Memory-mapped tensors are correct.\n");
+	}
+
+	/* Test sparse tensors and sparse-dense products */
+	{
+		SparseTensor S = SparseTensor::fromCoo(3, 5, {2, 0, 2, 0, 0}, {4, 3, 0, 1, 3}, {1.0, 2.0, -1.0, 0.5, 1.5});
+		assert(S.nnz() == 4);
+		assert(S.getRowPtr()[1] == 2 && S.getRowPtr()[2] == 2);
+		Tensor D = S.toDense();
+		assert(D.get({0, 3}) == 3.5 && D.get({2, 0}) == -1.0 && D.get({1, 1}) == 0.0);
+		SparseTensor R = SparseTensor::fromDense(D);
+		assert(R.nnz() == 4 && R.getColIndex() == S.getColIndex());
+
+		Tensor B = Tensor::random({5, 7});
+		Tensor BT = Tensor::random({7, 5});
+		Tensor out({3, 7});
+		SparseTensor::matmul(out, S, B);
+		Tensor ref = D.matmul(B);
+		Tensor outT({3, 7}, 1.0);
+		SparseTensor::matmul(outT, S, BT, 2.0, 1.0, true);
+		Tensor refT = D.matmul(BT.transpose());
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 7; j++) {
+				assert(std::abs(out.get({i, j}) - ref.get({i, j})) < 1e-12);
+				assert(std::abs(outT.get({i, j}) - (2.0 * refT.get({i, j}) + 1.0)) < 1e-12);
+			}
+		}
+
+		Tensor G = Tensor::random({3, 7});
+		Tensor grad({7, 5}, 9.0);
+		SparseTensor::transposeMatmul(grad, G, S);
+		Tensor gradRef = G.transpose().matmul(D);
+		for (size_t i = 0; i < 7; i++) {
+			for (size_t j = 0; j < 5; j++) {
+				assert(std::abs(grad.get({i, j}) - gradRef.get({i, j})) < 1e-12);
+			}
+		}
+
+		Tensor sampled({3, 5});
+		SparseTensor::sampledMatmul(sampled, S, G, BT);
+		Tensor full = G.matmul(BT);
+		assert(std::abs(sampled.get({0, 3}) - full.get({0, 3})) < 1e-12);
+		assert(sampled.get({0, 0}) == 0.0);
+
+		bool threw = false;
+		try { SparseTensor(2, 3, {0, 2, 1}, {0, 1}, {1.0, 1.0}); }
+		catch (const TensorDismatchError&) { threw = true; }
+		assert(threw);
+		threw = false;
+		try { SparseTensor::fromCoo(2, 3, {0}, {3}, {1.0}); }
+		catch (const IndexOutOfBoundsError&) { threw = true; }
+		assert(threw);
+		std::printf("Sparse tensors are correct.\n");
+	}
+
+	/* Test the int8 GEMM on every instruction set against a plain loop */
+	{
+		const size_t M = 7, N = 37, K = 45;
+		TensorF W = TensorF::random({N, K});
+		TensorF X = TensorF::random({M, K});
+		for (size_t i = 0; i < W.size(); i++) {
+			W.getData()[i] = 2.0f * W.getData()[i] - 1.0f;
+		}
+		quant::PackedWeights packed(W.getData().data(), N, K);
+		assert(packed.stride() == 48 && packed.outputs() == N);
+		std::vector<uint8_t> codes(M * packed.stride());
+		quant::QuantParams params = quant::quantize(X.getData().data(), M, K, codes.data(), packed.stride());
+		assert(params.zeroPoint == 0);
+
+		/* Reconstruct the weight codes from their scales to build the reference */
+		std::vector<int32_t> reference(M * N, 0);
+		for (size_t n = 0; n < N; n++) {
+			float scale = packed.channelScales()[n];
+			for (size_t m = 0; m < M; m++) {
+				for (size_t k = 0; k < K; k++) {
+					int32_t w = static_cast<int32_t>(std::nearbyint(W.get({n, k}) / scale));
+					reference[m * N + n] += codes[m * packed.stride() + k] * w;
+				}
+			}
+		}
+
+		simd::Isa bestIsa = simd::detectIsa();
+		for (int level = 0; level <= static_cast<int>(bestIsa); level++) {
+			simd::setIsa(static_cast<simd::Isa>(level));
+			std::vector<int32_t> acc(M * N, -1);
+			quant::gemmAccumulate(M, codes.data(), packed, acc.data());
+			assert(acc == reference);
+		}
+		simd::setIsa(bestIsa);
+
+		/* Codes at the top of the uint8 range must not saturate */
+		std::vector<uint8_t> full(M * packed.stride(), 255);
+		std::vector<int32_t> maxAcc(M * N);
+		quant::gemmAccumulate(M, full.data(), packed, maxAcc.data());
+		simd::setIsa(simd::Isa::Scalar);
+		std::vector<int32_t> maxRef(M * N);
+		quant::gemmAccumulate(M, full.data(), packed, maxRef.data());
+		simd::setIsa(bestIsa);
+		assert(maxAcc == maxRef);
+
+		TensorF Y({M, N});
+		quant::gemm<float>(M, codes.data(), params, packed, nullptr, false, Y.getData().data());
+		TensorF exact = X.matmul(W.transpose());
+		for (size_t i = 0; i < Y.size(); i++) {
+			assert(std::abs(Y.getData()[i] - exact.getData()[i]) < 0.1f);
+		}
+		std::printf("Int8 GEMM (%s) is correct.\n", quant::hasVnni() ? "vnni" : simd::isaName(bestIsa));
+	}
+
 	std::printf("All tests passed successfully.\n");
 
-	return 0;
\ No newline at end of file
+	return 0;
+}
\ No newline at end of file